@@ -13,8 +13,10 @@
 
 #include "StackWithBonuses.h"
 #include "EnemyInfo.h"
+#include "../../lib/AIBenchmark.h"
 #include "../../lib/CStopWatch.h"
 #include "../../lib/CThreadHelper.h"
+#include "../../lib/Profiler.h"
 #include "../../lib/mapObjects/CGTownInstance.h"
 #include "../../lib/spells/CSpellHandler.h"
 #include "../../lib/spells/ISpellMechanics.h"
@@ -63,6 +65,54 @@ std::vector<BattleHex> CBattleAI::getBrokenWallMoatHexes() const
 	return result;
 }
 
+/// Measures how many hypothetic battle states were evaluated during single stack activation
+/// Logged on debug level and added to benchmark report of current day if client runs in benchmark mode
+class ActivationStatistics
+{
+	PlayerColor player;
+	int day;
+	HypotheticBattleStatistics start;
+	boost::posix_time::ptime startTime;
+
+public:
+	ActivationStatistics(PlayerColor player, const Environment * env)
+		: player(player),
+		day(env->game() ? env->game()->getDate(Date::DAY) : 0),
+		start(HypotheticBattle::getStatistics()),
+		startTime(boost::posix_time::microsec_clock::universal_time())
+	{
+	}
+
+	~ActivationStatistics()
+	{
+		auto stats = HypotheticBattle::getStatistics() - start;
+		uint64_t time = (boost::posix_time::microsec_clock::universal_time() - startTime).total_milliseconds();
+		uint64_t states = stats.battles + stats.forks;
+		uint64_t statesPerSecond = states * 1000 / std::max<uint64_t>(time, 1);
+
+		logAi->debug("BattleAI: evaluated %d states (%d forked) in %d ms, %d states/s, %d unit states copied, %d shared",
+			states, stats.forks, time, statesPerSecond, stats.unitCopies, stats.sharedUnits);
+
+		if(AIBenchmark::get().isActive())
+		{
+			AITurnReport report;
+
+			report.player = player;
+			report.ai = "BattleAI";
+			report.day = day;
+			report.turnTime = time;
+			report.counters["activations"] = 1;
+			report.counters["states"] = states;
+			report.counters["forkedStates"] = stats.forks;
+			report.counters["unitCopies"] = stats.unitCopies;
+			report.counters["sharedUnits"] = stats.sharedUnits;
+
+			//single battle may activate stacks hundred times, keep one entry per day
+			AIBenchmark::get().addToTurn(report);
+		}
+	}
+};
+
 CBattleAI::CBattleAI()
 	: side(-1),
 	wasWaitingForRealize(false),
@@ -96,8 +146,10 @@ void CBattleAI::initBattleInterface(std::shared_ptr<Environment> ENV, std::share
 BattleAction CBattleAI::activeStack( const CStack * stack )
 {
 	LOG_TRACE_PARAMS(logAi, "stack: %s", stack->nodeName());
+	PROFILE_ZONE("CBattleAI::activeStack");
 
 	BattleAction result = BattleAction::makeDefend(stack);
+	ActivationStatistics statistics(playerID, env.get());
 	setCbc(cb); //TODO: make solid sure that AIs always use their callbacks (need to take care of event handlers too)
 
 	try
@@ -145,12 +197,17 @@ BattleAction CBattleAI::activeStack( const CStack * stack )
 			{
 				std::vector<PossibleSpellcast> possibleCasts;
 				spells::BattleCast temp(getCbc().get(), stack, spells::Mode::CREATURE_ACTIVE, spell);
+
+				//every target is evaluated in state forked from this one
+				HypotheticBattle spellcastBase(env.get(), cb);
+				spellcastBase.preloadUnits();
+
 				for(auto & target : temp.findPotentialTargets())
 				{
 					PossibleSpellcast ps;
 					ps.dest = target;
 					ps.spell = spell;
-					evaluateCreatureSpellcast(stack, ps);
+					evaluateCreatureSpellcast(stack, ps, spellcastBase);
 					possibleCasts.push_back(ps);
 				}
 
@@ -177,6 +234,8 @@ BattleAction CBattleAI::activeStack( const CStack * stack )
 #endif
 
 			auto evaluationResult = scoreEvaluator.findBestTarget(stack, targets, hb);
+
+			scoreEvaluator.logCacheStatistics();
 			auto & bestAttack = evaluationResult.bestAttack;
 
 			//TODO: consider more complex spellcast evaluation, f.e. because "re-retaliation" during enemy move in same turn for melee attack etc.
@@ -589,10 +648,40 @@ void CBattleAI::attemptCastingSpell()
 
 	cb->battleGetTurnOrder(turnOrder, amount, 2); //no more than 1 turn after current, each unit at least once
 
+	uint32_t threadCount = boost::thread::hardware_concurrency();
+
+	if(threadCount == 0)
+	{
+		logGlobal->warn("No information of CPU cores available");
+		threadCount = 1;
+	}
+
+	//forking is cheaper than creating state from real battle, but it is not thread-safe and unit states have caches,
+	//so each evaluation thread forks its states from own base state
+	struct EvaluationContext
+	{
+		//todo: re-implement scripts context cache
+		HypotheticBattle baseState;
+
+		EvaluationContext(const Environment * env, HypotheticBattle::Subject battle)
+			: baseState(env, battle)
+		{
+			baseState.preloadUnits();
+		}
+	};
+
+	std::vector<std::shared_ptr<EvaluationContext>> contextPool;
+
+	for(uint32_t idx = 0; idx < threadCount; idx++)
+	{
+		contextPool.push_back(std::make_shared<EvaluationContext>(env.get(), cb));
+	}
+
 	{
 		bool enemyHadTurn = false;
 
-		HypotheticBattle state(env.get(), cb);
+		//evaluation threads are not running yet
+		HypotheticBattle state(env.get(), contextPool.front()->baseState);
 
 		evaluateQueue(valueOfStack, turnOrder, state, 0, &enemyHadTurn);
 
@@ -608,14 +697,9 @@ void CBattleAI::attemptCastingSpell()
 		}
 	}
 
-	struct ScriptsCache
-	{
-		//todo: re-implement scripts context cache
-	};
-
-	auto evaluateSpellcast = [&] (PossibleSpellcast * ps, std::shared_ptr<ScriptsCache>)
+	auto evaluateSpellcast = [&] (PossibleSpellcast * ps, std::shared_ptr<EvaluationContext> context)
 	{
-		HypotheticBattle state(env.get(), cb);
+		HypotheticBattle state(env.get(), context->baseState);
 
 		spells::BattleCast cast(&state, hero, spells::Mode::HERO, ps->spell);
 		cast.castEval(state.getServerCallback(), ps->dest);
@@ -686,31 +770,17 @@ void CBattleAI::attemptCastingSpell()
 		}
 	};
 
-	using EvalRunner = ThreadPool<ScriptsCache>;
+	using EvalRunner = ThreadPool<EvaluationContext>;
 
 	EvalRunner::Tasks tasks;
 
 	for(PossibleSpellcast & psc : possibleCasts)
 		tasks.push_back(std::bind(evaluateSpellcast, &psc, _1));
 
-	uint32_t threadCount = boost::thread::hardware_concurrency();
-
-	if(threadCount == 0)
-	{
-		logGlobal->warn("No information of CPU cores available");
-		threadCount = 1;
-	}
-
 	CStopWatch timer;
+	PROFILE_ZONE("CBattleAI spell evaluation");
 
-	std::vector<std::shared_ptr<ScriptsCache>> scriptsPool;
-
-	for(uint32_t idx = 0; idx < threadCount; idx++)
-	{
-		scriptsPool.emplace_back();
-	}
-
-	EvalRunner runner(&tasks, scriptsPool);
+	EvalRunner runner(&tasks, contextPool);
 	runner.run();
 
 	LOGFL("Evaluation took %d ms", timer.getDiff());
@@ -740,12 +810,12 @@ void CBattleAI::attemptCastingSpell()
 }
 
 //Below method works only for offensive spells
-void CBattleAI::evaluateCreatureSpellcast(const CStack * stack, PossibleSpellcast & ps)
+void CBattleAI::evaluateCreatureSpellcast(const CStack * stack, PossibleSpellcast & ps, HypotheticBattle & baseState)
 {
 	using ValueMap = PossibleSpellcast::ValueMap;
 
 	RNGStub rngStub;
-	HypotheticBattle state(env.get(), cb);
+	HypotheticBattle state(env.get(), baseState);
 	TStacks all = cb->battleGetAllStacks(false);
 
 	ValueMap healthOfStack;
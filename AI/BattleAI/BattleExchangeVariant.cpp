@@ -23,6 +23,82 @@ MoveTarget::MoveTarget()
 	score = EvaluationResult::INEFFECTIVE_SCORE;
 }
 
+BattleExchangeCache::BattleExchangeCache()
+	: damageHits(0), damageRequests(0), reachabilityHits(0), reachabilityRequests(0)
+{
+}
+
+BattleExchangeCache::UnitStateKey::UnitStateKey(const battle::Unit * unit, BattleHex position)
+	: unitId(unit->unitId()),
+	position(position.hex),
+	health(unit->getAvailableHealth()),
+	defended(unit->defended())
+{
+}
+
+size_t BattleExchangeCache::DamageKeyHash::operator()(const DamageKey & key) const
+{
+	size_t result = 0;
+
+	for(const auto & unit : {key.attacker, key.defender})
+	{
+		boost::hash_combine(result, unit.unitId);
+		boost::hash_combine(result, unit.position);
+		boost::hash_combine(result, unit.health);
+		boost::hash_combine(result, unit.defended);
+	}
+
+	boost::hash_combine(result, key.shooting);
+
+	return result;
+}
+
+const BattleExchangeCache::CachedDamage & BattleExchangeCache::estimateDamage(const BattleAttackInfo & bai, const CBattleInfoCallback & cb)
+{
+	DamageKey key{
+		UnitStateKey(bai.attacker, bai.attackerPos),
+		UnitStateKey(bai.defender, bai.defenderPos),
+		bai.shooting
+	};
+
+	damageRequests++;
+
+	auto cached = damageCache.find(key);
+
+	if(cached != damageCache.end())
+	{
+		damageHits++;
+
+		return cached->second;
+	}
+
+	CachedDamage & result = damageCache[key];
+
+	result.attack = cb.battleEstimateDamage(bai, &result.retaliation);
+
+	return result;
+}
+
+const ReachabilityInfo & BattleExchangeCache::getReachability(const battle::Unit * unit, const CBattleInfoCallback & cb)
+{
+	uint64_t key = (static_cast<uint64_t>(unit->unitId()) << 16) | static_cast<uint16_t>(unit->getPosition().hex);
+
+	reachabilityRequests++;
+
+	auto & cached = reachabilityCache[key];
+
+	if(cached)
+	{
+		reachabilityHits++;
+	}
+	else
+	{
+		cached = std::make_unique<ReachabilityInfo>(cb.getReachability(unit));
+	}
+
+	return *cached;
+}
+
 int64_t BattleExchangeVariant::trackAttack(const AttackPossibility & ap, HypotheticBattle & state)
 {
 	auto affectedUnits = ap.affectedUnits;
@@ -62,13 +138,13 @@ int64_t BattleExchangeVariant::trackAttack(
 	bool shooting,
 	bool isOurAttack,
 	const CBattleInfoCallback & cb,
+	BattleExchangeCache & cache,
 	bool evaluateOnly)
 {
 	const std::string cachingStringBlocksRetaliation = "type_BLOCKS_RETALIATION";
 	static const auto selectorBlocksRetaliation = Selector::type()(Bonus::BLOCKS_RETALIATION);
 	const bool counterAttacksBlocked = attacker->hasBonus(selectorBlocksRetaliation, cachingStringBlocksRetaliation);
 
-	DamageEstimation retaliation;
 	// FIXME: provide distance info for Jousting bonus
 	BattleAttackInfo bai(attacker.get(), defender.get(), 0, shooting);
 
@@ -77,7 +153,9 @@ int64_t BattleExchangeVariant::trackAttack(
 		bai.attackerPos.setXY(8, 5);
 	}
 
-	auto attack = cb.battleEstimateDamage(bai, &retaliation);
+	auto & estimation = cache.estimateDamage(bai, cb);
+	auto & attack = estimation.attack;
+	auto & retaliation = estimation.retaliation;
 	int64_t attackDamage = (attack.damage.min + attack.damage.max) / 2;
 	int64_t defenderDamageReduce = AttackPossibility::calculateDamageReduce(attacker.get(), defender.get(), attackDamage, cb);
 	int64_t attackerDamageReduce = 0;
@@ -176,14 +254,16 @@ EvaluationResult BattleExchangeEvaluator::findBestTarget(const battle::Unit * ac
 		logAi->trace("Evaluating waited attack for %s", activeStack->getDescription());
 #endif
 
-		hb.getForUpdate(activeStack->unitId())->waiting = true;
-		hb.getForUpdate(activeStack->unitId())->waitedThisTurn = true;
+		HypotheticBattle waitBattle(env.get(), hb);
+
+		waitBattle.getForUpdate(activeStack->unitId())->waiting = true;
+		waitBattle.getForUpdate(activeStack->unitId())->waitedThisTurn = true;
 
-		updateReachabilityMap(hb);
+		updateReachabilityMap(waitBattle);
 
 		for(auto & ap : targets.possibleAttacks)
 		{
-			int64_t score = calculateExchange(ap, targets, hb);
+			int64_t score = calculateExchange(ap, targets, waitBattle);
 
 			if(score > result.score)
 			{
@@ -374,7 +454,7 @@ int64_t BattleExchangeEvaluator::calculateExchange(
 		return 0;
 	}
 
-	HypotheticBattle exchangeBattle(env.get(), cb);
+	HypotheticBattle exchangeBattle(env.get(), hb);
 	BattleExchangeVariant v;
 	auto melleeAttackers = ourStacks;
 
@@ -427,6 +507,7 @@ int64_t BattleExchangeEvaluator::calculateExchange(
 					exchangeBattle.battleCanShoot(stackWithBonuses.get()),
 					isOur,
 					*cb,
+					cache,
 					true);
 
 #if BATTLE_TRACE_LEVEL>=1
@@ -480,7 +561,7 @@ int64_t BattleExchangeEvaluator::calculateExchange(
 		{
 			for(int i = 0; i < totalAttacks; i++)
 			{
-				v.trackAttack(attacker, defender, shooting, isOur, exchangeBattle);
+				v.trackAttack(attacker, defender, shooting, isOur, exchangeBattle, cache);
 
 				if(!attacker->alive() || !defender->alive())
 					break;
@@ -514,7 +595,7 @@ int64_t BattleExchangeEvaluator::calculateExchange(
 void BattleExchangeVariant::adjustPositions(
 	std::vector<const battle::Unit*> attackers,
 	const AttackPossibility & ap,
-	std::map<BattleHex, battle::Units> & reachabilityMap)
+	ReachabilityData & reachabilityMap)
 {
 	auto hexes = ap.attack.defender->getSurroundingHexes();
 
@@ -584,12 +665,17 @@ void BattleExchangeEvaluator::updateReachabilityMap(HypotheticBattle & hb)
 	turnOrder.clear();
 	
 	hb.battleGetTurnOrder(turnOrder, std::numeric_limits<int>::max(), TURN_DEPTH);
-	reachabilityMap.clear();
+
+	for(auto & hexUnits : reachabilityMap)
+		hexUnits.clear();
+
+	// every turn is evaluated on unchanged battle so reachability of unit is the same for all turns and all calls
+	// fork shares unit states of hb instead of creating its own ones
+	HypotheticBattle turnBattle(env.get(), hb);
 
 	for(int turn = 0; turn < turnOrder.size(); turn++)
 	{
 		auto & turnQueue = turnOrder[turn];
-		HypotheticBattle turnBattle(env.get(), cb);
 
 		for(const battle::Unit * unit : turnQueue)
 		{
@@ -603,7 +689,7 @@ void BattleExchangeEvaluator::updateReachabilityMap(HypotheticBattle & hb)
 				continue;
 			}
 
-			auto unitReachability = turnBattle.getReachability(unit);
+			auto & unitReachability = cache.getReachability(unit, turnBattle);
 
 			for(BattleHex hex = BattleHex::TOP_LEFT; hex.isValid(); hex = hex + 1)
 			{
@@ -633,6 +719,16 @@ void BattleExchangeEvaluator::updateReachabilityMap(HypotheticBattle & hb)
 	}
 }
 
+void BattleExchangeEvaluator::logCacheStatistics() const
+{
+	logAi->debug(
+		"BattleAI: exchange cache hits: damage %d of %d, reachability %d of %d",
+		cache.getDamageHits(),
+		cache.getDamageRequests(),
+		cache.getReachabilityHits(),
+		cache.getReachabilityRequests());
+}
+
 // avoid blocking path for stronger stack by weaker stack
 bool BattleExchangeEvaluator::checkPositionBlocksOurStacks(HypotheticBattle & hb, const battle::Unit * activeUnit, BattleHex position)
 {
@@ -644,13 +740,14 @@ bool BattleExchangeEvaluator::checkPositionBlocksOurStacks(HypotheticBattle & hb
 
 	auto activeUnitDamage = activeUnit->getMinDamage(hb.battleCanShoot(activeUnit)) * activeUnit->getCount();
 
+	HypotheticBattle turnBattle(env.get(), hb);
+
+	auto unitToUpdate = turnBattle.getForUpdate(activeUnit->unitId());
+	unitToUpdate->setPosition(position);
+
 	for(int turn = 0; turn < turnOrder.size(); turn++)
 	{
 		auto & turnQueue = turnOrder[turn];
-		HypotheticBattle turnBattle(env.get(), cb);
-
-		auto unitToUpdate = turnBattle.getForUpdate(activeUnit->unitId());
-		unitToUpdate->setPosition(position);
 
 		for(const battle::Unit * unit : turnQueue)
 		{
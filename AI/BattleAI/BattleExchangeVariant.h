@@ -14,6 +14,10 @@
 #include "PotentialTargets.h"
 #include "StackWithBonuses.h"
 
+#include <boost/container/flat_map.hpp>
+
+typedef std::array<battle::Units, GameConstants::BFIELD_SIZE> ReachabilityData;
+
 struct AttackerValue
 {
 	int64_t value;
@@ -47,6 +51,72 @@ struct EvaluationResult
 	}
 };
 
+/// Damage estimations and reachability calculated during one activation of BattleAI.
+/// Exchanges of different attack possibilities often repeat the same attacks of units in the same state,
+/// so units are keyed by their id, position, remaining health and defending state
+class BattleExchangeCache
+{
+public:
+	struct CachedDamage
+	{
+		DamageEstimation attack;
+		DamageEstimation retaliation;
+	};
+
+	BattleExchangeCache();
+
+	const CachedDamage & estimateDamage(const BattleAttackInfo & bai, const CBattleInfoCallback & cb);
+
+	/// reachability of unit in state of battle that owns the cache
+	const ReachabilityInfo & getReachability(const battle::Unit * unit, const CBattleInfoCallback & cb);
+
+	uint64_t getDamageHits() const { return damageHits; }
+	uint64_t getDamageRequests() const { return damageRequests; }
+	uint64_t getReachabilityHits() const { return reachabilityHits; }
+	uint64_t getReachabilityRequests() const { return reachabilityRequests; }
+
+private:
+	struct UnitStateKey
+	{
+		uint32_t unitId;
+		si16 position;
+		int64_t health;
+		bool defended;
+
+		UnitStateKey(const battle::Unit * unit, BattleHex position);
+
+		bool operator==(const UnitStateKey & other) const
+		{
+			return unitId == other.unitId && position == other.position && health == other.health && defended == other.defended;
+		}
+	};
+
+	struct DamageKey
+	{
+		UnitStateKey attacker;
+		UnitStateKey defender;
+		bool shooting;
+
+		bool operator==(const DamageKey & other) const
+		{
+			return attacker == other.attacker && defender == other.defender && shooting == other.shooting;
+		}
+	};
+
+	struct DamageKeyHash
+	{
+		size_t operator()(const DamageKey & key) const;
+	};
+
+	std::unordered_map<DamageKey, CachedDamage, DamageKeyHash> damageCache;
+	boost::container::flat_map<uint64_t, std::unique_ptr<ReachabilityInfo>> reachabilityCache;
+
+	uint64_t damageHits;
+	uint64_t damageRequests;
+	uint64_t reachabilityHits;
+	uint64_t reachabilityRequests;
+};
+
 /// <summary>
 /// The class represents evaluation of attack value
 /// of exchanges between all stacks which can access particular hex
@@ -69,6 +139,7 @@ public:
 		bool shooting,
 		bool isOurAttack,
 		const CBattleInfoCallback & cb,
+		BattleExchangeCache & cache,
 		bool evaluateOnly = false);
 
 	int64_t getScore() const { return dpsScore; }
@@ -76,11 +147,11 @@ public:
 	void adjustPositions(
 		std::vector<const battle::Unit *> attackers,
 		const AttackPossibility & ap,
-		std::map<BattleHex, battle::Units> & reachabilityMap);
+		ReachabilityData & reachabilityMap);
 
 private:
 	int64_t dpsScore;
-	std::map<uint32_t, AttackerValue> attackerValue;
+	boost::container::flat_map<uint32_t, AttackerValue> attackerValue;
 };
 
 class BattleExchangeEvaluator
@@ -88,12 +159,13 @@ class BattleExchangeEvaluator
 private:
 	std::shared_ptr<CBattleInfoCallback> cb;
 	std::shared_ptr<Environment> env;
-	std::map<BattleHex, std::vector<const battle::Unit *>> reachabilityMap;
+	ReachabilityData reachabilityMap;
 	std::vector<battle::Units> turnOrder;
+	BattleExchangeCache cache;
 
 public:
 	BattleExchangeEvaluator(std::shared_ptr<CBattleInfoCallback> cb, std::shared_ptr<Environment> env)
-		:cb(cb), reachabilityMap(), env(env), turnOrder()
+		:cb(cb), reachabilityMap(), env(env), turnOrder(), cache()
 	{
 	}
 
@@ -104,4 +176,5 @@ public:
 	bool checkPositionBlocksOurStacks(HypotheticBattle & hb, const battle::Unit * unit, BattleHex position);
 	MoveTarget findMoveTowardsUnreachable(const battle::Unit * activeStack, PotentialTargets & targets, HypotheticBattle & hb);
 	std::vector<const battle::Unit *> getAdjacentUnits(const battle::Unit * unit);
+	void logCacheStatistics() const;
 };
\ No newline at end of file
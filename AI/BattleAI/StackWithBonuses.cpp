@@ -20,6 +20,14 @@
 using scripting::Pool;
 #endif
 
+namespace
+{
+	std::atomic<uint64_t> createdBattles(0);
+	std::atomic<uint64_t> forkedBattles(0);
+	std::atomic<uint64_t> copiedUnits(0);
+	std::atomic<uint64_t> sharedUnits(0);
+}
+
 void actualizeEffect(TBonusListPtr target, const Bonus & ef)
 {
 	for(auto & bonus : *target) //TODO: optimize
@@ -72,6 +80,23 @@ StackWithBonuses::StackWithBonuses(const HypotheticBattle * Owner, const battle:
 	summoned = info.summoned;
 }
 
+StackWithBonuses::StackWithBonuses(const HypotheticBattle * Owner, const StackWithBonuses & other)
+	: battle::CUnitState(),
+	bonusChanges(other.bonusChanges),
+	origBearer(other.origBearer),
+	owner(Owner),
+	type(other.type),
+	baseAmount(other.baseAmount),
+	id(other.id),
+	side(other.side),
+	player(other.player),
+	slot(other.slot)
+{
+	localInit(Owner);
+
+	battle::CUnitState::operator=(other);
+}
+
 StackWithBonuses::~StackWithBonuses() = default;
 
 StackWithBonuses & StackWithBonuses::operator=(const battle::CUnitState & other)
@@ -113,16 +138,20 @@ SlotID StackWithBonuses::unitSlot() const
 TConstBonusListPtr StackWithBonuses::getAllBonuses(const CSelector & selector, const CSelector & limit,
 	const CBonusSystemNode * root, const std::string & cachingStr) const
 {
-	TBonusListPtr ret = std::make_shared<BonusList>();
 	TConstBonusListPtr originalList = origBearer->getAllBonuses(selector, limit, root, cachingStr);
 
+	if(!bonusChanges)
+		return originalList;
+
+	TBonusListPtr ret = std::make_shared<BonusList>();
+
 	vstd::copy_if(*originalList, std::back_inserter(*ret), [this](const std::shared_ptr<Bonus> & b)
 	{
-		return !vstd::contains(bonusesToRemove, b);
+		return !vstd::contains(bonusChanges->toRemove, b);
 	});
 
 
-	for(const Bonus & bonus : bonusesToUpdate)
+	for(const Bonus & bonus : bonusChanges->toUpdate)
 	{
 		if(selector(&bonus) && (!limit || !limit(&bonus)))
 		{
@@ -138,7 +167,7 @@ TConstBonusListPtr StackWithBonuses::getAllBonuses(const CSelector & selector, c
 		}
 	}
 
-	for(auto & bonus : bonusesToAdd)
+	for(auto & bonus : bonusChanges->toAdd)
 	{
 		auto b = std::make_shared<Bonus>(bonus);
 		if(selector(b.get()) && (!limit || !limit(b.get())))
@@ -153,16 +182,26 @@ int64_t StackWithBonuses::getTreeVersion() const
 	return owner->getTreeVersion();
 }
 
+StackWithBonuses::BonusChanges & StackWithBonuses::changeBonuses()
+{
+	if(!bonusChanges)
+		bonusChanges = std::make_shared<BonusChanges>();
+	else if(bonusChanges.use_count() > 1)
+		bonusChanges = std::make_shared<BonusChanges>(*bonusChanges);
+
+	return *bonusChanges;
+}
+
 void StackWithBonuses::addUnitBonus(const std::vector<Bonus> & bonus)
 {
-	vstd::concatenate(bonusesToAdd, bonus);
+	vstd::concatenate(changeBonuses().toAdd, bonus);
 }
 
 void StackWithBonuses::updateUnitBonus(const std::vector<Bonus> & bonus)
 {
 	//TODO: optimize, actualize to last value
 
-	vstd::concatenate(bonusesToUpdate, bonus);
+	vstd::concatenate(changeBonuses().toUpdate, bonus);
 }
 
 void StackWithBonuses::removeUnitBonus(const std::vector<Bonus> & bonus)
@@ -192,11 +231,16 @@ void StackWithBonuses::removeUnitBonus(const CSelector & selector)
 {
 	TConstBonusListPtr toRemove = origBearer->getBonuses(selector);
 
+	if(toRemove->empty() && !bonusChanges)
+		return;
+
+	auto & changes = changeBonuses();
+
 	for(auto b : *toRemove)
-		bonusesToRemove.insert(b);
+		changes.toRemove.insert(b);
 
-	vstd::erase_if(bonusesToAdd, [&](const Bonus & b){return selector(&b);});
-	vstd::erase_if(bonusesToUpdate, [&](const Bonus & b){return selector(&b);});
+	vstd::erase_if(changes.toAdd, [&](const Bonus & b){return selector(&b);});
+	vstd::erase_if(changes.toUpdate, [&](const Bonus & b){return selector(&b);});
 }
 
 std::string StackWithBonuses::getDescription() const
@@ -219,6 +263,18 @@ void StackWithBonuses::spendMana(ServerCallback * server, const int spellCost) c
 	//TODO: evaluate cast use
 }
 
+HypotheticBattleStatistics HypotheticBattleStatistics::operator-(const HypotheticBattleStatistics & other) const
+{
+	HypotheticBattleStatistics ret;
+
+	ret.battles = battles - other.battles;
+	ret.forks = forks - other.forks;
+	ret.unitCopies = unitCopies - other.unitCopies;
+	ret.sharedUnits = sharedUnits - other.sharedUnits;
+
+	return ret;
+}
+
 HypotheticBattle::HypotheticBattle(const Environment * ENV, Subject realBattle)
 	: BattleProxy(realBattle),
 	env(ENV),
@@ -229,6 +285,40 @@ HypotheticBattle::HypotheticBattle(const Environment * ENV, Subject realBattle)
 
 	nextId = 0x00F00000;
 
+	createdBattles++;
+	createCallbacks();
+}
+
+HypotheticBattle::HypotheticBattle(const Environment * ENV, HypotheticBattle & parent)
+	: BattleProxy(parent.subject),
+	stackStates(parent.stackStates),
+	env(ENV),
+	bonusTreeVersion(parent.bonusTreeVersion),
+	activeUnitId(parent.activeUnitId),
+	nextId(parent.nextId)
+{
+	for(auto & state : stackStates)
+	{
+		sharedStates.insert(state.first);
+		parent.sharedStates.insert(state.first);
+	}
+
+	forkedBattles++;
+	sharedUnits += stackStates.size();
+	createCallbacks();
+}
+
+void HypotheticBattle::preloadUnits()
+{
+	for(auto unit : BattleProxy::getUnitsIf([](const battle::Unit * u) { return true; }))
+	{
+		if(!vstd::contains(stackStates, unit->unitId()))
+			getForUpdate(unit->unitId());
+	}
+}
+
+void HypotheticBattle::createCallbacks()
+{
 	eventBus.reset(new events::EventBus());
 
 	localEnvironment.reset(new HypotheticEnvironment(this, env));
@@ -260,8 +350,15 @@ std::shared_ptr<StackWithBonuses> HypotheticBattle::getForUpdate(uint32_t id)
 
 		auto ret = std::make_shared<StackWithBonuses>(this, s);
 		stackStates[id] = ret;
+		copiedUnits++;
 		return ret;
 	}
+	else if(sharedStates.erase(id))
+	{
+		iter->second = std::make_shared<StackWithBonuses>(this, *iter->second);
+		copiedUnits++;
+		return iter->second;
+	}
 	else
 	{
 		return iter->second;
@@ -323,6 +420,7 @@ void HypotheticBattle::addUnit(uint32_t id, const JsonNode & data)
 	info.load(id, data);
 	std::shared_ptr<StackWithBonuses> newUnit = std::make_shared<StackWithBonuses>(this, info);
 	stackStates[newUnit->unitId()] = newUnit;
+	sharedStates.erase(newUnit->unitId());
 }
 
 void HypotheticBattle::moveUnit(uint32_t id, BattleHex destination)
@@ -438,6 +536,25 @@ int64_t HypotheticBattle::getTreeVersion() const
 	return getBonusBearer()->getTreeVersion() + bonusTreeVersion;
 }
 
+int64_t HypotheticBattle::getStateVersion() const
+{
+	int64_t subjectVersion = subject->battleGetStateVersion();
+
+	if(subjectVersion < 0)
+		return -1;
+
+	DerivedStateVersion::Placement placement;
+	placement.reserve(stackStates.size());
+
+	for(const auto & state : stackStates)
+	{
+		bool placed = state.second->isValidTarget(false);
+		placement.emplace_back(state.first, placed ? state.second->getPosition().hex : BattleHex::INVALID);
+	}
+
+	return stateVersion.update(subjectVersion, std::move(placement));
+}
+
 #if SCRIPTING_ENABLED
 Pool * HypotheticBattle::getContextPool() const
 {
@@ -450,6 +567,18 @@ ServerCallback * HypotheticBattle::getServerCallback()
 	return serverCallback.get();
 }
 
+HypotheticBattleStatistics HypotheticBattle::getStatistics()
+{
+	HypotheticBattleStatistics ret;
+
+	ret.battles = createdBattles;
+	ret.forks = forkedBattles;
+	ret.unitCopies = copiedUnits;
+	ret.sharedUnits = sharedUnits;
+
+	return ret;
+}
+
 HypotheticBattle::HypotheticServerCallback::HypotheticServerCallback(HypotheticBattle * owner_)
 	:owner(owner_)
 {
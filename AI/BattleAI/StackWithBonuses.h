@@ -50,14 +50,13 @@ public:
 class StackWithBonuses : public battle::CUnitState, public virtual IBonusBearer
 {
 public:
-	std::vector<Bonus> bonusesToAdd;
-	std::vector<Bonus> bonusesToUpdate;
-	std::set<std::shared_ptr<Bonus>> bonusesToRemove;
-
 	StackWithBonuses(const HypotheticBattle * Owner, const CStack * Stack);
 
 	StackWithBonuses(const HypotheticBattle * Owner, const battle::UnitInfo & info);
 
+	///copy of unit state of another hypothetic battle, bonus changes are shared until one of copies changes them
+	StackWithBonuses(const HypotheticBattle * Owner, const StackWithBonuses & other);
+
 	virtual ~StackWithBonuses();
 
 	StackWithBonuses & operator= (const battle::CUnitState & other);
@@ -88,6 +87,19 @@ public:
 	std::string getDescription() const override;
 
 private:
+	struct BonusChanges
+	{
+		std::vector<Bonus> toAdd;
+		std::vector<Bonus> toUpdate;
+		std::set<std::shared_ptr<Bonus>> toRemove;
+	};
+
+	///null if unit has no bonus changes, may be shared with copies of this unit
+	std::shared_ptr<BonusChanges> bonusChanges;
+
+	///returns bonus changes owned only by this unit
+	BonusChanges & changeBonuses();
+
 	const IBonusBearer * origBearer;
 	const HypotheticBattle * owner;
 
@@ -99,6 +111,21 @@ private:
 	SlotID slot;
 };
 
+///Number of hypothetic battle states created by all battle AI instances, used to measure evaluation throughput
+struct HypotheticBattleStatistics
+{
+	///states created directly from real battle
+	uint64_t battles = 0;
+	///states created as copy of another hypothetic state
+	uint64_t forks = 0;
+	///unit states created from real stacks or copied on first change in forked state
+	uint64_t unitCopies = 0;
+	///unit states that forked states received from parent without copying
+	uint64_t sharedUnits = 0;
+
+	HypotheticBattleStatistics operator-(const HypotheticBattleStatistics & other) const;
+};
+
 class HypotheticBattle : public BattleProxy, public battle::IUnitEnvironment
 {
 public:
@@ -108,6 +135,15 @@ public:
 
 	HypotheticBattle(const Environment * ENV, Subject realBattle);
 
+	///Creates state that starts as copy of parent state. Unit states are shared with parent and copied
+	///on first change in either of battles, so creating and discarding child states is cheap.
+	///Parent must outlive child and unit states obtained from parent before fork must not be changed afterwards
+	HypotheticBattle(const Environment * ENV, HypotheticBattle & parent);
+
+	///Creates own states of all units, so states forked from this one share them instead of reading real battle.
+	///Forking is not thread-safe, so each thread that evaluates many states should fork them from its own base state
+	void preloadUnits();
+
 	bool unitHasAmmoCart(const battle::Unit * unit) const override;
 	PlayerColor unitEffectiveOwner(const battle::Unit * unit) const override;
 
@@ -142,12 +178,16 @@ public:
 
 	int64_t getTreeVersion() const;
 
+	int64_t getStateVersion() const override;
+
 #if SCRIPTING_ENABLED
 	scripting::Pool * getContextPool() const override;
 #endif
 
 	ServerCallback * getServerCallback();
 
+	static HypotheticBattleStatistics getStatistics();
+
 private:
 
 	class HypotheticServerCallback : public ServerCallback
@@ -194,6 +234,14 @@ private:
 	int32_t activeUnitId;
 	mutable uint32_t nextId;
 
+	///ids of unit states that are shared with parent or child state and must be copied before update
+	std::set<uint32_t> sharedStates;
+
+	///unit states can be changed directly, so state version is changed when placement of units differs from one seen by previous query
+	mutable DerivedStateVersion stateVersion;
+
+	void createCallbacks();
+
 	std::unique_ptr<HypotheticServerCallback> serverCallback;
 	std::unique_ptr<HypotheticEnvironment> localEnvironment;
 
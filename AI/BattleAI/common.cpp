@@ -10,7 +10,8 @@
 #include "StdInc.h"
 #include "common.h"
 
-std::shared_ptr<CBattleCallback> cbc;
+//thread-local, so that several battles can be simulated in parallel
+thread_local std::shared_ptr<CBattleCallback> cbc;
 
 void setCbc(std::shared_ptr<CBattleCallback> cb)
 {
@@ -15,6 +15,8 @@
 #include "../../lib/CHeroHandler.h"
 #include "../../lib/GameSettings.h"
 #include "../../lib/CGameState.h"
+#include "../../lib/CPathfinder.h"
+#include "../../lib/AIBenchmark.h"
 #include "../../lib/NetPacks.h"
 #include "../../lib/serializer/CTypeList.h"
 #include "../../lib/serializer/BinarySerializer.h"
@@ -59,7 +61,7 @@ struct SetGlobalState
 
 #define SET_GLOBAL_STATE(ai) SetGlobalState _hlpSetState(ai);
 
-#define NET_EVENT_HANDLER SET_GLOBAL_STATE(this)
+#define NET_EVENT_HANDLER SET_GLOBAL_STATE(this); boost::lock_guard<boost::recursive_mutex> _hlpPreparationLock(turnPreparationMutex)
 #define MAKING_TURN SET_GLOBAL_STATE(this)
 
 AIGateway::AIGateway()
@@ -92,6 +94,11 @@ void AIGateway::heroMoved(const TryMoveHero & details, bool verbose)
 	validateObject(details.id); //enemy hero may have left visible area
 	auto hero = cb->getHero(details.id);
 
+	if(hero && cb->getPlayerRelations(hero->tempOwner, playerID) == PlayerRelations::ENEMIES)
+	{
+		nullkiller->dangerHitMap->resetHero(hero);
+	}
+
 	const int3 from = hero ? hero->convertToVisitablePos(details.start) : (details.start - int3(0,1,0));;
 	const int3 to   = hero ? hero->convertToVisitablePos(details.end)   : (details.end   - int3(0,1,0));
 
@@ -341,6 +348,8 @@ void AIGateway::newObject(const CGObjectInstance * obj)
 	NET_EVENT_HANDLER;
 	if(obj->isVisitable())
 		addVisitableObj(obj);
+
+	nullkiller->dangerHitMap->objectChanged(obj);
 }
 
 //to prevent AI from accessing objects that got deleted while they became invisible (Cover of Darkness, enemy hero moved etc.) below code allows AI to know deletion of objects out of sight
@@ -360,10 +369,7 @@ void AIGateway::objectRemoved(const CGObjectInstance * obj)
 		lostHero(cb->getHero(obj->id)); //we can promote, since objectRemoved is called just before actual deletion
 	}
 
-	if(obj->ID == Obj::HERO && cb->getPlayerRelations(obj->tempOwner, playerID) == PlayerRelations::ENEMIES)
-	{
-		nullkiller->dangerHitMap->reset();
-	}
+	nullkiller->dangerHitMap->objectRemoved(obj);
 }
 
 void AIGateway::showHillFortWindow(const CGObjectInstance * object, const CGHeroInstance * visitor)
@@ -461,6 +467,9 @@ void AIGateway::objectPropertyChanged(const SetObjectProperty * sop)
 
 		if(obj)
 		{
+			//flagged garrison may let heroes of new owner pass
+			nullkiller->dangerHitMap->objectChanged(obj);
+
 			if(relations == PlayerRelations::ENEMIES)
 			{
 				//we want to visit objects owned by oppponents
@@ -535,10 +544,22 @@ void AIGateway::initGameInterface(std::shared_ptr<Environment> env, std::shared_
 	retrieveVisitableObjs();
 }
 
+void AIGateway::playerStartsTurn(PlayerColor player)
+{
+	LOG_TRACE(logAi);
+	NET_EVENT_HANDLER;
+
+	if(player == playerID)
+		stopTurnPreparation();
+	else if(myCb->getPlayerStatus(playerID, false) == EPlayerStatus::INGAME)
+		startTurnPreparation();
+}
+
 void AIGateway::yourTurn()
 {
 	LOG_TRACE(logAi);
 	NET_EVENT_HANDLER;
+	stopTurnPreparation();
 	status.startedTurn();
 	makingTurn = std::make_unique<boost::thread>(&AIGateway::makeTurn, this);
 }
@@ -770,6 +791,9 @@ void AIGateway::makeTurn()
 	boost::shared_lock<boost::shared_mutex> gsLock(CGameState::mutex);
 	setThreadName("AIGateway::makeTurn");
 
+	auto turnStart = std::chrono::high_resolution_clock::now();
+	auto pathfinderNodesAtStart = nullkiller->getPathfinderNodes();
+
 	if(cb->getDate(Date::DAY_OF_WEEK) == 1)
 	{
 		std::vector<const CGObjectInstance *> objs;
@@ -818,6 +842,26 @@ void AIGateway::makeTurn()
 	}
 #endif
 
+	if(AIBenchmark::get().isActive())
+	{
+		AITurnReport report;
+
+		report.player = playerID;
+		report.ai = dllName;
+		report.day = day;
+		report.turnTime = timeElapsed(turnStart);
+		report.pathfinderNodes = nullkiller->getPathfinderNodes() - pathfinderNodesAtStart;
+		report.sections = nullkiller->getTurnSections();
+		report.counters["evaluatedTasks"] = nullkiller->getEvaluatedTasks();
+		report.counters["priorityEvaluationTime"] = nullkiller->getPriorityEvaluationTime();
+
+		// times of behaviors evaluated at once are summed, so this is throughput of evaluation of single behavior
+		if(nullkiller->getPriorityEvaluationTime() > 0)
+			report.counters["evaluatedTasksPerSecond"] = nullkiller->getEvaluatedTasks() * 1000000 / nullkiller->getPriorityEvaluationTime();
+
+		AIBenchmark::get().addTurn(report);
+	}
+
 	endTurn();
 }
 
@@ -1156,7 +1200,7 @@ void AIGateway::addVisitableObj(const CGObjectInstance * obj)
 
 	if(obj->ID == Obj::HERO && cb->getPlayerRelations(obj->tempOwner, playerID) == PlayerRelations::ENEMIES)
 	{
-		nullkiller->dangerHitMap->reset();
+		nullkiller->dangerHitMap->resetHero(dynamic_cast<const CGHeroInstance *>(obj));
 	}
 }
 
@@ -1490,6 +1534,74 @@ void AIGateway::finish()
 		makingTurn->join();
 		makingTurn.reset();
 	}
+
+	if(preparingTurn)
+	{
+		preparingTurn->interrupt();
+		preparingTurn->join();
+		preparingTurn.reset();
+	}
+}
+
+void AIGateway::startTurnPreparation()
+{
+	boost::lock_guard<boost::mutex> multipleCleanupGuard(turnInterruptionMutex);
+
+	if(!preparingTurn && nullkiller)
+		preparingTurn = std::make_unique<boost::thread>(&AIGateway::prepareNextTurn, this);
+}
+
+void AIGateway::stopTurnPreparation()
+{
+	boost::lock_guard<boost::mutex> multipleCleanupGuard(turnInterruptionMutex);
+
+	if(preparingTurn)
+	{
+		preparingTurn->interrupt();
+		preparingTurn->join();
+		preparingTurn.reset();
+	}
+}
+
+void AIGateway::prepareNextTurn()
+{
+	SET_GLOBAL_STATE(this);
+	setThreadName("AIGateway::prepareNextTurn");
+
+	try
+	{
+		while(true)
+		{
+			bool hasWork = false;
+
+			{
+				// event handlers have priority, if one is running now step will be retried later
+				boost::unique_lock<boost::recursive_mutex> preparationLock(turnPreparationMutex, boost::try_to_lock);
+
+				if(preparationLock.owns_lock())
+				{
+					// each step recomputes single enemy hero, so game state is unlocked between heroes
+					boost::shared_lock<boost::shared_mutex> gsLock(CGameState::mutex);
+
+					hasWork = nullkiller->prepareNextTurn();
+				}
+			}
+
+			if(hasWork)
+				boost::this_thread::interruption_point();
+			else
+				boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+		}
+	}
+	catch(boost::thread_interrupted & e)
+	{
+		(void)e;
+		logAi->debug("Preparation of next turn has been interrupted.");
+	}
+	catch(std::exception & e)
+	{
+		logAi->error("Preparation of next turn has caught an exception: %s", e.what());
+	}
 }
 
 void AIGateway::requestActionASAP(std::function<void()> whatToDo)
@@ -1497,6 +1609,8 @@ void AIGateway::requestActionASAP(std::function<void()> whatToDo)
 	boost::thread newThread([this, whatToDo]()
 	{
 		setThreadName("AIGateway::requestActionASAP::whatToDo");
+		// state prepared for next turn may be changed by requested action
+		stopTurnPreparation();
 		SET_GLOBAL_STATE(this);
 		boost::shared_lock<boost::shared_mutex> gsLock(CGameState::mutex);
 		whatToDo();
@@ -94,8 +94,11 @@ public:
 	std::string battlename;
 	std::shared_ptr<CCallback> myCb;
 	std::unique_ptr<boost::thread> makingTurn;
+	std::unique_ptr<boost::thread> preparingTurn;
 private:
 	boost::mutex turnInterruptionMutex;
+	/// held by event handlers and by each step of next turn preparation so they never touch AI state at the same time
+	boost::recursive_mutex turnPreparationMutex;
 public:
 	ObjectInstanceID selectedObject;
 
@@ -133,6 +136,7 @@ public:
 	void showTavernWindow(const CGObjectInstance * townOrTavern) override;
 	void showThievesGuildWindow(const CGObjectInstance * obj) override;
 	void playerBlocked(int reason, bool start) override;
+	void playerStartsTurn(PlayerColor player) override;
 	void showPuzzleMap() override;
 	void showShipyardDialog(const IShipyard * obj) override;
 	void gameOver(PlayerColor player, const EVictoryLossCheckResult & victoryLossCheckResult) override;
@@ -208,6 +212,11 @@ public:
 	//special function that can be called ONLY from game events handling thread and will send request ASAP
 	void requestActionASAP(std::function<void()> whatToDo);
 
+	/// starts background thread that updates AI state while other players make their turns
+	void startTurnPreparation();
+	void stopTurnPreparation();
+	void prepareNextTurn();
+
 	template<typename Handler> void serializeInternal(Handler & h, const int version)
 	{
 		h & nullkiller->memory->knownTeleportChannels;
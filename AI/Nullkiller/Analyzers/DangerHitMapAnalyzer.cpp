@@ -16,21 +16,25 @@ namespace NKAI
 
 HitMapInfo HitMapInfo::NoTreat;
 
-void DangerHitMapAnalyzer::updateHitMap()
+DangerHitMapAnalyzer::DangerHitMapAnalyzer(Nullkiller * ai)
+	:upToDate(false), ai(ai), pathfinder(new AIPathfinder(ai->cb.get(), ai))
 {
-	if(upToDate)
-		return;
+}
 
-	logAi->trace("Update danger hitmap");
+DangerHitMapAnalyzer::~DangerHitMapAnalyzer() = default;
 
-	upToDate = true;
-	auto start = std::chrono::high_resolution_clock::now();
+bool DangerHitMapAnalyzer::hasSharedStorage()
+{
+	return pathfinder->hasSharedStorage();
+}
 
-	auto cb = ai->cb.get();
-	auto mapSize = ai->cb->getMapSize();
-	hitMap.resize(boost::extents[mapSize.x][mapSize.y][mapSize.z]);
-	enemyHeroAccessibleObjects.clear();
+uint64_t DangerHitMapAnalyzer::getPathfinderNodes() const
+{
+	return pathfinder->getExpandedNodes();
+}
 
+std::map<PlayerColor, std::map<const CGHeroInstance *, HeroRole>> DangerHitMapAnalyzer::getEnemyHeroes() const
+{
 	std::map<PlayerColor, std::map<const CGHeroInstance *, HeroRole>> heroes;
 
 	for(const CGObjectInstance * obj : ai->memory->visitableObjs)
@@ -43,64 +47,292 @@ void DangerHitMapAnalyzer::updateHitMap()
 		}
 	}
 
-	foreach_tile_pos([&](const int3 & pos){
-		hitMap[pos.x][pos.y][pos.z].reset();
+	for(auto i = heroes.begin(); i != heroes.end();)
+	{
+		if(!i->first.isValidPlayer() || ai->cb->getPlayerRelations(ai->playerID, i->first) != PlayerRelations::ENEMIES)
+			i = heroes.erase(i);
+		else
+			i++;
+	}
+
+	return heroes;
+}
+
+bool DangerHitMapAnalyzer::isLayerUpToDate(const CGHeroInstance * hero) const
+{
+	auto layer = layers.find(hero->id);
+
+	if(layer == layers.end() || !layer->second.upToDate || layer->second.hero != hero)
+		return false;
+
+	EnemyHeroState current = {hero->visitablePos(), hero->getArmyStrength(), hero->movement};
+
+	return layer->second.state == current;
+}
+
+uint32_t DangerHitMapAnalyzer::getTileIndex(const int3 & tile, const int3 & mapSize)
+{
+	return (tile.z * mapSize.x + tile.x) * mapSize.y + tile.y;
+}
+
+bool DangerHitMapAnalyzer::isTileThreatened(const EnemyHeroLayer & layer, const int3 & tile, const int3 & mapSize)
+{
+	auto index = getTileIndex(tile, mapSize);
+	auto danger = std::lower_bound(layer.tiles.begin(), layer.tiles.end(), index, [&](const HeroTileDanger & node, uint32_t value) -> bool
+	{
+		return getTileIndex(node.tile, mapSize) < value;
 	});
 
-	for(auto pair : heroes)
+	return danger != layer.tiles.end() && danger->tile == tile;
+}
+
+void DangerHitMapAnalyzer::markTilesChanged(const EnemyHeroLayer & layer)
+{
+	for(auto & danger : layer.tiles)
+		changedTiles.push_back(danger.tile);
+
+	upToDate = false;
+}
+
+int DangerHitMapAnalyzer::updateLayers(const std::map<const CGHeroInstance *, HeroRole> & heroes)
+{
+	std::map<const CGHeroInstance *, HeroRole> outdatedHeroes;
+
+	for(auto & hero : heroes)
 	{
-		if(!pair.first.isValidPlayer())
-			continue;
+		if(!isLayerUpToDate(hero.first))
+			outdatedHeroes.insert(hero);
+	}
 
-		if(ai->cb->getPlayerRelations(ai->playerID, pair.first) != PlayerRelations::ENEMIES)
-			continue;
+	if(outdatedHeroes.empty())
+		return 0;
 
-		ai->pathfinder->updatePaths(pair.second, PathfinderSettings());
+	auto cb = ai->cb.get();
+	auto mapSize = cb->getMapSize();
+	std::map<const CGHeroInstance *, EnemyHeroLayer *> outdatedLayers;
 
-		boost::this_thread::interruption_point();
+	for(auto & hero : outdatedHeroes)
+	{
+		auto & layer = layers[hero.first->id];
 
-		pforeachTilePos(mapSize, [&](const int3 & pos)
+		// tiles that hero threatened before have to be merged again even if it does not reach them anymore
+		markTilesChanged(layer);
+
+		layer.hero = hero.first;
+		layer.state = {hero.first->visitablePos(), hero.first->getArmyStrength(), hero.first->movement};
+		layer.tiles.clear();
+		layer.accessibleObjects.clear();
+		layer.upToDate = false;
+
+		outdatedLayers[hero.first] = &layer;
+	}
+
+	pathfinder->updatePaths(outdatedHeroes, PathfinderSettings());
+
+	boost::this_thread::interruption_point();
+
+	using LayerTileDanger = std::pair<EnemyHeroLayer *, HeroTileDanger>;
+
+	// each map column is processed by single thread, danger is collected per column and then moved to layers
+	std::vector<std::vector<LayerTileDanger>> columns(mapSize.x * mapSize.z);
+
+	pforeachTilePos(mapSize, [&](const int3 & pos)
+	{
+		auto & column = columns[pos.z * mapSize.x + pos.x];
+		size_t tileStart = column.size();
+
+		for(AIPath & path : pathfinder->getPathInfo(pos))
 		{
-			for(AIPath & path : ai->pathfinder->getPathInfo(pos))
+			if(path.getFirstBlockedAction())
+				continue;
+
+			auto layer = outdatedLayers.find(path.targetHero);
+
+			if(layer == outdatedLayers.end())
+				continue;
+
+			auto tileDanger = path.getHeroStrength();
+			auto turn = path.turn();
+			auto danger = std::find_if(column.begin() + tileStart, column.end(), [&](const LayerTileDanger & other) -> bool
+			{
+				return other.first == layer->second;
+			});
+
+			if(danger == column.end())
 			{
-				if(path.getFirstBlockedAction())
-					continue;
-
-				auto tileDanger = path.getHeroStrength();
-				auto turn = path.turn();
-				auto & node = hitMap[pos.x][pos.y][pos.z];
-
-				if(tileDanger / (turn / 3 + 1) > node.maximumDanger.danger / (node.maximumDanger.turn / 3 + 1)
-					|| (tileDanger == node.maximumDanger.danger && node.maximumDanger.turn > turn))
-				{
-					node.maximumDanger.danger = tileDanger;
-					node.maximumDanger.turn = turn;
-					node.maximumDanger.hero = path.targetHero;
-				}
-
-				if(turn < node.fastestDanger.turn
-					|| (turn == node.fastestDanger.turn && node.fastestDanger.danger < tileDanger))
-				{
-					node.fastestDanger.danger = tileDanger;
-					node.fastestDanger.turn = turn;
-					node.fastestDanger.hero = path.targetHero;
-				}
-
-				if(turn == 0)
-				{
-					auto objects = cb->getVisitableObjs(pos, false);
-					
-					for(auto obj : objects)
-					{
-						if(cb->getPlayerRelations(obj->tempOwner, ai->playerID) != PlayerRelations::ENEMIES)
-							enemyHeroAccessibleObjects[path.targetHero].insert(obj);
-					}
-				}
+				column.emplace_back(layer->second, HeroTileDanger());
+				danger = std::prev(column.end());
+				danger->second.tile = pos;
 			}
-		});
+
+			auto & node = danger->second;
+
+			if(tileDanger / (turn / 3 + 1) > node.maximumDanger / (node.maximumDangerTurn / 3 + 1)
+				|| (tileDanger == node.maximumDanger && node.maximumDangerTurn > turn))
+			{
+				node.maximumDanger = tileDanger;
+				node.maximumDangerTurn = turn;
+			}
+
+			if(turn < node.fastestDangerTurn
+				|| (turn == node.fastestDangerTurn && node.fastestDanger < tileDanger))
+			{
+				node.fastestDanger = tileDanger;
+				node.fastestDangerTurn = turn;
+			}
+		}
+	});
+
+	for(auto & column : columns)
+	{
+		for(auto & danger : column)
+			danger.first->tiles.push_back(danger.second);
 	}
 
-	logAi->trace("Danger hit map updated in %ld", timeElapsed(start));
+	for(auto & layer : outdatedLayers)
+	{
+		for(auto & danger : layer.second->tiles)
+		{
+			// objects are accessible if there is unblocked path to them in current turn
+			if(danger.fastestDangerTurn != 0)
+				continue;
+
+			for(auto obj : cb->getVisitableObjs(danger.tile, false))
+			{
+				if(cb->getPlayerRelations(obj->tempOwner, ai->playerID) != PlayerRelations::ENEMIES)
+					layer.second->accessibleObjects.insert(obj);
+			}
+		}
+
+		markTilesChanged(*layer.second);
+		layer.second->upToDate = true;
+	}
+
+	return outdatedHeroes.size();
+}
+
+void DangerHitMapAnalyzer::mergeLayers()
+{
+	auto mapSize = ai->cb->getMapSize();
+	bool resized = hitMap.shape()[0] != mapSize.x || hitMap.shape()[1] != mapSize.y || hitMap.shape()[2] != mapSize.z;
+	std::vector<bool> changed(mapSize.x * mapSize.y * mapSize.z, resized);
+
+	if(resized)
+	{
+		hitMap.resize(boost::extents[mapSize.x][mapSize.y][mapSize.z]);
+		std::fill_n(hitMap.data(), hitMap.num_elements(), HitMapNode());
+	}
+	else
+	{
+		for(auto & tile : changedTiles)
+		{
+			changed[getTileIndex(tile, mapSize)] = true;
+			hitMap[tile.x][tile.y][tile.z].reset();
+		}
+	}
+
+	changedTiles.clear();
+
+	for(auto & layer : layers)
+	{
+		for(auto & node : layer.second.tiles)
+		{
+			if(!changed[getTileIndex(node.tile, mapSize)])
+				continue;
+
+			auto & result = hitMap[node.tile.x][node.tile.y][node.tile.z];
+
+			if(node.maximumDanger / (node.maximumDangerTurn / 3 + 1) > result.maximumDanger.danger / (result.maximumDanger.turn / 3 + 1)
+				|| (node.maximumDanger == result.maximumDanger.danger && result.maximumDanger.turn > node.maximumDangerTurn))
+			{
+				result.maximumDanger.danger = node.maximumDanger;
+				result.maximumDanger.turn = node.maximumDangerTurn;
+				result.maximumDanger.hero = layer.second.hero;
+			}
+
+			if(node.fastestDangerTurn < result.fastestDanger.turn
+				|| (node.fastestDangerTurn == result.fastestDanger.turn && result.fastestDanger.danger < node.fastestDanger))
+			{
+				result.fastestDanger.danger = node.fastestDanger;
+				result.fastestDanger.turn = node.fastestDangerTurn;
+				result.fastestDanger.hero = layer.second.hero;
+			}
+		}
+	}
+}
+
+void DangerHitMapAnalyzer::updateHitMap()
+{
+	if(upToDate)
+		return;
+
+	logAi->trace("Update danger hitmap");
+
+	auto start = std::chrono::high_resolution_clock::now();
+	auto heroes = getEnemyHeroes();
+	int recomputed = 0;
+
+	std::set<const CGHeroInstance *> knownHeroes;
+
+	for(auto & pair : heroes)
+	{
+		for(auto & hero : pair.second)
+			knownHeroes.insert(hero.first);
+	}
+
+	// forget heroes that are not known anymore
+	for(auto layer = layers.begin(); layer != layers.end();)
+	{
+		if(vstd::contains(knownHeroes, layer->second.hero))
+		{
+			layer++;
+			continue;
+		}
+
+		markTilesChanged(layer->second);
+		layer = layers.erase(layer);
+	}
+
+	for(auto & pair : heroes)
+	{
+		recomputed += updateLayers(pair.second);
+
+		boost::this_thread::interruption_point();
+	}
+
+	mergeLayers();
+
+	upToDate = true;
+
+	logAi->trace("Danger hit map updated in %ld, %d of %d enemy heroes recomputed", timeElapsed(start), recomputed, knownHeroes.size());
+}
+
+bool DangerHitMapAnalyzer::updateOutdatedLayer()
+{
+	auto heroes = getEnemyHeroes();
+	auto currentPlayer = ai->cb->getCurrentPlayer();
+
+	for(auto & pair : heroes)
+	{
+		// heroes of player that is making turn right now will change anyway, wait until they stop
+		if(pair.first == currentPlayer)
+			continue;
+
+		for(auto & hero : pair.second)
+		{
+			if(isLayerUpToDate(hero.first))
+				continue;
+
+			auto start = std::chrono::high_resolution_clock::now();
+
+			updateLayers({hero});
+			logAi->trace("Danger of hero %s of player %s updated in %ld", hero.first->getNameTranslated(), pair.first.getStr(), timeElapsed(start));
+
+			return true;
+		}
+	}
+
+	return false;
 }
 
 uint64_t DangerHitMapAnalyzer::enemyCanKillOurHeroesAlongThePath(const AIPath & path) const
@@ -131,19 +363,90 @@ const std::set<const CGObjectInstance *> empty = {};
 
 const std::set<const CGObjectInstance *> & DangerHitMapAnalyzer::getOneTurnAccessibleObjects(const CGHeroInstance * enemy) const
 {
-	auto result = enemyHeroAccessibleObjects.find(enemy);
-	
-	if(result == enemyHeroAccessibleObjects.end())
+	auto layer = layers.find(enemy->id);
+
+	if(layer == layers.end() || layer->second.hero != enemy)
 	{
 		return empty;
 	}
 
-	return result->second;
+	return layer->second.accessibleObjects;
 }
 
 void DangerHitMapAnalyzer::reset()
 {
 	upToDate = false;
+
+	for(auto & layer : layers)
+		layer.second.upToDate = false;
+}
+
+void DangerHitMapAnalyzer::markOutdated()
+{
+	upToDate = false;
+}
+
+void DangerHitMapAnalyzer::resetHero(const CGHeroInstance * hero)
+{
+	upToDate = false;
+
+	auto layer = layers.find(hero->id);
+
+	if(layer != layers.end())
+		layer->second.upToDate = false;
+}
+
+void DangerHitMapAnalyzer::objectRemoved(const CGObjectInstance * obj)
+{
+	if(obj->ID == Obj::HERO)
+	{
+		auto hero = dynamic_cast<const CGHeroInstance *>(obj);
+		auto layer = layers.find(hero->id);
+
+		if(layer != layers.end() && layer->second.hero == hero)
+		{
+			markTilesChanged(layer->second);
+			layers.erase(layer);
+		}
+	}
+	else
+	{
+		objectChanged(obj);
+	}
+
+	for(auto & layer : layers)
+		layer.second.accessibleObjects.erase(obj);
+}
+
+void DangerHitMapAnalyzer::objectChanged(const CGObjectInstance * obj)
+{
+	if(obj->ID == Obj::HERO || !(obj->blockVisit || obj->ID == Obj::BOAT))
+		return;
+
+	auto mapSize = ai->cb->getMapSize();
+	auto pos = obj->visitablePos();
+
+	for(auto & layer : layers)
+	{
+		if(!layer.second.upToDate)
+			continue;
+
+		bool reached = isTileThreatened(layer.second, pos, mapSize);
+
+		for(const int3 & dir : int3::getDirs())
+		{
+			const int3 neighbour = pos + dir;
+
+			if(!reached && ai->cb->isInTheMap(neighbour))
+				reached = isTileThreatened(layer.second, neighbour, mapSize);
+		}
+
+		if(reached)
+		{
+			layer.second.upToDate = false;
+			upToDate = false;
+		}
+	}
 }
 
 }
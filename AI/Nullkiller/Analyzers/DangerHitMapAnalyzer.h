@@ -14,6 +14,8 @@
 namespace NKAI
 {
 
+class AIPathfinder;
+
 struct HitMapInfo
 {
 	static HitMapInfo NoTreat;
@@ -52,20 +54,88 @@ struct HitMapNode
 class DangerHitMapAnalyzer
 {
 private:
+	/// danger caused by single enemy hero on single tile
+	struct HeroTileDanger
+	{
+		int3 tile;
+		uint64_t maximumDanger = 0;
+		uint64_t fastestDanger = 0;
+		uint8_t maximumDangerTurn = 255;
+		uint8_t fastestDangerTurn = 255;
+	};
+
+	/// state of enemy hero at the moment when its danger was computed
+	struct EnemyHeroState
+	{
+		int3 position;
+		uint64_t army;
+		uint32_t movement;
+
+		bool operator==(const EnemyHeroState & other) const
+		{
+			return position == other.position && army == other.army && movement == other.movement;
+		}
+	};
+
+	/// tiles threatened by one enemy hero. Layers of heroes that did not change are kept between updates
+	/// so only heroes that moved, changed army or movement points are passed to pathfinder again
+	struct EnemyHeroLayer
+	{
+		const CGHeroInstance * hero = nullptr;
+		EnemyHeroState state;
+		/// only tiles reachable by hero, sorted by tile index
+		std::vector<HeroTileDanger> tiles;
+		std::set<const CGObjectInstance *> accessibleObjects;
+		bool upToDate = false;
+	};
+
 	boost::multi_array<HitMapNode, 3> hitMap;
-	std::map<const CGHeroInstance *, std::set<const CGObjectInstance *>> enemyHeroAccessibleObjects;
+	std::map<ObjectInstanceID, EnemyHeroLayer> layers;
+	/// tiles of hit map that have to be merged again because some layers changed on them since last merge
+	std::vector<int3> changedTiles;
 	bool upToDate;
 	const Nullkiller * ai;
+	/// danger is computed with own node storage, so that computing it between turns does not overwrite paths of own heroes
+	std::unique_ptr<AIPathfinder> pathfinder;
+
+	std::map<PlayerColor, std::map<const CGHeroInstance *, HeroRole>> getEnemyHeroes() const;
+	bool isLayerUpToDate(const CGHeroInstance * hero) const;
+	/// recomputes layers of outdated heroes of one enemy player using single pathfinder run, returns number of recomputed heroes
+	int updateLayers(const std::map<const CGHeroInstance *, HeroRole> & heroes);
+	/// merges changed tiles of all layers into hit map, whole map is only merged if its size changed
+	void mergeLayers();
+	void markTilesChanged(const EnemyHeroLayer & layer);
+	static bool isTileThreatened(const EnemyHeroLayer & layer, const int3 & tile, const int3 & mapSize);
+	/// tiles of map column have consecutive indices, so layer tiles collected column by column are sorted
+	static uint32_t getTileIndex(const int3 & tile, const int3 & mapSize);
 
 public:
-	DangerHitMapAnalyzer(const Nullkiller * ai) :ai(ai) {}
+	DangerHitMapAnalyzer(Nullkiller * ai);
+	~DangerHitMapAnalyzer();
 
 	void updateHitMap();
+	/// recomputes danger of single outdated enemy hero, so that game state is not locked for long
+	/// returns false if there is nothing to recompute. Called between own turns, game state must be locked by caller
+	bool updateOutdatedLayer();
+	/// true if pathfinder uses shared node storage, which can only be used while holding AISharedStorage::locker
+	bool hasSharedStorage();
+	/// number of nodes expanded by pathfinder while computing danger of enemy heroes
+	uint64_t getPathfinderNodes() const;
 	uint64_t enemyCanKillOurHeroesAlongThePath(const AIPath & path) const;
 	const HitMapNode & getObjectTreat(const CGObjectInstance * obj) const;
 	const HitMapNode & getTileTreat(const int3 & tile) const;
 	const std::set<const CGObjectInstance *> & getOneTurnAccessibleObjects(const CGHeroInstance * enemy) const;
+	/// forces recomputation of danger of all enemy heroes
 	void reset();
+	/// forces merged map to be rebuilt on next update, danger of heroes that did not change is reused
+	void markOutdated();
+	/// marks danger caused by specific enemy hero as outdated
+	void resetHero(const CGHeroInstance * hero);
+	/// forgets object that is about to be deleted without recomputing whole map
+	void objectRemoved(const CGObjectInstance * obj);
+	/// marks danger of heroes that reach object as outdated if object can block or open their way,
+	/// e.g. new boat, garrison flagged by other player or guard that is about to be removed
+	void objectChanged(const CGObjectInstance * obj);
 };
 
 }
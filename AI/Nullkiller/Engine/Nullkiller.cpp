@@ -20,6 +20,8 @@
 #include "../Behaviors/ClusterBehavior.h"
 #include "../Goals/Invalid.h"
 #include "../Goals/Composition.h"
+#include "../../../lib/CConfigHandler.h"
+#include "../../../lib/Profiler.h"
 
 namespace NKAI
 {
@@ -35,6 +37,29 @@ using namespace Goals;
 #define MAXPASS 30
 #endif
 
+/// behaviors access game and AI through thread-specific pointers so they have to be set in worker threads too
+/// previous values are restored because worker may be executing task of another AI instance while waiting for nested tasks
+struct WorkerGlobalState
+{
+	AIGateway * previousAi;
+	CCallback * previousCb;
+
+	WorkerGlobalState(AIGateway * gateway)
+		:previousAi(ai.release()), previousCb(cb.release())
+	{
+		ai.reset(gateway);
+		cb.reset(gateway->myCb.get());
+	}
+
+	~WorkerGlobalState()
+	{
+		ai.release();
+		cb.release();
+		ai.reset(previousAi);
+		cb.reset(previousCb);
+	}
+};
+
 Nullkiller::Nullkiller()
 {
 	memory.reset(new AIMemory());
@@ -45,7 +70,12 @@ void Nullkiller::init(std::shared_ptr<CCallback> cb, PlayerColor playerID)
 	this->cb = cb;
 	this->playerID = playerID;
 
-	priorityEvaluator.reset(new PriorityEvaluator(this));
+	const JsonNode & timeBudget = settings["server"]["aiTimeBudget"]["Nullkiller"];
+
+	//negative limits are rejected by schema, but settings may be edited by hand
+	turnTimeLimit = std::max<si64>(0, timeBudget["turn"].Integer());
+	passTimeLimit = std::max<si64>(0, timeBudget["pass"].Integer());
+
 	priorityEvaluators.reset(
 		new SharedPool<PriorityEvaluator>(
 			[&]()->std::unique_ptr<PriorityEvaluator>
@@ -73,27 +103,89 @@ Goals::TTask Nullkiller::choseBestTask(Goals::TTaskVec & tasks) const
 }
 
 Goals::TTask Nullkiller::choseBestTask(Goals::TSubgoal behavior, int decompositionMaxDepth) const
+{
+	return choseBestTask(behavior, decompositionMaxDepth, *decomposer);
+}
+
+Goals::TTaskVec Nullkiller::choseBestTasks(const std::vector<std::pair<Goals::TSubgoal, int>> & behaviors) const
+{
+	boost::this_thread::interruption_point();
+
+	Goals::TTaskVec tasks(behaviors.size());
+	AIGateway * gateway = ai.get();
+
+	// every behavior writes only into its own slot so order of tasks and therefore choice between equal priorities does not depend on scheduling
+	parallel_for(blocked_range<size_t>(0, behaviors.size(), 1), [&](const blocked_range<size_t> & r)
+	{
+		WorkerGlobalState globalState(gateway);
+
+		for(size_t i = r.begin(); i != r.end(); i++)
+		{
+			DeepDecomposer behaviorDecomposer;
+
+			tasks[i] = choseBestTask(behaviors[i].first, behaviors[i].second, behaviorDecomposer);
+		}
+	});
+
+	boost::this_thread::interruption_point();
+
+	return tasks;
+}
+
+void Nullkiller::addTurnSection(const std::string & name, uint64_t time) const
+{
+	boost::unique_lock<boost::mutex> lock(turnSectionsSync);
+
+	turnSections[name] += time;
+}
+
+uint64_t Nullkiller::getPathfinderNodes() const
+{
+	return pathfinder->getExpandedNodes() + dangerHitMap->getPathfinderNodes();
+}
+
+Goals::TTask Nullkiller::choseBestTask(Goals::TSubgoal behavior, int decompositionMaxDepth, DeepDecomposer & behaviorDecomposer) const
 {
 	boost::this_thread::interruption_point();
 
 	logAi->debug("Checking behavior %s", behavior->toString());
+	PROFILE_ZONE("Nullkiller::choseBestTask");
 
 	auto start = std::chrono::high_resolution_clock::now();
 	
-	Goals::TGoalVec elementarGoals = decomposer->decompose(behavior, decompositionMaxDepth);
-	Goals::TTaskVec tasks;
+	Goals::TGoalVec elementarGoals = behaviorDecomposer.decompose(behavior, decompositionMaxDepth);
+	Goals::TTaskVec tasks(elementarGoals.size());
 
 	boost::this_thread::interruption_point();
-	
-	for(auto goal : elementarGoals)
+
+	auto evaluationStart = std::chrono::high_resolution_clock::now();
+
+	parallel_for(blocked_range<size_t>(0, elementarGoals.size()), [&](const blocked_range<size_t> & r)
 	{
-		Goals::TTask task = Goals::taskptr(*goal);
+		PROFILE_ZONE("Nullkiller priority evaluation");
+		auto evaluator = priorityEvaluators->acquire();
+		uint64_t evaluated = 0;
 
-		if(task->priority <= 0)
-			task->priority = priorityEvaluator->evaluate(goal);
+		for(size_t i = r.begin(); i != r.end(); i++)
+		{
+			Goals::TTask task = Goals::taskptr(*elementarGoals[i]);
 
-		tasks.push_back(task);
-	}
+			if(task->priority <= 0)
+			{
+				task->priority = evaluator->evaluate(elementarGoals[i]);
+				evaluated++;
+			}
+
+			tasks[i] = task;
+		}
+
+		evaluatedTasks += evaluated;
+	});
+
+	auto evaluationTime = std::chrono::high_resolution_clock::now() - evaluationStart;
+	priorityEvaluationTime += std::chrono::duration_cast<std::chrono::microseconds>(evaluationTime).count();
+	addTurnSection("Priority evaluation", timeElapsed(evaluationStart));
+	addTurnSection(behavior->toString(), timeElapsed(start));
 
 	if(tasks.empty())
 	{
@@ -120,13 +212,19 @@ void Nullkiller::resetAiState()
 	scanDepth = ScanDepth::SMALL;
 	playerID = ai->playerID;
 	lockedHeroes.clear();
-	dangerHitMap->reset();
+	turnSections.clear();
+	turnStart = std::chrono::high_resolution_clock::now();
+	lastPassTime = 0;
+	evaluatedTasks = 0;
+	priorityEvaluationTime = 0;
+	dangerHitMap->markOutdated();
 	useHeroChain = true;
 }
 
 void Nullkiller::updateAiState(int pass, bool fast)
 {
 	boost::this_thread::interruption_point();
+	PROFILE_ZONE("Nullkiller::updateAiState");
 
 	auto start = std::chrono::high_resolution_clock::now();
 
@@ -158,7 +256,11 @@ void Nullkiller::updateAiState(int pass, bool fast)
 		cfg.useHeroChain = useHeroChain;
 		cfg.scoutTurnDistanceLimit = SCOUT_TURN_DISTANCE_LIMIT;
 
-		if(scanDepth != ScanDepth::FULL)
+		if(scanDepth == ScanDepth::MINIMAL)
+		{
+			cfg.mainTurnDistanceLimit = MAIN_TURN_DISTANCE_LIMIT;
+		}
+		else if(scanDepth != ScanDepth::FULL)
 		{
 			cfg.mainTurnDistanceLimit = MAIN_TURN_DISTANCE_LIMIT * ((int)scanDepth + 1);
 		}
@@ -176,9 +278,45 @@ void Nullkiller::updateAiState(int pass, bool fast)
 	buildAnalyzer->update();
 	decomposer->reset();
 
+	addTurnSection("Update AI state", timeElapsed(start));
 	logAi->debug("AI state updated in %ld", timeElapsed(start));
 }
 
+void Nullkiller::applyTimeBudget()
+{
+	bool passIsTooLong = passTimeLimit && lastPassTime > passTimeLimit;
+	bool turnIsTooLong = turnTimeLimit && timeElapsed(turnStart) + lastPassTime > turnTimeLimit;
+
+	if(!passIsTooLong && !turnIsTooLong)
+		return;
+
+	if(useHeroChain)
+	{
+		logAi->debug("Previous pass took %ld ms, disabling hero chains to fit into time budget", lastPassTime);
+		useHeroChain = false;
+	}
+	else if(scanDepth != ScanDepth::MINIMAL)
+	{
+		logAi->debug("Previous pass took %ld ms, reducing scan depth to fit into time budget", lastPassTime);
+		scanDepth = ScanDepth::MINIMAL;
+	}
+}
+
+bool Nullkiller::isTurnTimeExceeded() const
+{
+	return turnTimeLimit && timeElapsed(turnStart) >= turnTimeLimit;
+}
+
+bool Nullkiller::isPassTimeExceeded(const std::chrono::time_point<std::chrono::high_resolution_clock> & passStart) const
+{
+	return passTimeLimit && timeElapsed(passStart) >= passTimeLimit;
+}
+
+bool Nullkiller::isPassBudgetExhausted() const
+{
+	return passTimeLimit && lastPassTime > passTimeLimit && !useHeroChain && scanDepth == ScanDepth::MINIMAL;
+}
+
 bool Nullkiller::isHeroLocked(const CGHeroInstance * hero) const
 {
 	return getHeroLockedReason(hero) != HeroLockedReason::NOT_LOCKED;
@@ -219,7 +357,13 @@ HeroLockedReason Nullkiller::getHeroLockedReason(const CGHeroInstance * hero) co
 
 void Nullkiller::makeTurn()
 {
-	boost::lock_guard<boost::mutex> sharedStorageLock(AISharedStorage::locker);
+	PROFILE_ZONE("Nullkiller::makeTurn");
+
+	boost::unique_lock<boost::mutex> sharedStorageLock(AISharedStorage::locker, boost::defer_lock);
+
+	//AI instances that own their node storage may run in parallel
+	if(pathfinder->hasSharedStorage() || dangerHitMap->hasSharedStorage())
+		sharedStorageLock.lock();
 
 	const int MAX_DEPTH = 10;
 	const float FAST_TASK_MINIMAL_PRIORITY = 0.7;
@@ -228,6 +372,24 @@ void Nullkiller::makeTurn()
 
 	for(int i = 1; i <= MAXPASS; i++)
 	{
+		if(isTurnTimeExceeded())
+		{
+			logAi->debug("Turn time budget of %ld ms is exhausted. Ending turn.", turnTimeLimit);
+
+			return;
+		}
+
+		if(isPassBudgetExhausted())
+		{
+			logAi->debug("Previous pass took %ld ms with minimal scan depth, pass time budget of %ld ms is exhausted. Ending turn.", lastPassTime, passTimeLimit);
+
+			return;
+		}
+
+		PROFILE_ZONE("Nullkiller pass");
+		auto passStart = std::chrono::high_resolution_clock::now();
+
+		applyTimeBudget();
 		updateAiState(i);
 
 		Goals::TTask bestTask = taskptr(Goals::Invalid());
@@ -248,21 +410,33 @@ void Nullkiller::makeTurn()
 			}
 		} while(bestTask->priority >= FAST_TASK_MINIMAL_PRIORITY);
 
-		Goals::TTaskVec bestTasks = {
-			bestTask,
-			choseBestTask(sptr(RecruitHeroBehavior()), 1),
-			choseBestTask(sptr(CaptureObjectsBehavior()), 1),
-			choseBestTask(sptr(ClusterBehavior()), MAX_DEPTH),
-			choseBestTask(sptr(DefenceBehavior()), MAX_DEPTH),
-			choseBestTask(sptr(GatherArmyBehavior()), MAX_DEPTH)
-		};
-
-		if(cb->getDate(Date::DAY) == 1)
+		if(isTurnTimeExceeded() || isPassTimeExceeded(passStart))
 		{
-			bestTasks.push_back(choseBestTask(sptr(StartupBehavior()), 1));
+			// no time left for main behaviors, best fast task is still worth doing
+			logAi->debug("Time budget is exhausted, skipping main behaviors");
 		}
+		else
+		{
+			std::vector<std::pair<Goals::TSubgoal, int>> behaviors = {
+				{sptr(RecruitHeroBehavior()), 1},
+				{sptr(CaptureObjectsBehavior()), 1},
+				{sptr(ClusterBehavior()), MAX_DEPTH},
+				{sptr(DefenceBehavior()), MAX_DEPTH},
+				{sptr(GatherArmyBehavior()), MAX_DEPTH}
+			};
 
-		bestTask = choseBestTask(bestTasks);
+			if(cb->getDate(Date::DAY) == 1)
+			{
+				behaviors.push_back({sptr(StartupBehavior()), 1});
+			}
+
+			Goals::TTaskVec bestTasks = choseBestTasks(behaviors);
+
+			bestTasks.insert(bestTasks.begin(), bestTask);
+			bestTask = choseBestTask(bestTasks);
+		}
+
+		lastPassTime = timeElapsed(passStart);
 
 		HeroPtr hero = bestTask->getHero();
 
@@ -297,8 +471,21 @@ void Nullkiller::makeTurn()
 	}
 }
 
+bool Nullkiller::prepareNextTurn()
+{
+	boost::unique_lock<boost::mutex> sharedStorageLock(AISharedStorage::locker, boost::defer_lock);
+
+	// shared storage is needed by AI that is making turn right now, do not make it wait
+	if(dangerHitMap->hasSharedStorage() && !sharedStorageLock.try_lock())
+		return false;
+
+	PROFILE_ZONE("Nullkiller::prepareNextTurn");
+	return dangerHitMap->updateOutdatedLayer();
+}
+
 void Nullkiller::executeTask(Goals::TTask task)
 {
+	PROFILE_ZONE("Nullkiller::executeTask");
 	auto start = std::chrono::high_resolution_clock::now();
 	std::string taskDescr = task->toString();
 
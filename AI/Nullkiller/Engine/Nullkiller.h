@@ -41,7 +41,9 @@ enum class ScanDepth
 {
 	FULL = 0,
 
-	SMALL = 1
+	SMALL = 1,
+
+	MINIMAL = 2 // used when turn does not fit into time budget
 };
 
 class Nullkiller
@@ -54,12 +56,23 @@ private:
 	ScanDepth scanDepth;
 	TResources lockedResources;
 	bool useHeroChain;
+	/// wall-clock limits of whole turn and of planning of single pass in ms, 0 if unlimited
+	uint64_t turnTimeLimit;
+	uint64_t passTimeLimit;
+	std::chrono::time_point<std::chrono::high_resolution_clock> turnStart;
+	uint64_t lastPassTime;
+	/// time spent in each behavior and in state updates during current turn, in ms
+	mutable std::map<std::string, uint64_t> turnSections;
+	mutable boost::mutex turnSectionsSync;
+	/// number of tasks evaluated by priority evaluators during current turn
+	mutable std::atomic<uint64_t> evaluatedTasks{0};
+	/// wall-clock time of priority evaluation of all behaviors during current turn, in microseconds
+	mutable std::atomic<uint64_t> priorityEvaluationTime{0};
 
 public:
 	std::unique_ptr<DangerHitMapAnalyzer> dangerHitMap;
 	std::unique_ptr<BuildAnalyzer> buildAnalyzer;
 	std::unique_ptr<ObjectClusterizer> objectClusterizer;
-	std::unique_ptr<PriorityEvaluator> priorityEvaluator;
 	std::unique_ptr<SharedPool<PriorityEvaluator>> priorityEvaluators;
 	std::unique_ptr<AIPathfinder> pathfinder;
 	std::unique_ptr<HeroManager> heroManager;
@@ -73,6 +86,9 @@ public:
 	Nullkiller();
 	void init(std::shared_ptr<CCallback> cb, PlayerColor playerID);
 	void makeTurn();
+	/// does small part of work needed for next turn while other players make their turns
+	/// returns false if there is nothing to do right now. Game state must be locked by caller
+	bool prepareNextTurn();
 	bool isActive(const CGHeroInstance * hero) const { return activeHero == hero; }
 	bool isHeroLocked(const CGHeroInstance * hero) const;
 	HeroPtr getActiveHero() { return activeHero; }
@@ -88,12 +104,29 @@ public:
 	int32_t getFreeGold() const { return getFreeResources()[EGameResID::GOLD]; }
 	void lockResources(const TResources & res);
 	const TResources & getLockedResources() const { return lockedResources; }
+	const std::map<std::string, uint64_t> & getTurnSections() const { return turnSections; }
+	uint64_t getEvaluatedTasks() const { return evaluatedTasks; }
+	uint64_t getPriorityEvaluationTime() const { return priorityEvaluationTime; }
+	/// number of nodes expanded by pathfinders of this AI, including danger map pathfinder
+	uint64_t getPathfinderNodes() const;
 
 private:
 	void resetAiState();
 	void updateAiState(int pass, bool fast = false);
+	/// disables hero chains and then reduces scan depth if previous pass does not fit into time budget
+	void applyTimeBudget();
+	bool isTurnTimeExceeded() const;
+	/// true if pass that started at given time has used up its budget
+	bool isPassTimeExceeded(const std::chrono::time_point<std::chrono::high_resolution_clock> & passStart) const;
+	/// true if previous pass did not fit into its budget although scan depth and hero chains are already reduced
+	bool isPassBudgetExhausted() const;
 	Goals::TTask choseBestTask(Goals::TSubgoal behavior, int decompositionMaxDepth) const;
+	Goals::TTask choseBestTask(Goals::TSubgoal behavior, int decompositionMaxDepth, DeepDecomposer & behaviorDecomposer) const;
 	Goals::TTask choseBestTask(Goals::TTaskVec & tasks) const;
+	/// decomposes behaviors concurrently, each with its own decomposer
+	/// result contains best task of each behavior in the same order as behaviors are passed
+	Goals::TTaskVec choseBestTasks(const std::vector<std::pair<Goals::TSubgoal, int>> & behaviors) const;
+	void addTurnSection(const std::string & name, uint64_t time) const;
 	void executeTask(Goals::TTask task);
 };
 
@@ -18,14 +18,17 @@
 #include "../../../lib/mapObjects/MapObjects.h"
 #include "../../../lib/PathfinderUtil.h"
 #include "../../../lib/CPlayerState.h"
+#include "../../../lib/CConfigHandler.h"
+#include "../../../lib/AIBenchmark.h"
+#include "../../../lib/Profiler.h"
 
 namespace NKAI
 {
 
-std::shared_ptr<boost::multi_array<AIPathNode, 5>> AISharedStorage::shared;
+std::shared_ptr<AIChainStorage> AISharedStorage::shared;
 boost::mutex AISharedStorage::locker;
-std::set<int3> commitedTiles;
-std::set<int3> commitedTilesInitial;
+boost::mutex AISharedStorage::poolMutex;
+size_t AISharedStorage::poolBytes = 0;
 
 
 const uint64_t FirstActorMask = 1;
@@ -33,19 +36,149 @@ const uint64_t MIN_ARMY_STRENGTH_FOR_CHAIN = 5000;
 const uint64_t MIN_ARMY_STRENGTH_FOR_NEXT_ACTOR = 1000;
 const uint64_t CHAIN_MAX_DEPTH = 4;
 
+AIChainStorage::AIChainStorage(const int3 & sizes)
+	: sizes(sizes), usedBlocks(0)
+{
+	size_t tileLayers = static_cast<size_t>(EPathfindingLayer::NUM_LAYERS) * sizes.z * sizes.x * sizes.y;
+
+	tileChains.resize(tileLayers, NO_CHAINS);
+	accessibility.resize(tileLayers, CGPathNode::EAccessibility::NOT_SET);
+	chunks.resize((tileLayers + BLOCKS_PER_CHUNK - 1) / BLOCKS_PER_CHUNK);
+}
+
+size_t AIChainStorage::estimateMemoryUsage(const int3 & sizes)
+{
+	size_t tiles = static_cast<size_t>(sizes.z) * sizes.x * sizes.y;
+	size_t indexBytes = (sizeof(uint32_t) + sizeof(CGPathNode::EAccessibility)) * EPathfindingLayer::NUM_LAYERS * tiles;
+
+	return indexBytes + sizeof(AIPathNode) * AIPathfinding::NUM_CHAINS * tiles;
+}
+
+void AIChainStorage::reset()
+{
+	std::fill(tileChains.begin(), tileChains.end(), NO_CHAINS);
+	std::fill(accessibility.begin(), accessibility.end(), CGPathNode::EAccessibility::NOT_SET);
+	usedBlocks = 0;
+}
+
+TChainNodes AIChainStorage::getOrAllocate(const int3 & tile, EPathfindingLayer layer)
+{
+	size_t tileIndex = getTileIndex(tile, layer);
+	uint32_t index = tileChains[tileIndex];
+
+	if(index != NO_CHAINS)
+	{
+		AIPathNode * first = getBlock(index);
+
+		return TChainNodes(first, first + AIPathfinding::NUM_CHAINS);
+	}
+
+	auto tileAccessibility = accessibility[tileIndex];
+
+	if(tileAccessibility == CGPathNode::EAccessibility::NOT_SET
+		|| tileAccessibility == CGPathNode::EAccessibility::BLOCKED)
+	{
+		return TChainNodes();
+	}
+
+	AIPathNode * first = allocateBlock(tile, layer, tileAccessibility);
+
+	return TChainNodes(first, first + AIPathfinding::NUM_CHAINS);
+}
+
+AIPathNode * AIChainStorage::allocateBlock(const int3 & tile, EPathfindingLayer layer, CGPathNode::EAccessibility tileAccessibility)
+{
+	uint32_t index;
+
+	{
+		boost::lock_guard<boost::mutex> allocationLock(allocationMutex);
+
+		index = usedBlocks++;
+
+		auto & chunk = chunks[index / BLOCKS_PER_CHUNK];
+
+		if(!chunk)
+			chunk.reset(new AIPathNode[BLOCKS_PER_CHUNK * AIPathfinding::NUM_CHAINS]);
+	}
+
+	AIPathNode * first = getBlock(index);
+
+	for(AIPathNode * node = first; node != first + AIPathfinding::NUM_CHAINS; node++)
+	{
+		// block may have been used by another tile during previous pathfinding
+		node->coord = tile;
+		node->layer = layer;
+		node->reset();
+		node->accessible = tileAccessibility;
+		node->actor = nullptr;
+		node->danger = 0;
+		node->manaCost = 0;
+		node->specialAction.reset();
+		node->armyLoss = 0;
+		node->chainOther = nullptr;
+	}
+
+	tileChains[getTileIndex(tile, layer)] = index;
+
+	return first;
+}
+
+size_t AISharedStorage::getMemoryLimit()
+{
+	si64 limit = settings["server"]["aiPathfinderMemoryLimit"].Integer();
+
+	if(limit < 0)
+	{
+#ifdef VCMI_MOBILE
+		limit = 0;
+#else
+		limit = 1024;
+#endif
+	}
+
+	return static_cast<size_t>(limit) * 1024 * 1024;
+}
+
 AISharedStorage::AISharedStorage(int3 sizes)
+	: leasedBytes(0)
 {
-	if(!shared){
-		shared.reset(new boost::multi_array<AIPathNode, 5>(
-			boost::extents[EPathfindingLayer::NUM_LAYERS][sizes.z][sizes.x][sizes.y][AIPathfinding::NUM_CHAINS]));
+	// nodes are allocated on demand so this is only an estimation of what single storage will use
+	size_t bytes = AIChainStorage::estimateMemoryUsage(sizes);
+
+	boost::lock_guard<boost::mutex> poolLock(poolMutex);
+
+	if(poolBytes + bytes <= getMemoryLimit())
+	{
+		try
+		{
+			nodes.reset(new AIChainStorage(sizes));
+			leasedBytes = bytes;
+			poolBytes += bytes;
+		}
+		catch(const std::bad_alloc &)
+		{
+			logAi->warn("Failed to allocate %d MB for pathfinder nodes, using shared storage", bytes / 1024 / 1024);
+		}
+	}
+
+	if(!nodes)
+	{
+		if(!shared)
+			shared.reset(new AIChainStorage(sizes));
+
+		nodes = shared;
 	}
 
-	nodes = shared;
+	logAi->debug("Pathfinder node storage: %s, %d MB leased in total", isShared() ? "shared" : "own", poolBytes / 1024 / 1024);
 }
 
 AISharedStorage::~AISharedStorage()
 {
+	boost::lock_guard<boost::mutex> poolLock(poolMutex);
+
 	nodes.reset();
+	poolBytes -= leasedBytes;
+
 	if(shared && shared.use_count() == 1)
 	{
 		shared.reset();
@@ -62,6 +195,8 @@ AINodeStorage::~AINodeStorage() = default;
 
 void AINodeStorage::initialize(const PathfinderOptions & options, const CGameState * gs)
 {
+	PROFILE_ZONE("AINodeStorage::initialize");
+
 	if(heroChainPass)
 		return;
 
@@ -70,6 +205,8 @@ void AINodeStorage::initialize(const PathfinderOptions & options, const CGameSta
 	const auto fow = static_cast<const CGameInfoCallback *>(gs)->getPlayerTeam(fowPlayer)->fogOfWarMap;
 	const int3 sizes = gs->getMapSize();
 
+	nodes.reset();
+
 	//Each thread gets different x, but an array of y located next to each other in memory
 
 	parallel_for(blocked_range<size_t>(0, sizes.x), [&](const blocked_range<size_t>& r)
@@ -127,9 +264,9 @@ std::optional<AIPathNode *> AINodeStorage::getOrCreateNode(
 {
 	int bucketIndex = ((uintptr_t)actor) % AIPathfinding::BUCKET_COUNT;
 	int bucketOffset = bucketIndex * AIPathfinding::BUCKET_SIZE;
-	auto chains = nodes.get(pos, layer);
+	auto chains = nodes.getOrAllocate(pos, layer);
 
-	if(chains[0].blocked())
+	if(chains.empty())
 	{
 		return std::nullopt;
 	}
@@ -203,16 +340,7 @@ std::vector<CGPathNode *> AINodeStorage::getInitialNodes()
 
 void AINodeStorage::resetTile(const int3 & coord, EPathfindingLayer layer, CGPathNode::EAccessibility accessibility)
 {
-	for(AIPathNode & heroNode : nodes.get(coord, layer))
-{
-		heroNode.actor = nullptr;
-		heroNode.danger = 0;
-		heroNode.manaCost = 0;
-		heroNode.specialAction.reset();
-		heroNode.armyLoss = 0;
-		heroNode.chainOther = nullptr;
-		heroNode.update(coord, layer, accessibility);
-	}
+	nodes.setAccessibility(coord, layer, accessibility);
 }
 
 void AINodeStorage::commit(CDestinationNodeInfo & destination, const PathNodeInfo & source)
@@ -313,17 +441,12 @@ bool AINodeStorage::increaseHeroChainTurnLimit()
 	{
 		foreach_tile_pos([&](const int3 & pos)
 		{
-			auto chains = nodes.get(pos, layer);
-
-			if(!chains[0].blocked())
+			for(AIPathNode & node : nodes.get(pos, layer))
 			{
-				for(AIPathNode & node : chains)
+				if(node.turns <= heroChainTurn && node.action != CGPathNode::ENodeAction::UNKNOWN)
 				{
-					if(node.turns <= heroChainTurn && node.action != CGPathNode::ENodeAction::UNKNOWN)
-					{
-						commitedTiles.insert(pos);
-						break;
-					}
+					commitedTiles.insert(pos);
+					break;
 				}
 			}
 		});
@@ -334,6 +457,8 @@ bool AINodeStorage::increaseHeroChainTurnLimit()
 
 bool AINodeStorage::calculateHeroChainFinal()
 {
+	PROFILE_ZONE("AINodeStorage::calculateHeroChainFinal");
+
 	heroChainPass = EHeroChainPass::FINAL;
 	heroChain.resize(0);
 
@@ -343,18 +468,15 @@ bool AINodeStorage::calculateHeroChainFinal()
 		{
 			auto chains = nodes.get(pos, layer);
 
-			if(!chains[0].blocked())
+			for(AIPathNode & node : chains)
 			{
-				for(AIPathNode & node : chains)
+				if(node.turns > heroChainTurn
+					&& !node.locked
+					&& node.action != CGPathNode::ENodeAction::UNKNOWN
+					&& node.actor->actorExchangeCount > 1
+					&& !hasBetterChain(&node, &node, chains))
 				{
-					if(node.turns > heroChainTurn
-						&& !node.locked
-						&& node.action != CGPathNode::ENodeAction::UNKNOWN
-						&& node.actor->actorExchangeCount > 1
-						&& !hasBetterChain(&node, &node, chains))
-					{
-						heroChain.push_back(&node);
-					}
+					heroChain.push_back(&node);
 				}
 			}
 		});
@@ -377,6 +499,14 @@ struct DelayedWork
 	}
 };
 
+/// benchmark runs use fixed seed so AI turns can be reproduced
+static uint32_t getRandomSeed()
+{
+	auto fixedSeed = AIBenchmark::get().getRandomSeed();
+
+	return fixedSeed ? *fixedSeed : std::random_device()();
+}
+
 class HeroChainCalculationTask
 {
 private:
@@ -389,11 +519,12 @@ private:
 	std::vector<CGPathNode *> heroChain;
 	const std::vector<int3> & tiles;
 	std::vector<DelayedWork> delayedWork;
+	uint32_t seed;
 
 public:
 	HeroChainCalculationTask(
-		AINodeStorage & storage, AISharedStorage & nodes, const std::vector<int3> & tiles, uint64_t chainMask, int heroChainTurn)
-		:existingChains(), newChains(), delayedWork(), nodes(nodes), storage(storage), chainMask(chainMask), heroChainTurn(heroChainTurn), heroChain(), tiles(tiles)
+		AINodeStorage & storage, AISharedStorage & nodes, const std::vector<int3> & tiles, uint64_t chainMask, int heroChainTurn, uint32_t seed)
+		:existingChains(), newChains(), delayedWork(), nodes(nodes), storage(storage), chainMask(chainMask), heroChainTurn(heroChainTurn), heroChain(), tiles(tiles), seed(seed)
 	{
 		existingChains.reserve(AIPathfinding::NUM_CHAINS);
 		newChains.reserve(AIPathfinding::NUM_CHAINS);
@@ -401,8 +532,10 @@ public:
 
 	void execute(const blocked_range<size_t>& r)
 	{
-		std::random_device randomDevice;
-		std::mt19937 randomEngine(randomDevice());
+		PROFILE_ZONE("HeroChainCalculationTask::execute");
+
+		// engine is seeded once per task, offset by range start so parallel tasks do not shuffle alike
+		std::mt19937 randomEngine(seed + static_cast<uint32_t>(r.begin()));
 
 		for(int i = r.begin(); i != r.end(); i++)
 		{
@@ -413,7 +546,7 @@ public:
 				auto chains = nodes.get(pos, layer);
 
 				// fast cut inactive nodes
-				if(chains[0].blocked())
+				if(chains.empty())
 					continue;
 
 				existingChains.clear();
@@ -483,8 +616,10 @@ public:
 
 bool AINodeStorage::calculateHeroChain()
 {
-	std::random_device randomDevice;
-	std::mt19937 randomEngine(randomDevice());
+	PROFILE_ZONE("AINodeStorage::calculateHeroChain");
+
+	uint32_t seed = getRandomSeed();
+	std::mt19937 randomEngine(seed);
 
 	heroChainPass = EHeroChainPass::CHAIN;
 	heroChain.clear();
@@ -500,7 +635,7 @@ bool AINodeStorage::calculateHeroChain()
 		parallel_for(blocked_range<size_t>(0, data.size()), [&](const blocked_range<size_t>& r)
 		{
 			//auto r = blocked_range<size_t>(0, data.size());
-			HeroChainCalculationTask task(*this, nodes, data, chainMask, heroChainTurn);
+			HeroChainCalculationTask task(*this, nodes, data, chainMask, heroChainTurn, seed);
 
 			task.execute(r);
 
@@ -514,7 +649,7 @@ bool AINodeStorage::calculateHeroChain()
 	else
 	{
 		auto r = blocked_range<size_t>(0, data.size());
-		HeroChainCalculationTask task(*this, nodes, data, chainMask, heroChainTurn);
+		HeroChainCalculationTask task(*this, nodes, data, chainMask, heroChainTurn, seed);
 
 		task.execute(r);
 		task.flushResult(heroChain);
@@ -40,11 +40,14 @@ namespace AIPathfinding
 	const int CHAIN_MAX_DEPTH = 4;
 }
 
+/// Node is not split into separate arrays of hot and cold fields: generic pathfinder works with node pointers
+/// and keeps cost, predecessor and queue handle inside CGPathNode. Memory is saved by allocating chains on demand instead
 struct AIPathNode : public CGPathNode
 {
+	// placed first so it fits into tail padding of CGPathNode
+	uint32_t manaCost;
 	uint64_t danger;
 	uint64_t armyLoss;
-	uint32_t manaCost;
 	const AIPathNode * chainOther;
 	std::shared_ptr<const SpecialAction> specialAction;
 	const ChainActor * actor;
@@ -57,6 +60,10 @@ struct AIPathNode : public CGPathNode
 	}
 };
 
+#ifdef ENVIRONMENT64
+static_assert(sizeof(AIPathNode) <= 112, "every reached tile layer allocates NUM_CHAINS nodes, keep cold fields of AIPathNode small");
+#endif
+
 struct AIPathNodeInfo
 {
 	float cost;
@@ -127,23 +134,118 @@ enum EHeroChainPass
 	FINAL // same as SINGLE but for heroes from CHAIN pass
 };
 
+typedef boost::iterator_range<AIPathNode *> TChainNodes;
+
+/// Chain nodes of all tiles of the map. Nodes of tile layer are allocated only when some actor reaches it
+/// so unreachable tiles and layers that are not used on the tile (e.g. land layer of water tiles) take no memory
+class AIChainStorage : boost::noncopyable
+{
+	static const uint32_t NO_CHAINS = std::numeric_limits<uint32_t>::max();
+	static const size_t BLOCKS_PER_CHUNK = 1024;
+
+	int3 sizes;
+	/// index of chain block of each tile layer or NO_CHAINS
+	std::vector<uint32_t> tileChains;
+	std::vector<CGPathNode::EAccessibility> accessibility;
+	/// blocks of NUM_CHAINS nodes, allocated in chunks and reused after reset so node pointers stay valid for whole pathfinding
+	std::vector<std::unique_ptr<AIPathNode[]>> chunks;
+	uint32_t usedBlocks;
+	boost::mutex allocationMutex;
+
+	STRONG_INLINE
+	size_t getTileIndex(const int3 & tile, EPathfindingLayer layer) const
+	{
+		return ((static_cast<size_t>(layer) * sizes.z + tile.z) * sizes.x + tile.x) * sizes.y + tile.y;
+	}
+
+	STRONG_INLINE
+	AIPathNode * getBlock(uint32_t index) const
+	{
+		return &chunks[index / BLOCKS_PER_CHUNK][(index % BLOCKS_PER_CHUNK) * AIPathfinding::NUM_CHAINS];
+	}
+
+	AIPathNode * allocateBlock(const int3 & tile, EPathfindingLayer layer, CGPathNode::EAccessibility tileAccessibility);
+
+public:
+	AIChainStorage(const int3 & sizes);
+
+	/// memory needed if every tile gets nodes in one layer
+	static size_t estimateMemoryUsage(const int3 & sizes);
+
+	/// forgets all nodes, must be called before setting accessibility of tiles for new pathfinding
+	void reset();
+
+	STRONG_INLINE
+	void setAccessibility(const int3 & tile, EPathfindingLayer layer, CGPathNode::EAccessibility tileAccessibility)
+	{
+		accessibility[getTileIndex(tile, layer)] = tileAccessibility;
+	}
+
+	/// returns empty range if no actor reached tile layer yet
+	STRONG_INLINE
+	TChainNodes get(const int3 & tile, EPathfindingLayer layer) const
+	{
+		uint32_t index = tileChains[getTileIndex(tile, layer)];
+
+		if(index == NO_CHAINS)
+			return TChainNodes();
+
+		AIPathNode * first = getBlock(index);
+
+		return TChainNodes(first, first + AIPathfinding::NUM_CHAINS);
+	}
+
+	/// returns empty range if tile layer is blocked. Different threads may allocate nodes only for different tiles
+	TChainNodes getOrAllocate(const int3 & tile, EPathfindingLayer layer);
+};
+
+/// Node storage of one AI instance. While total size of node storages stays within memory limit
+/// each AI instance gets its own storage, otherwise it falls back to single storage shared by all AI instances
 class AISharedStorage
 {
-	// 1 - layer (air, water, land)
-	// 2-4 - position on map[z][x][y]
-	// 5 - chain (normal, battle, spellcast and combinations)
-	static std::shared_ptr<boost::multi_array<AIPathNode, 5>> shared;
-	std::shared_ptr<boost::multi_array<AIPathNode, 5>> nodes;
+	static std::shared_ptr<AIChainStorage> shared;
+	std::shared_ptr<AIChainStorage> nodes;
+
+	/// size of own storage accounted in pool, 0 if shared storage is used
+	size_t leasedBytes;
+
+	static boost::mutex poolMutex;
+	static size_t poolBytes;
+
+	static size_t getMemoryLimit();
 public:
+	/// must be held while shared storage is in use
 	static boost::mutex locker;
 
 	AISharedStorage(int3 mapSize);
 	~AISharedStorage();
 
+	bool isShared() const
+	{
+		return leasedBytes == 0;
+	}
+
+	void reset()
+	{
+		nodes->reset();
+	}
+
 	STRONG_INLINE
-	boost::detail::multi_array::sub_array<AIPathNode, 1> get(int3 tile, EPathfindingLayer layer) const
+	void setAccessibility(const int3 & tile, EPathfindingLayer layer, CGPathNode::EAccessibility tileAccessibility)
 	{
-		return (*nodes)[layer][tile.z][tile.x][tile.y];
+		nodes->setAccessibility(tile, layer, tileAccessibility);
+	}
+
+	STRONG_INLINE
+	TChainNodes get(const int3 & tile, EPathfindingLayer layer) const
+	{
+		return nodes->get(tile, layer);
+	}
+
+	STRONG_INLINE
+	TChainNodes getOrAllocate(const int3 & tile, EPathfindingLayer layer)
+	{
+		return nodes->getOrAllocate(tile, layer);
 	}
 };
 
@@ -164,6 +266,8 @@ private:
 	int heroChainMaxTurns;
 	PlayerColor playerID;
 	uint8_t turnDistanceLimit[2];
+	mutable std::set<int3> commitedTiles;
+	std::set<int3> commitedTilesInitial;
 
 public:
 	/// more than 1 chain layer for each hero allows us to have more than 1 path to each tile so we can chose more optimal one.	
@@ -172,6 +276,11 @@ public:
 
 	void initialize(const PathfinderOptions & options, const CGameState * gs) override;
 
+	bool hasSharedStorage() const
+	{
+		return nodes.isShared();
+	}
+
 	bool increaseHeroChainTurnLimit();
 	bool selectFirstActor();
 	bool selectNextActor();
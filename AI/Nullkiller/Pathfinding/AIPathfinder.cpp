@@ -12,13 +12,15 @@
 #include "AIPathfinderConfig.h"
 #include "../../../CCallback.h"
 #include "../../../lib/mapping/CMap.h"
+#include "../../../lib/Profiler.h"
+#include "../../../lib/ScopeGuard.h"
 #include "../Engine/Nullkiller.h"
 
 namespace NKAI
 {
 
 AIPathfinder::AIPathfinder(CPlayerSpecificInfoCallback * cb, Nullkiller * ai)
-	:cb(cb), ai(ai)
+	:cb(cb), ai(ai), expandedNodes(0)
 {
 }
 
@@ -45,12 +47,32 @@ std::vector<AIPath> AIPathfinder::getPathInfo(const int3 & tile) const
 	return storage->getChainInfo(tile, !tileInfo->isWater());
 }
 
-void AIPathfinder::updatePaths(std::map<const CGHeroInstance *, HeroRole> heroes, PathfinderSettings pathfinderSettings)
+void AIPathfinder::initStorage()
 {
 	if(!storage)
 	{
 		storage.reset(new AINodeStorage(ai, cb->getMapSize()));
 	}
+}
+
+bool AIPathfinder::hasSharedStorage()
+{
+	initStorage();
+
+	return storage->hasSharedStorage();
+}
+
+void AIPathfinder::updatePaths(std::map<const CGHeroInstance *, HeroRole> heroes, PathfinderSettings pathfinderSettings)
+{
+	PROFILE_ZONE("AIPathfinder::updatePaths");
+
+	initStorage();
+
+	auto nodesAtStart = storage->getExpandedNodes();
+	auto countNodes = vstd::makeScopeGuard([&]()
+	{
+		expandedNodes += storage->getExpandedNodes() - nodesAtStart;
+	});
 
 	auto start = std::chrono::high_resolution_clock::now();
 	logAi->debug("Recalculate all paths");
@@ -37,6 +37,8 @@ private:
 	std::shared_ptr<AINodeStorage> storage;
 	CPlayerSpecificInfoCallback * cb;
 	Nullkiller * ai;
+	/// nodes expanded by this pathfinder, kept here because storage is recreated by init()
+	uint64_t expandedNodes;
 
 public:
 	AIPathfinder(CPlayerSpecificInfoCallback * cb, Nullkiller * ai);
@@ -44,6 +46,15 @@ public:
 	bool isTileAccessible(const HeroPtr & hero, const int3 & tile) const;
 	void updatePaths(std::map<const CGHeroInstance *, HeroRole> heroes, PathfinderSettings pathfinderSettings);
 	void init();
+
+	/// creates node storage if needed. Shared storage can be used only while holding AISharedStorage::locker
+	bool hasSharedStorage();
+
+	/// number of nodes taken from pathfinder queue by all updates of this pathfinder
+	uint64_t getExpandedNodes() const { return expandedNodes; }
+
+private:
+	void initStorage();
 };
 
 }
@@ -150,6 +150,11 @@ void AIhelper::updatePaths(std::vector<HeroPtr> heroes)
 	pathfindingManager->updatePaths(heroes);
 }
 
+uint64_t AIhelper::getPathfinderNodes() const
+{
+	return pathfindingManager->getPathfinderNodes();
+}
+
 bool AIhelper::canGetArmy(const CArmedInstance * army, const CArmedInstance * source) const
 {
 	return armyManager->canGetArmy(army, source);
@@ -62,6 +62,7 @@ public:
 	Goals::TGoalVec howToVisitObj(ObjectIdRef obj) const override;
 	std::vector<AIPath> getPathsToTile(const HeroPtr & hero, const int3 & tile) const override;
 	void updatePaths(std::vector<HeroPtr> heroes) override;
+	uint64_t getPathfinderNodes() const override;
 
 	STRONG_INLINE
 	bool isTileAccessible(const HeroPtr & hero, const int3 & tile) const
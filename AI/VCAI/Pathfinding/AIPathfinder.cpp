@@ -17,7 +17,7 @@ std::vector<std::shared_ptr<AINodeStorage>> AIPathfinder::storagePool;
 std::map<HeroPtr, std::shared_ptr<AINodeStorage>> AIPathfinder::storageMap;
 
 AIPathfinder::AIPathfinder(CPlayerSpecificInfoCallback * cb, VCAI * ai)
-	:cb(cb), ai(ai)
+	:cb(cb), ai(ai), expandedNodes(0)
 {
 }
 
@@ -61,6 +61,7 @@ void AIPathfinder::updatePaths(std::vector<HeroPtr> heroes)
 	};
 
 	std::vector<CThreadHelper::Task> calculationTasks;
+	std::vector<std::pair<std::shared_ptr<AINodeStorage>, uint64_t>> nodesAtStart;
 
 	for(HeroPtr hero : heroes)
 	{
@@ -78,6 +79,7 @@ void AIPathfinder::updatePaths(std::vector<HeroPtr> heroes)
 
 		storageMap[hero] = nodeStorage;
 		nodeStorage->setHero(hero, ai);
+		nodesAtStart.emplace_back(nodeStorage, nodeStorage->getExpandedNodes());
 
 		auto config = std::make_shared<AIPathfinding::AIPathfinderConfig>(cb, ai, nodeStorage);
 
@@ -101,6 +103,9 @@ void AIPathfinder::updatePaths(std::vector<HeroPtr> heroes)
 
 		helper.run();
 	}
+
+	for(auto & storageNodes : nodesAtStart)
+		expandedNodes += storageNodes.first->getExpandedNodes() - storageNodes.second;
 }
 
 std::shared_ptr<const AINodeStorage> AIPathfinder::getStorage(const HeroPtr & hero) const
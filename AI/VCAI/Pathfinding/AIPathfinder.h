@@ -21,6 +21,8 @@ private:
 	static std::map<HeroPtr, std::shared_ptr<AINodeStorage>> storageMap;
 	CPlayerSpecificInfoCallback * cb;
 	VCAI * ai;
+	/// nodes expanded by this pathfinder. Storages are shared by all AI players, so they can not be asked directly
+	uint64_t expandedNodes;
 
 	std::shared_ptr<const AINodeStorage> getStorage(const HeroPtr & hero) const;
 public:
@@ -29,4 +31,5 @@ public:
 	bool isTileAccessible(const HeroPtr & hero, const int3 & tile) const;
 	void updatePaths(std::vector<HeroPtr> heroes);
 	void init();
+	uint64_t getExpandedNodes() const { return expandedNodes; }
 };
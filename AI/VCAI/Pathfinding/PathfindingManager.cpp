@@ -240,3 +240,8 @@ void PathfindingManager::updatePaths(std::vector<HeroPtr> heroes)
 	logAi->debug("AIPathfinder has been reseted.");
 	pathfinder->updatePaths(heroes);
 }
+
+uint64_t PathfindingManager::getPathfinderNodes() const
+{
+	return pathfinder->getExpandedNodes();
+}
@@ -26,6 +26,8 @@ public:
 	virtual Goals::TGoalVec howToVisitTile(const int3 & tile) const = 0;
 	virtual Goals::TGoalVec howToVisitObj(ObjectIdRef obj) const = 0;
 	virtual std::vector<AIPath> getPathsToTile(const HeroPtr & hero, const int3 & tile) const = 0;
+	/// number of nodes expanded by pathfinder of this AI
+	virtual uint64_t getPathfinderNodes() const = 0;
 };
 
 class DLL_EXPORT PathfindingManager : public IPathfindingManager
@@ -47,6 +49,7 @@ public:
 	Goals::TGoalVec howToVisitObj(ObjectIdRef obj) const override;
 	std::vector<AIPath> getPathsToTile(const HeroPtr & hero, const int3 & tile) const override;
 	void updatePaths(std::vector<HeroPtr> heroes) override;
+	uint64_t getPathfinderNodes() const override;
 
 	STRONG_INLINE
 	bool isTileAccessible(const HeroPtr & hero, const int3 & tile) const
@@ -20,6 +20,8 @@
 #include "../../lib/CHeroHandler.h"
 #include "../../lib/GameSettings.h"
 #include "../../lib/CGameState.h"
+#include "../../lib/CPathfinder.h"
+#include "../../lib/AIBenchmark.h"
 #include "../../lib/NetPacksBase.h"
 #include "../../lib/NetPacks.h"
 #include "../../lib/serializer/CTypeList.h"
@@ -70,6 +72,7 @@ VCAI::VCAI()
 	makingTurn = nullptr;
 	destinationTeleport = ObjectInstanceID();
 	destinationTeleportPos = int3(-1);
+	turnTimeLimit = 0;
 
 	ah = new AIhelper();
 	ah->setAI(this);
@@ -594,6 +597,8 @@ void VCAI::initGameInterface(std::shared_ptr<Environment> ENV, std::shared_ptr<C
 	myCb->waitTillRealize = true;
 	myCb->unlockGsWhenWaiting = true;
 
+	turnTimeLimit = settings["server"]["aiTimeBudget"]["VCAI"]["turn"].Integer();
+
 	if(!fh)
 		fh = new FuzzyHelper();
 
@@ -772,6 +777,9 @@ void VCAI::makeTurn()
 	boost::shared_lock<boost::shared_mutex> gsLock(CGameState::mutex);
 	setThreadName("VCAI::makeTurn");
 
+	turnStart = boost::posix_time::microsec_clock::universal_time();
+	auto pathfinderNodesAtStart = ah->getPathfinderNodes();
+
 	switch(cb->getDate(Date::DAY_OF_WEEK))
 	{
 	case 1:
@@ -803,7 +811,10 @@ void VCAI::makeTurn()
 
 		/*Below function is also responsible for hero movement via internal wander function. By design it is separate logic for heroes that have nothing to do.
 		Heroes that were not picked by striveToGoal(sptr(Goals::Win())); recently (so they do not have new goals and cannot continue/reevaluate previously locked goals) will do logic in wander().*/
-		performTypicalActions();
+		if(isTurnTimeExceeded())
+			logAi->debug("Turn time budget of %d ms is exhausted, heroes will not wander", turnTimeLimit);
+		else
+			performTypicalActions();
 
 		//for debug purpose
 		for (auto h : cb->getHeroesInfo())
@@ -823,9 +834,28 @@ void VCAI::makeTurn()
 		logAi->debug("Making turn thread has caught an exception: %s", e.what());
 	}
 
+	if(AIBenchmark::get().isActive())
+	{
+		AITurnReport report;
+
+		report.player = playerID;
+		report.ai = dllName;
+		report.day = day;
+		report.turnTime = (boost::posix_time::microsec_clock::universal_time() - turnStart).total_milliseconds();
+		report.pathfinderNodes = ah->getPathfinderNodes() - pathfinderNodesAtStart;
+
+		AIBenchmark::get().addTurn(report);
+	}
+
 	endTurn();
 }
 
+bool VCAI::isTurnTimeExceeded() const
+{
+	return turnTimeLimit > 0
+		&& (boost::posix_time::microsec_clock::universal_time() - turnStart).total_milliseconds() >= turnTimeLimit;
+}
+
 std::vector<HeroPtr> VCAI::getMyHeroes() const
 {
 	std::vector<HeroPtr> ret;
@@ -865,6 +895,12 @@ void VCAI::mainLoop()
 
 	for (int pass = 0; pass< 30 && basicGoals.size(); pass++)
 	{
+		if(isTurnTimeExceeded())
+		{
+			logAi->debug("Turn time budget of %d ms is exhausted, stopping main loop", turnTimeLimit);
+			break;
+		}
+
 		vstd::removeDuplicates(basicGoals); //TODO: container which does this automagically without has would be nice
 		goalsToAdd.clear();
 		goalsToRemove.clear();
@@ -118,6 +118,9 @@ public:
 	std::unique_ptr<boost::thread> makingTurn;
 private:
 	boost::mutex turnInterruptionMutex;
+	/// wall-clock limit of whole turn in ms, 0 if unlimited
+	si64 turnTimeLimit;
+	boost::posix_time::ptime turnStart;
 public:
 	ObjectInstanceID selectedObject;
 
@@ -206,6 +209,7 @@ public:
 	void makeTurn();
 	void mainLoop();
 	void performTypicalActions();
+	bool isTurnTimeExceeded() const;
 
 	void buildArmyIn(const CGTownInstance * t);
 	void striveToGoal(Goals::TSubgoal ultimateGoal);
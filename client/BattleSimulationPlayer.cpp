@@ -0,0 +1,168 @@
+/*
+ * BattleSimulationPlayer.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "BattleSimulationPlayer.h"
+
+#include <vcmi/Environment.h>
+#include <vcmi/events/EventBus.h>
+
+#include "../CCallback.h"
+#include "../lib/AIBenchmark.h"
+#include "../lib/CConfigHandler.h"
+#include "../lib/CGameInterface.h"
+#include "../lib/CStack.h"
+#include "../lib/JsonNode.h"
+#include "../lib/VCMI_Lib.h"
+#include "../lib/battle/BattleInfo.h"
+
+/// Battle callback without client, all information comes directly from simulated battle
+class SimulatedBattleCallback : public CBattleCallback
+{
+public:
+	SimulatedBattleCallback(PlayerColor player, const BattleInfo * battle)
+		: CBattleCallback(player, nullptr)
+	{
+		setBattle(battle);
+	}
+
+	int battleMakeAction(const BattleAction * action) override
+	{
+		logGlobal->debug("Simulated battle: hero actions are not supported, %s ignored", action->toString());
+		return -1;
+	}
+
+	bool battleMakeTacticAction(BattleAction * action) override
+	{
+		return false;
+	}
+
+	std::optional<BattleAction> makeSurrenderRetreatDecision(const BattleStateInfoForRetreat & battleState) override
+	{
+		return std::nullopt;
+	}
+
+#if SCRIPTING_ENABLED
+	scripting::Pool * getContextPool() const override
+	{
+		return nullptr;
+	}
+#endif
+};
+
+class SimulatedBattleEnvironment : public Environment
+{
+	std::shared_ptr<SimulatedBattleCallback> cb;
+	std::unique_ptr<events::EventBus> bus;
+
+public:
+	SimulatedBattleEnvironment(std::shared_ptr<SimulatedBattleCallback> cb)
+		: cb(cb),
+		bus(std::make_unique<events::EventBus>())
+	{
+	}
+
+	const Services * services() const override
+	{
+		return VLC;
+	}
+
+	const BattleCb * battle() const override
+	{
+		return cb.get();
+	}
+
+	const GameCb * game() const override
+	{
+		return nullptr;
+	}
+
+	vstd::CLoggerBase * logger() const override
+	{
+		return logGlobal;
+	}
+
+	events::EventBus * eventBus() const override
+	{
+		return bus.get();
+	}
+};
+
+BattleSimulationPlayer::BattleSimulationPlayer(const std::string & aiName)
+	: aiName(aiName)
+{
+}
+
+BattleSimulationPlayer::~BattleSimulationPlayer() = default;
+
+void BattleSimulationPlayer::battleStart(const BattleInfo * battle, ui8 side)
+{
+	const PlayerColor player = battle->sides[side].color;
+
+	cb = std::make_shared<SimulatedBattleCallback>(player, battle);
+	env = std::make_shared<SimulatedBattleEnvironment>(cb);
+
+	ai = CDynLibHandler::getNewBattleAI(aiName);
+	ai->initBattleInterface(env, cb);
+	ai->battleStart(battle->sides[0].armyObject, battle->sides[1].armyObject, battle->tile, nullptr, nullptr, side);
+}
+
+BattleAction BattleSimulationPlayer::activeStack(const CStack * stack)
+{
+	return ai->activeStack(stack);
+}
+
+BattleSimulationPlayerFactory BattleSimulationPlayer::factory()
+{
+	std::string defaultAI = settings["server"]["neutralAI"].String();
+
+	return [defaultAI](const BattleSimulationSide & side)
+	{
+		return std::make_unique<BattleSimulationPlayer>(side.ai.empty() ? defaultAI : side.ai);
+	};
+}
+
+void BattleSimulationPlayer::runFromFile(const boost::filesystem::path & setupFile, const boost::filesystem::path & reportFile, const boost::filesystem::path & benchmarkFile)
+{
+	boost::filesystem::ifstream input(setupFile, std::ios::binary);
+	if(!input)
+		throw std::runtime_error("Failed to open battle simulation setup " + setupFile.string());
+
+	std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+	const JsonNode config(data.data(), data.size());
+	auto setup = BattleSimulationSetup::fromJson(config);
+
+	logGlobal->info("Simulating %d battles from %s", setup.battles, setupFile.string());
+
+	if(!benchmarkFile.empty())
+		AIBenchmark::get().start(0, setup.seed);
+
+	BattleSimulator simulator(setup, factory());
+	auto report = simulator.run();
+
+	if(!benchmarkFile.empty())
+	{
+		//battle AI reports activations of whole simulation as single turn of each player
+		for(const auto & turn : AIBenchmark::get().getTurns())
+		{
+			uint64_t states = turn.counters.count("states") ? turn.counters.at("states") : 0;
+
+			logGlobal->info("%s of %s: %d states in %d ms, %d states/s",
+				turn.ai, turn.player.getStr(), states, turn.turnTime, states * 1000 / std::max<uint64_t>(turn.turnTime, 1));
+		}
+
+		AIBenchmark::get().save(benchmarkFile, setupFile.filename().string());
+	}
+
+	boost::filesystem::ofstream output(reportFile, std::ios::binary | std::ios::trunc);
+	output << report.toJson(config["verbose"].Bool()).toJson();
+
+	logGlobal->info("Battle simulation finished in %d ms: attacker won %d, defender won %d, draws %d. Report written to %s",
+		report.totalTime / 1000, report.wins(BattleSide::ATTACKER), report.wins(BattleSide::DEFENDER), report.draws(), reportFile.string());
+}
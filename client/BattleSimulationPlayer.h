@@ -0,0 +1,43 @@
+/*
+ * BattleSimulationPlayer.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "../lib/battle/BattleSimulator.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+class CBattleGameInterface;
+VCMI_LIB_NAMESPACE_END
+
+class SimulatedBattleCallback;
+class SimulatedBattleEnvironment;
+
+/// Lets battle AI library control one side of simulated battle
+class BattleSimulationPlayer : public IBattleSimulationPlayer
+{
+	std::string aiName;
+	std::shared_ptr<SimulatedBattleEnvironment> env;
+	std::shared_ptr<SimulatedBattleCallback> cb;
+	std::shared_ptr<CBattleGameInterface> ai;
+
+public:
+	BattleSimulationPlayer(const std::string & aiName);
+	~BattleSimulationPlayer();
+
+	void battleStart(const BattleInfo * battle, ui8 side) override;
+	BattleAction activeStack(const CStack * stack) override;
+
+	/// creates players using AI from side setup or neutral AI from settings
+	static BattleSimulationPlayerFactory factory();
+
+	/// runs battles described in json file (see BattleSimulationSetup) and writes report to given file, used by --simulate-battles
+	/// results of every battle are included in report if setup has "verbose" : true
+	/// if benchmark file is given, measurements of battle AI (evaluated states and time) are appended to it, see --benchmark
+	static void runFromFile(const boost::filesystem::path & setupFile, const boost::filesystem::path & reportFile, const boost::filesystem::path & benchmarkFile = {});
+};
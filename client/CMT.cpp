@@ -24,6 +24,7 @@
 #include "CServerHandler.h"
 #include "gui/NotificationHandler.h"
 #include "ClientCommandManager.h"
+#include "BattleSimulationPlayer.h"
 #include "windows/CMessage.h"
 #include "renderSDL/SDL_Extensions.h"
 
@@ -44,6 +45,7 @@
 #include "../lib/CTownHandler.h"
 #include "../lib/logging/CBasicLogConfigurator.h"
 #include "../lib/CPlayerState.h"
+#include "../lib/AIBenchmark.h"
 #include "../lib/serializer/Connection.h"
 
 #include <boost/asio.hpp>
@@ -177,6 +179,11 @@ int main(int argc, char * argv[])
 		("enable-shm-uuid", "use UUID for shared memory identifier")
 		("testmap", po::value<std::string>(), "")
 		("testsave", po::value<std::string>(), "")
+		("benchmark", po::value<std::string>(), "play loaded test save with AI only and append measurements of AI turns to given json file, together with --simulate-battles append measurements of battle AI")
+		("benchmark-days", po::value<si64>(), "number of days to play in benchmark mode, 7 by default")
+		("benchmark-seed", po::value<si64>(), "random seed used by AI in benchmark mode, 0 by default")
+		("simulate-battles", po::value<std::string>(), "play battles described in given json file with battle AI only and exit")
+		("simulate-battles-report", po::value<std::string>(), "json file to write battle simulation report to, simulation_report.json by default")
 		("spectate,s", "enable spectator interface for AI-only games")
 		("spectate-ignore-hero", "wont follow heroes on adventure map")
 		("spectate-hero-speed", po::value<int>(), "hero movement speed on adventure map")
@@ -476,6 +483,22 @@ int main(int argc, char * argv[])
 	#endif // ANDROID
 #endif // THREADED
 
+	if(vm.count("simulate-battles"))
+	{
+		std::string reportFile = vm.count("simulate-battles-report") ? vm["simulate-battles-report"].as<std::string>() : "simulation_report.json";
+		std::string benchmarkFile = vm.count("benchmark") ? vm["benchmark"].as<std::string>() : "";
+		try
+		{
+			BattleSimulationPlayer::runFromFile(vm["simulate-battles"].as<std::string>(), reportFile, benchmarkFile);
+		}
+		catch(const std::exception & e)
+		{
+			logGlobal->error("Battle simulation failed: %s", e.what());
+			exit(EXIT_FAILURE);
+		}
+		exit(EXIT_SUCCESS);
+	}
+
 	if(!settings["session"]["headless"].Bool())
 	{
 		pomtime.getDiff();
@@ -508,6 +531,14 @@ int main(int argc, char * argv[])
 	{
 		session["testsave"].String() = vm["testsave"].as<std::string>();
 		session["onlyai"].Bool() = true;
+
+		if(vm.count("benchmark"))
+		{
+			session["benchmark"].String() = vm["benchmark"].as<std::string>();
+			AIBenchmark::get().start(
+				vm.count("benchmark-days") ? vm["benchmark-days"].as<si64>() : 7,
+				vm.count("benchmark-seed") ? vm["benchmark-seed"].as<si64>() : 0);
+		}
 		boost::thread(&CServerHandler::debugStartTest, CSH, session["testsave"].String(), true);
 	}
 	else
@@ -142,7 +142,7 @@ void CServerHandler::resetStateForLobby(const StartInfo::EMode mode, const std::
 	state = EClientState::NONE;
 	th = std::make_unique<CStopWatch>();
 	packsForLobbyScreen.clear();
-	c.reset();
+	std::atomic_store(&c, std::shared_ptr<CConnection>());
 	si = std::make_shared<StartInfo>();
 	playerNames.clear();
 	si->difficulty = 1;
@@ -280,10 +280,10 @@ void CServerHandler::justConnectToServer(const std::string & addr, const ui16 po
 		try
 		{
 			logNetwork->info("Establishing connection...");
-			c = std::make_shared<CConnection>(
+			std::atomic_store(&c, std::make_shared<CConnection>(
 					addr.size() ? addr : getHostAddress(),
 					port ? port : getHostPort(),
-					NAME, uuid);
+					NAME, uuid));
 		}
 		catch(...)
 		{
@@ -339,25 +339,30 @@ void CServerHandler::stopServerConnection()
 	}
 }
 
+std::shared_ptr<CConnection> CServerHandler::getConnection() const
+{
+	return std::atomic_load(&c);
+}
+
 std::set<PlayerColor> CServerHandler::getHumanColors()
 {
-	return clientHumanColors(c->connectionID);
+	return clientHumanColors(getConnection()->connectionID);
 }
 
 
 PlayerColor CServerHandler::myFirstColor() const
 {
-	return clientFirstColor(c->connectionID);
+	return clientFirstColor(getConnection()->connectionID);
 }
 
 bool CServerHandler::isMyColor(PlayerColor color) const
 {
-	return isClientColor(c->connectionID, color);
+	return isClientColor(getConnection()->connectionID, color);
 }
 
 ui8 CServerHandler::myFirstId() const
 {
-	return clientFirstId(c->connectionID);
+	return clientFirstId(getConnection()->connectionID);
 }
 
 bool CServerHandler::isServerLocal() const
@@ -370,12 +375,14 @@ bool CServerHandler::isServerLocal() const
 
 bool CServerHandler::isHost() const
 {
-	return c && hostClientId == c->connectionID;
+	auto connection = getConnection();
+	return connection && hostClientId == connection->connectionID;
 }
 
 bool CServerHandler::isGuest() const
 {
-	return !c || hostClientId != c->connectionID;
+	auto connection = getConnection();
+	return !connection || hostClientId != connection->connectionID;
 }
 
 ui16 CServerHandler::getDefaultPort()
@@ -427,7 +434,7 @@ void CServerHandler::sendClientDisconnecting()
 
 	state = EClientState::DISCONNECTING;
 	LobbyClientDisconnected lcd;
-	lcd.clientId = c->connectionID;
+	lcd.clientId = getConnection()->connectionID;
 	logNetwork->info("Connection has been requested to be closed.");
 	if(isServerLocal())
 	{
@@ -579,8 +586,8 @@ void CServerHandler::sendStartGame(bool allowOnlyAI) const
 		* si = * lsg.initializedStartInfo;
 	}
 	sendLobbyPack(lsg);
-	c->enterLobbyConnectionMode();
-	c->disableStackSendingByID();
+	getConnection()->enterLobbyConnectionMode();
+	getConnection()->disableStackSendingByID();
 }
 
 void CServerHandler::startGameplay(VCMI_LIB_WRAP_NAMESPACE(CGameState) * gameState)
@@ -604,7 +611,8 @@ void CServerHandler::startGameplay(VCMI_LIB_WRAP_NAMESPACE(CGameState) * gameSta
 		throw std::runtime_error("Invalid mode");
 	}
 	// After everything initialized we can accept CPackToClient netpacks
-	c->enterGameplayConnectionMode(client->gameState());
+	getConnection()->enterGameplayConnectionMode(client->gameState());
+	receivedGameplayPacks = 0;
 	state = EClientState::GAMEPLAY;
 	
 	//store settings to continue game
@@ -651,8 +659,8 @@ void CServerHandler::endGameplay(bool closeConnection, bool restart)
 		}
 	}
 	
-	c->enterLobbyConnectionMode();
-	c->disableStackSendingByID();
+	getConnection()->enterLobbyConnectionMode();
+	getConnection()->disableStackSendingByID();
 	
 	//reset settings
 	Settings saveSession = settings.write["server"]["reconnect"];
@@ -692,7 +700,7 @@ ui8 CServerHandler::getLoadMode()
 			return ELoadMode::CAMPAIGN;
 		for(auto pn : playerNames)
 		{
-			if(pn.second.connection != c->connectionID)
+			if(pn.second.connection != getConnection()->connectionID)
 				return ELoadMode::MULTI;
 		}
 		if(howManyPlayerInterfaces() > 1)  //this condition will work for hotseat mode OR multiplayer with allowed more than 1 color per player to control
@@ -804,6 +812,9 @@ void CServerHandler::threadHandleConnection()
 	setThreadName("CServerHandler::threadHandleConnection");
 	c->enterLobbyConnectionMode();
 
+	const int maxReconnectAttempts = 30;
+	int reconnectAttempts = 0;
+
 	try
 	{
 		sendClientConnecting();
@@ -812,7 +823,27 @@ void CServerHandler::threadHandleConnection()
 			while(state == EClientState::STARTING)
 				boost::this_thread::sleep(boost::posix_time::milliseconds(10));
 
-			CPack * pack = c->retrievePack();
+			CPack * pack = nullptr;
+			try
+			{
+				pack = c->retrievePack();
+			}
+			catch(const boost::system::system_error & e)
+			{
+				// Game on remote server continues, try to receive packs that were missed instead of whole game state
+				if(state == EClientState::GAMEPLAY && client && !isServerLocal())
+				{
+					logNetwork->error("Lost connection to server: %s", e.what());
+					while(reconnectAttempts++ < maxReconnectAttempts && !reconnectToGame())
+						continue;
+				}
+
+				if(c->connected)
+					continue;
+				throw;
+			}
+			reconnectAttempts = 0;
+
 			if(state == EClientState::DISCONNECTING)
 			{
 				// FIXME: server shouldn't really send netpacks after it's tells client to disconnect
@@ -858,6 +889,36 @@ void CServerHandler::threadHandleConnection()
 	}
 }
 
+bool CServerHandler::reconnectToGame()
+{
+	boost::this_thread::sleep(boost::posix_time::seconds(1));
+	logNetwork->info("Reconnecting to the server, %d packs received", receivedGameplayPacks);
+
+	try
+	{
+		auto connection = std::make_shared<CConnection>(getHostAddress(), getHostPort(), NAME, uuid);
+		connection->connectionID = c->connectionID;
+		connection->enterLobbyConnectionMode();
+		// This thread is owned by old connection, which would join it on destruction
+		connection->handler = c->handler;
+		c->handler.reset();
+		std::atomic_store(&c, connection);
+	}
+	catch(...)
+	{
+		logNetwork->error("Cannot reconnect to the server!");
+		return false;
+	}
+
+	LobbyClientConnected lcc;
+	lcc.uuid = uuid;
+	lcc.names = myNames;
+	lcc.mode = si->mode;
+	lcc.receivedPacks = receivedGameplayPacks;
+	sendLobbyPack(lcc);
+	return true;
+}
+
 void CServerHandler::visitForLobby(CPackForLobby & lobbyPack)
 {
 	if(applier->getApplier(typeList.getTypeID(&lobbyPack))->applyOnLobbyHandler(this, &lobbyPack))
@@ -872,6 +933,7 @@ void CServerHandler::visitForLobby(CPackForLobby & lobbyPack)
 
 void CServerHandler::visitForClient(CPackForClient & clientPack)
 {
+	receivedGameplayPacks++;
 	client->handlePack(&clientPack);
 }
 
@@ -940,5 +1002,5 @@ void CServerHandler::onServerFinished()
 void CServerHandler::sendLobbyPack(const CPackForLobby & pack) const
 {
 	if(state != EClientState::STARTING)
-		c->sendPack(&pack);
+		getConnection()->sendPack(&pack);
 }
@@ -81,7 +81,11 @@ class CServerHandler : public IServerAPI, public LobbyInfo
 
 	std::vector<std::string> myNames;
 
+	/// gameplay packs received since game state, allows server to send only missed packs after reconnection
+	ui64 receivedGameplayPacks = 0;
+
 	void threadHandleConnection();
+	bool reconnectToGame();
 	void threadRunServer();
 	void onServerFinished();
 	void sendLobbyPack(const CPackForLobby & pack) const override;
@@ -101,6 +105,7 @@ public:
 	std::unique_ptr<CStopWatch> th;
 	std::shared_ptr<boost::thread> threadRunLocalServer;
 
+	/// replaced by thread handling connection when it reconnects to server, other threads use getConnection
 	std::shared_ptr<CConnection> c;
 	CClient * client;
 
@@ -120,6 +125,7 @@ public:
 	void stopServerConnection();
 
 	// Helpers for lobby state access
+	std::shared_ptr<CConnection> getConnection() const;
 	std::set<PlayerColor> getHumanColors();
 	PlayerColor myFirstColor() const;
 	bool isMyColor(PlayerColor color) const;
@@ -28,12 +28,15 @@
 #include "../lib/mapping/CCampaignHandler.h"
 #include "windows/CCastleInterface.h"
 #include "render/CAnimation.h"
+#include "render/ImageCache.h"
 #include "../CCallback.h"
 #include "../lib/CGeneralTextHandler.h"
 #include "../lib/filesystem/Filesystem.h"
 #include "../lib/CHeroHandler.h"
 #include "../lib/CModHandler.h"
 #include "../lib/VCMIDirs.h"
+#include "../lib/Profiler.h"
+#include "../lib/serializer/PackStatistics.h"
 #include "CMT.h"
 
 #ifdef SCRIPTING_ENABLED
@@ -449,6 +452,96 @@ void ClientCommandManager::handleUnlockCommand(std::istringstream& singleWordBuf
 		LOCPLINT->pim->unlock();
 }
 
+void ClientCommandManager::handleImageCacheCommand(std::istringstream& singleWordBuffer)
+{
+	std::string what;
+	singleWordBuffer >> what;
+
+	if(what == "reset")
+	{
+		ImageCache::get().resetStatistics();
+		printCommandMessage("Image cache statistics reset", ELogLevel::INFO);
+		return;
+	}
+
+	if(what == "limit")
+	{
+		size_t megabytes = 0;
+		singleWordBuffer >> megabytes;
+		ImageCache::get().setBudget(megabytes * 1024 * 1024);
+	}
+
+	auto stats = ImageCache::get().getStatistics();
+
+	boost::format fmt("Image cache: %d images, %d KB resident, budget %s; %d hits, %d misses, %d evictions\n");
+	fmt % stats.residentImages % (stats.residentBytes / 1024);
+	fmt % (stats.budgetBytes ? std::to_string(stats.budgetBytes / 1024 / 1024) + " MB" : std::string("unlimited"));
+	fmt % stats.hits % stats.misses % stats.evictions;
+	printCommandMessage(fmt.str());
+}
+
+void ClientCommandManager::handlePackStatsCommand(std::istringstream& singleWordBuffer)
+{
+	std::string what;
+	singleWordBuffer >> what;
+
+	if(what == "reset")
+	{
+		PackStatistics::get().reset();
+		printCommandMessage("Pack statistics reset", ELogLevel::INFO);
+		return;
+	}
+
+	if(what == "timing")
+	{
+		std::string state;
+		singleWordBuffer >> state;
+
+		if(state != "on" && state != "off")
+		{
+			printCommandMessage("Usage: packstats timing <on/off>", ELogLevel::ERROR);
+			return;
+		}
+
+		PackStatistics::get().setTimingEnabled(state == "on");
+	}
+
+	printCommandMessage(PackStatistics::get().toString());
+}
+
+void ClientCommandManager::handleProfilerCommand(std::istringstream& singleWordBuffer)
+{
+	std::string what;
+	singleWordBuffer >> what;
+
+	if(what == "start")
+	{
+		Profiler::get().start();
+		printCommandMessage("Profiler started", ELogLevel::INFO);
+	}
+	else if(what == "stop")
+	{
+		Profiler::get().stop();
+		printCommandMessage("Profiler stopped", ELogLevel::INFO);
+	}
+	else if(what == "save")
+	{
+		try
+		{
+			auto path = Profiler::get().saveTrace("client");
+			printCommandMessage("Profiler trace saved to " + path.string(), ELogLevel::INFO);
+		}
+		catch(const std::exception & e)
+		{
+			printCommandMessage(e.what(), ELogLevel::ERROR);
+		}
+	}
+	else
+	{
+		printCommandMessage("Usage: profiler <start/stop/save>", ELogLevel::ERROR);
+	}
+}
+
 void ClientCommandManager::handleCrashCommand()
 {
 	int* ptr = nullptr;
@@ -611,6 +704,15 @@ void ClientCommandManager::processCommand(const std::string & message, bool call
 	else if(commandName == "unlock")
 		handleUnlockCommand(singleWordBuffer);
 
+	else if(commandName == "imagecache")
+		handleImageCacheCommand(singleWordBuffer);
+
+	else if(commandName == "packstats")
+		handlePackStatsCommand(singleWordBuffer);
+
+	else if(commandName == "profiler")
+		handleProfilerCommand(singleWordBuffer);
+
 	else if(commandName == "crash")
 		handleCrashCommand();
 
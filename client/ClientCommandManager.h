@@ -87,6 +87,15 @@ class ClientCommandManager //take mantis #2292 issue about account if thinking a
 	// Unlocks specific mutex known in VCMI code as "pim"
 	void handleUnlockCommand(std::istringstream& singleWordBuffer);
 
+	// imagecache [reset|limit <megabytes>] - prints statistics of decoded images cache, resets its counters or changes its memory budget
+	void handleImageCacheCommand(std::istringstream& singleWordBuffer);
+
+	// packstats [reset|timing <on/off>] - prints count, size and time of serialization and application of packs of every type
+	void handlePackStatsCommand(std::istringstream& singleWordBuffer);
+
+	// profiler <start/stop/save> - records timing of profiled zones of all threads, save writes Chrome trace into Profiles directory
+	void handleProfilerCommand(std::istringstream& singleWordBuffer);
+
 	// Crashes the game forcing an exception
 	void handleCrashCommand();
 
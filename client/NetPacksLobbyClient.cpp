@@ -19,6 +19,7 @@
 #include "lobby/CBonusSelection.h"
 
 #include "CServerHandler.h"
+#include "Client.h"
 #include "CGameInfo.h"
 #include "gui/CGuiHandler.h"
 #include "widgets/Buttons.h"
@@ -37,6 +38,10 @@ void ApplyOnLobbyHandlerNetPackVisitor::visitLobbyClientConnected(LobbyClientCon
 	if(pack.uuid == handler.c->uuid)
 	{
 		handler.c->connectionID = pack.clientId;
+		// Reconnected during game, server sends game state or missed packs next
+		if(handler.client)
+			return;
+
 		if(!settings["session"]["headless"].Bool())
 			GH.pushIntT<CLobbyScreen>(static_cast<ESelectionScreen>(handler.screenType));
 		handler.state = EClientState::LOBBY;
@@ -111,6 +116,20 @@ void ApplyOnLobbyHandlerNetPackVisitor::visitLobbyStartGame(LobbyStartGame & pac
 		result = false;
 		return;
 	}
+
+	if(handler.client)
+	{
+		if(pack.resync)
+		{
+			// Game state is kept and packs that were missed follow
+			handler.c->enterGameplayConnectionMode(handler.client->gameState());
+			result = false;
+			return;
+		}
+
+		// Server no longer has packs that were missed, game is started again with received state
+		handler.endGameplay(false, true);
+	}
 	
 	handler.state = EClientState::STARTING;
 	if(handler.si->mode != StartInfo::LOAD_GAME || pack.clientId == handler.c->connectionID)
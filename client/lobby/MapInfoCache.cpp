@@ -0,0 +1,174 @@
+/*
+ * MapInfoCache.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "MapInfoCache.h"
+
+#include "../../lib/CConfigHandler.h"
+#include "../../lib/CModHandler.h"
+#include "../../lib/VCMIDirs.h"
+#include "../../lib/VCMI_Lib.h"
+#include "../../lib/filesystem/Filesystem.h"
+#include "../../lib/mapping/CMapInfo.h"
+#include "../../lib/mapping/CMap.h"
+#include "../../lib/mapping/CCampaignHandler.h"
+#include "../../lib/StartInfo.h"
+#include "../../lib/rmg/CMapGenOptions.h"
+#include "../../lib/serializer/BinarySerializer.h"
+#include "../../lib/serializer/BinaryDeserializer.h"
+
+static const std::string MAP_INFO_CACHE_MAGIC = "VCMIMAPCACHE";
+
+MapInfoCache & MapInfoCache::get()
+{
+	static MapInfoCache instance;
+	return instance;
+}
+
+MapInfoCache::MapInfoCache()
+	: modified(false)
+{
+	load();
+}
+
+std::string MapInfoCache::currentContext()
+{
+	std::string result = settings["general"]["language"].String();
+
+	for(const auto & mod : VLC->modh->getActiveMods())
+		result += ";" + mod;
+
+	return result;
+}
+
+boost::filesystem::path MapInfoCache::cacheFile()
+{
+	return VCMIDirs::get().userCachePath() / "mapHeaders.vcache";
+}
+
+bool MapInfoCache::getFileStamp(const ResourceID & resource, si64 & modificationTime, ui64 & fileSize)
+{
+	auto path = CResourceHandler::get()->getResourceName(resource);
+	if(!path)
+		return false;
+
+	boost::system::error_code ec;
+	modificationTime = boost::filesystem::last_write_time(*path, ec);
+	if(ec)
+		return false;
+
+	fileSize = boost::filesystem::file_size(*path, ec);
+	return !ec;
+}
+
+void MapInfoCache::load()
+{
+	context = currentContext();
+
+	if(!boost::filesystem::exists(cacheFile()))
+		return;
+
+	try
+	{
+		CLoadFile lf(cacheFile(), SERIALIZATION_VERSION);
+		lf.checkMagicBytes(MAP_INFO_CACHE_MAGIC);
+
+		std::string loadedContext;
+		lf >> loadedContext;
+
+		if(loadedContext != context)
+		{
+			logGlobal->debug("Map header cache was created with different language or mods, discarding it");
+			modified = true;
+			return;
+		}
+
+		lf >> entries;
+		logGlobal->debug("Loaded %d entries from map header cache", entries.size());
+	}
+	catch(const std::exception & e)
+	{
+		logGlobal->warn("Failed to load map header cache: %s", e.what());
+		entries.clear();
+		modified = true;
+	}
+}
+
+std::shared_ptr<CMapInfo> MapInfoCache::find(const ResourceID & resource) const
+{
+	si64 modificationTime;
+	ui64 fileSize;
+	if(!getFileStamp(resource, modificationTime, fileSize))
+		return nullptr;
+
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	auto it = entries.find(resource.getName());
+	if(it == entries.end())
+		return nullptr;
+
+	if(it->second.modificationTime != modificationTime || it->second.fileSize != fileSize)
+		return nullptr;
+
+	return it->second.mapInfo;
+}
+
+void MapInfoCache::store(const ResourceID & resource, std::shared_ptr<CMapInfo> mapInfo)
+{
+	Entry entry;
+	if(!getFileStamp(resource, entry.modificationTime, entry.fileSize))
+		return;
+
+	entry.mapInfo = mapInfo;
+
+	boost::unique_lock<boost::mutex> lock(mx);
+	entries[resource.getName()] = entry;
+	modified = true;
+}
+
+void MapInfoCache::retainOnly(const std::unordered_set<ResourceID> & files)
+{
+	std::set<std::string> names;
+	for(const auto & file : files)
+		names.insert(file.getName());
+
+	boost::unique_lock<boost::mutex> lock(mx);
+	for(auto it = entries.begin(); it != entries.end();)
+	{
+		if(vstd::contains(names, it->first))
+		{
+			++it;
+		}
+		else
+		{
+			it = entries.erase(it);
+			modified = true;
+		}
+	}
+}
+
+void MapInfoCache::save()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(!modified)
+		return;
+
+	try
+	{
+		CSaveFile file(cacheFile());
+		file.putMagicBytes(MAP_INFO_CACHE_MAGIC);
+		file << context << entries;
+		modified = false;
+	}
+	catch(const std::exception & e)
+	{
+		logGlobal->warn("Failed to save map header cache: %s", e.what());
+	}
+}
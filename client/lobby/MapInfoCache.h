@@ -0,0 +1,66 @@
+/*
+ * MapInfoCache.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+VCMI_LIB_NAMESPACE_BEGIN
+class CMapInfo;
+class ResourceID;
+VCMI_LIB_NAMESPACE_END
+
+/// Persistent index of parsed map headers stored in user cache directory
+/// Allows lobby to parse only maps that were added or changed since previous scan
+class MapInfoCache : boost::noncopyable
+{
+	struct Entry
+	{
+		si64 modificationTime = 0;
+		ui64 fileSize = 0;
+		std::shared_ptr<CMapInfo> mapInfo;
+
+		template <typename Handler> void serialize(Handler & h, const int version)
+		{
+			h & modificationTime;
+			h & fileSize;
+			h & mapInfo;
+		}
+	};
+
+	/// language and active mods that were used to parse cached headers, cache is discarded if they change
+	std::string context;
+	std::map<std::string, Entry> entries;
+	bool modified;
+
+	mutable boost::mutex mx;
+
+	MapInfoCache();
+
+	static std::string currentContext();
+	static boost::filesystem::path cacheFile();
+
+	/// returns modification time and size of file on disk, or false if resource is not a plain file
+	static bool getFileStamp(const ResourceID & resource, si64 & modificationTime, ui64 & fileSize);
+
+	void load();
+
+public:
+	static MapInfoCache & get();
+
+	/// returns parsed header of map if it was not changed since it was cached, nullptr otherwise. Thread-safe
+	std::shared_ptr<CMapInfo> find(const ResourceID & resource) const;
+
+	/// stores parsed header of map. Thread-safe
+	void store(const ResourceID & resource, std::shared_ptr<CMapInfo> mapInfo);
+
+	/// removes entries of maps that are no longer present
+	void retainOnly(const std::unordered_set<ResourceID> & files);
+
+	/// writes cache to disk if it was changed since loading
+	void save();
+};
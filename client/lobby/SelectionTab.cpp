@@ -12,6 +12,7 @@
 #include "SelectionTab.h"
 #include "CSelectionBase.h"
 #include "CLobbyScreen.h"
+#include "MapInfoCache.h"
 
 #include "../CGameInfo.h"
 #include "../CPlayerInterface.h"
@@ -31,6 +32,7 @@
 #include "../../lib/NetPacksLobby.h"
 #include "../../lib/CGeneralTextHandler.h"
 #include "../../lib/CModHandler.h"
+#include "../../lib/CThreadHelper.h"
 #include "../../lib/GameSettings.h"
 #include "../../lib/filesystem/Filesystem.h"
 #include "../../lib/mapping/CMapInfo.h"
@@ -526,32 +528,81 @@ void SelectionTab::restoreLastSelection()
 	}
 }
 
+/// Runs parser on every file using all available cores. Files that failed to parse are omitted from result
+static std::vector<std::shared_ptr<CMapInfo>> parseInParallel(const std::unordered_set<ResourceID> & files, const std::function<std::shared_ptr<CMapInfo>(const ResourceID &)> & parser)
+{
+	std::vector<ResourceID> fileList(files.begin(), files.end());
+	std::vector<std::shared_ptr<CMapInfo>> results(fileList.size());
+
+	//strings registered by parsed maps are kept per file and merged once all threads finished, so text handler needs no locking
+	std::vector<CGeneralTextHandler::StringsCollector> strings(fileList.size());
+
+	std::vector<CThreadHelper::Task> tasks;
+	tasks.reserve(fileList.size());
+
+	for(size_t i = 0; i < fileList.size(); i++)
+	{
+		tasks.push_back([&, i]()
+		{
+			CGeneralTextHandler::setThreadCollector(&strings[i]);
+			results[i] = parser(fileList[i]);
+			CGeneralTextHandler::setThreadCollector(nullptr);
+		});
+	}
+
+	CThreadHelper helper(&tasks, std::max<int>(1, boost::thread::hardware_concurrency()));
+	helper.run();
+
+	for(auto & collected : strings)
+		CGI->generaltexth->mergeCollected(collected);
+
+	vstd::erase_if(results, [](const std::shared_ptr<CMapInfo> & info){ return info == nullptr; });
+	return results;
+}
+
 void SelectionTab::parseMaps(const std::unordered_set<ResourceID> & files)
 {
 	logGlobal->debug("Parsing %d maps", files.size());
 	allItems.clear();
-	for(auto & file : files)
+
+	EMapFormat maxSupported = static_cast<EMapFormat>(CGI->settings()->getInteger(EGameSettings::TEXTS_MAP_VERSION));
+	MapInfoCache & cache = MapInfoCache::get();
+	std::atomic<int> parsedCount(0);
+
+	allItems = parseInParallel(files, [&](const ResourceID & file) -> std::shared_ptr<CMapInfo>
 	{
 		try
 		{
-			auto mapInfo = std::make_shared<CMapInfo>();
-			mapInfo->mapInit(file.getName());
-
-			EMapFormat maxSupported = static_cast<EMapFormat>(CGI->settings()->getInteger(EGameSettings::TEXTS_MAP_VERSION));
+			auto mapInfo = cache.find(file);
+			if(!mapInfo)
+			{
+				mapInfo = std::make_shared<CMapInfo>();
+				mapInfo->mapInit(file.getName());
+				cache.store(file, mapInfo);
+				parsedCount++;
+			}
 
 			if(mapInfo->mapHeader->version == EMapFormat::VCMI || mapInfo->mapHeader->version <= maxSupported)
-				allItems.push_back(mapInfo);
+				return mapInfo;
 		}
 		catch(std::exception & e)
 		{
 			logGlobal->error("Map %s is invalid. Message: %s", file.getName(), e.what());
 		}
-	}
+		return nullptr;
+	});
+
+	logGlobal->debug("Parsed %d maps, %d taken from cache", parsedCount.load(), files.size() - parsedCount.load());
+
+	cache.retainOnly(files);
+	cache.save();
 }
 
 void SelectionTab::parseSaves(const std::unordered_set<ResourceID> & files)
 {
-	for(auto & file : files)
+	auto loadMode = CSH->getLoadMode();
+
+	auto saves = parseInParallel(files, [&](const ResourceID & file) -> std::shared_ptr<CMapInfo>
 	{
 		try
 		{
@@ -561,7 +612,7 @@ void SelectionTab::parseSaves(const std::unordered_set<ResourceID> & files)
 			// Filter out other game modes
 			bool isCampaign = mapInfo->scenarioOptionsOfSave->mode == StartInfo::CAMPAIGN;
 			bool isMultiplayer = mapInfo->amountOfHumanPlayersInSave > 1;
-			switch(CSH->getLoadMode())
+			switch(loadMode)
 			{
 			case ELoadMode::SINGLE:
 				if(isMultiplayer || isCampaign)
@@ -577,26 +628,38 @@ void SelectionTab::parseSaves(const std::unordered_set<ResourceID> & files)
 				break;
 			}
 
-			allItems.push_back(mapInfo);
+			return mapInfo;
 		}
 		catch(const std::exception & e)
 		{
 			logGlobal->error("Error: Failed to process %s: %s", file.getName(), e.what());
 		}
-	}
+		return nullptr;
+	});
+
+	vstd::concatenate(allItems, saves);
 }
 
 void SelectionTab::parseCampaigns(const std::unordered_set<ResourceID> & files)
 {
-	allItems.reserve(files.size());
-	for(auto & file : files)
-	{
-		auto info = std::make_shared<CMapInfo>();
-		//allItems[i].date = std::asctime(std::localtime(&files[i].date));
-		info->fileURI = file.getName();
-		info->campaignInit();
-		allItems.push_back(info);
-	}
+	auto campaigns = parseInParallel(files, [](const ResourceID & file) -> std::shared_ptr<CMapInfo>
+	{
+		try
+		{
+			auto info = std::make_shared<CMapInfo>();
+			//allItems[i].date = std::asctime(std::localtime(&files[i].date));
+			info->fileURI = file.getName();
+			info->campaignInit();
+			return info;
+		}
+		catch(const std::exception & e)
+		{
+			logGlobal->error("Error: Failed to process %s: %s", file.getName(), e.what());
+		}
+		return nullptr;
+	});
+
+	vstd::concatenate(allItems, campaigns);
 }
 
 std::unordered_set<ResourceID> SelectionTab::getFiles(std::string dirURI, int resType)
@@ -20,6 +20,7 @@
 #include "../render/IImage.h"
 
 #include "../../lib/mapObjects/CObjectHandler.h"
+#include "../../lib/Profiler.h"
 
 MapViewCache::~MapViewCache() = default;
 
@@ -134,6 +135,8 @@ void MapViewCache::update(const std::shared_ptr<IMapRendererContext> & context)
 
 void MapViewCache::render(const std::shared_ptr<IMapRendererContext> & context, Canvas & target, bool fullRedraw)
 {
+	PROFILE_ZONE("MapViewCache::render");
+
 	bool mapMoved = (cachedPosition != model->getMapViewCenter());
 	bool lazyUpdate = !mapMoved && !fullRedraw && context->viewTransitionProgress() == 0;
 
@@ -13,11 +13,12 @@
 #include "CDefFile.h"
 
 #include "Graphics.h"
+#include "ImageCache.h"
 #include "../../lib/filesystem/Filesystem.h"
 #include "../../lib/JsonNode.h"
 #include "../renderSDL/SDLImage.h"
 
-std::shared_ptr<IImage> CAnimation::getFromExtraDef(std::string filename)
+std::shared_ptr<IImage> CAnimation::getFromExtraDef(std::string filename) const
 {
 	size_t pos = filename.find(':');
 	if (pos == -1)
@@ -39,7 +40,7 @@ std::shared_ptr<IImage> CAnimation::getFromExtraDef(std::string filename)
 	return ret;
 }
 
-bool CAnimation::loadFrame(size_t frame, size_t group)
+bool CAnimation::loadFrame(size_t frame, size_t group) const
 {
 	if(size(group) <= frame)
 	{
@@ -47,56 +48,110 @@ bool CAnimation::loadFrame(size_t frame, size_t group)
 		return false;
 	}
 
-	auto image = getImage(frame, group, false);
-	if(image)
+	auto groupIter = images.find(group);
+	if(groupIter != images.end() && vstd::contains(groupIter->second, frame))
 	{
 		return true;
 	}
 
+	const JsonNode & frameSource = source.at(group)[frame];
+
+	std::shared_ptr<IImage> image;
+	bool loaded = true;
+
 	//try to get image from def
-	if(source[group][frame].getType() == JsonNode::JsonType::DATA_NULL)
+	if(frameSource.getType() == JsonNode::JsonType::DATA_NULL)
 	{
 		if(defFile)
 		{
 			auto frameList = defFile->getEntries();
 
 			if(vstd::contains(frameList, group) && frameList.at(group) > frame) // frame is present
-			{
-				images[group][frame] = std::make_shared<SDLImage>(defFile.get(), frame, group);
-				return true;
-			}
+				image = std::make_shared<SDLImage>(defFile.get(), frame, group);
 		}
-		// still here? image is missing
 
-		printError(frame, group, "LoadFrame");
-		images[group][frame] = std::make_shared<SDLImage>("DEFAULT", EImageBlitMode::ALPHA);
+		if(!image)
+		{
+			// still here? image is missing
+			printError(frame, group, "LoadFrame");
+			image = std::make_shared<SDLImage>("DEFAULT", EImageBlitMode::ALPHA);
+			loaded = false;
+		}
 	}
 	else //load from separate file
 	{
-		auto img = getFromExtraDef(source[group][frame]["file"].String());
-		if(!img)
-			img = std::make_shared<SDLImage>(source[group][frame], EImageBlitMode::ALPHA);
-
-		images[group][frame] = img;
-		return true;
+		image = getFromExtraDef(frameSource["file"].String());
+		if(!image)
+			image = std::make_shared<SDLImage>(frameSource, EImageBlitMode::ALPHA);
 	}
-	return false;
+
+	images[group][frame] = image;
+	evictedFrames.erase(std::make_pair(group, frame));
+	ImageCache::get().registerImage(this, frame, group, image);
+	return loaded;
 }
 
 bool CAnimation::unloadFrame(size_t frame, size_t group)
 {
-	auto image = getImage(frame, group, false);
-	if(image)
+	evictedFrames.erase(std::make_pair(group, frame));
+
+	auto groupIter = images.find(group);
+	if(groupIter != images.end() && groupIter->second.erase(frame))
 	{
-		images[group].erase(frame);
+		if(groupIter->second.empty())
+			images.erase(groupIter);
 
-		if(images[group].empty())
-			images.erase(group);
+		ImageCache::get().unregisterImage(this, frame, group);
 		return true;
 	}
 	return false;
 }
 
+void CAnimation::evictFrame(size_t frame, size_t group) const
+{
+	auto groupIter = images.find(group);
+	if(groupIter == images.end())
+		return;
+
+	auto imageIter = groupIter->second.find(frame);
+	if(imageIter == groupIter->second.end())
+		return;
+
+	// frame may have been taken or modified since image cache has scheduled it for unloading
+	if(imageIter->second.use_count() > 1 || imageIter->second->isModified())
+	{
+		ImageCache::get().restoreImage(this, frame, group, imageIter->second);
+		return;
+	}
+
+	groupIter->second.erase(imageIter);
+	if(groupIter->second.empty())
+		images.erase(groupIter);
+
+	evictedFrames.insert(std::make_pair(group, frame));
+}
+
+void CAnimation::applyPendingEvictions() const
+{
+	for(const auto & entry : ImageCache::get().takePendingEvictions(this))
+		evictFrame(entry.second, entry.first);
+}
+
+void CAnimation::reloadEvictedFrames() const
+{
+	applyPendingEvictions();
+
+	// keep reloaded frames referenced so they won't be evicted again while remaining frames are loaded
+	std::vector<std::shared_ptr<IImage>> reloaded;
+	auto frames = evictedFrames;
+
+	for(const auto & entry : frames)
+	{
+		loadFrame(entry.second, entry.first);
+		reloaded.push_back(images[entry.first][entry.second]);
+	}
+}
+
 void CAnimation::initFromJson(const JsonNode & config)
 {
 	std::string basepath;
@@ -232,7 +287,10 @@ CAnimation::CAnimation():
 	init();
 }
 
-CAnimation::~CAnimation() = default;
+CAnimation::~CAnimation()
+{
+	ImageCache::get().unregisterAnimation(this);
+}
 
 void CAnimation::duplicateImage(const size_t sourceGroup, const size_t sourceFrame, const size_t targetGroup)
 {
@@ -275,13 +333,26 @@ void CAnimation::setCustom(std::string filename, size_t frame, size_t group)
 
 std::shared_ptr<IImage> CAnimation::getImage(size_t frame, size_t group, bool verbose) const
 {
+	applyPendingEvictions();
+
 	auto groupIter = images.find(group);
 	if (groupIter != images.end())
 	{
 		auto imageIter = groupIter->second.find(frame);
 		if (imageIter != groupIter->second.end())
+		{
+			ImageCache::get().touchImage(this, frame, group);
 			return imageIter->second;
+		}
 	}
+
+	// frame was unloaded to save memory - decode it again
+	if(vstd::contains(evictedFrames, std::make_pair(group, frame)))
+	{
+		loadFrame(frame, group);
+		return images[group][frame];
+	}
+
 	if (verbose)
 		printError(frame, group, "GetImage");
 	return nullptr;
@@ -345,6 +416,8 @@ size_t CAnimation::size(size_t group) const
 
 void CAnimation::horizontalFlip()
 {
+	reloadEvictedFrames();
+
 	for(auto & group : images)
 		for(auto & image : group.second)
 			image.second->horizontalFlip();
@@ -352,6 +425,8 @@ void CAnimation::horizontalFlip()
 
 void CAnimation::verticalFlip()
 {
+	reloadEvictedFrames();
+
 	for(auto & group : images)
 		for(auto & image : group.second)
 			image.second->verticalFlip();
@@ -359,6 +434,8 @@ void CAnimation::verticalFlip()
 
 void CAnimation::playerColored(PlayerColor player)
 {
+	reloadEvictedFrames();
+
 	for(auto & group : images)
 		for(auto & image : group.second)
 			image.second->playerColored(player);
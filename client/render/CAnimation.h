@@ -17,6 +17,7 @@ VCMI_LIB_NAMESPACE_END
 
 class CDefFile;
 class IImage;
+class ImageCache;
 
 /// Class for handling animation
 class CAnimation
@@ -26,7 +27,11 @@ private:
 	std::map<size_t, std::vector <JsonNode> > source;
 
 	//bitmap[group][position], store objects with loaded bitmaps
-	std::map<size_t, std::map<size_t, std::shared_ptr<IImage> > > images;
+	//may be modified by image cache from const methods, see ImageCache
+	mutable std::map<size_t, std::map<size_t, std::shared_ptr<IImage> > > images;
+
+	//frames that were unloaded by image cache and will be loaded again on access
+	mutable std::set<std::pair<size_t, size_t>> evictedFrames;
 
 	//animation file name
 	std::string name;
@@ -36,7 +41,16 @@ private:
 	std::shared_ptr<CDefFile> defFile;
 
 	//loader, will be called by load(), require opened def file for loading from it. Returns true if image is loaded
-	bool loadFrame(size_t frame, size_t group);
+	bool loadFrame(size_t frame, size_t group) const;
+
+	//frees memory used by frame that is not in use, frame that is in use again is returned to image cache
+	void evictFrame(size_t frame, size_t group) const;
+
+	//unloads frames that image cache has scheduled for unloading
+	void applyPendingEvictions() const;
+
+	//loads all frames unloaded by image cache, used before applying transformation to whole animation
+	void reloadEvictedFrames() const;
 
 	//unloadFrame, returns true if image has been unloaded ( either deleted or decreased refCount)
 	bool unloadFrame(size_t frame, size_t group);
@@ -50,7 +64,9 @@ private:
 
 	//not a very nice method to get image from another def file
 	//TODO: remove after implementing resource manager
-	std::shared_ptr<IImage> getFromExtraDef(std::string filename);
+	std::shared_ptr<IImage> getFromExtraDef(std::string filename) const;
+
+	friend class ImageCache;
 
 public:
 	CAnimation(std::string Name);
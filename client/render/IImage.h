@@ -64,6 +64,12 @@ public:
 	int width() const;
 	int height() const;
 
+	//size of pixel data of this image, in bytes
+	virtual size_t getMemoryUsage() const = 0;
+
+	//true if image was changed after loading and can not be restored by loading it again
+	virtual bool isModified() const = 0;
+
 	//only indexed bitmaps, 16 colors maximum
 	virtual void shiftPalette(uint32_t firstColorID, uint32_t colorsToMove, uint32_t distanceToMove) = 0;
 	virtual void adjustPalette(const ColorFilter & shifter, uint32_t colorsToSkipMask) = 0;
@@ -0,0 +1,196 @@
+/*
+ * ImageCache.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "ImageCache.h"
+
+#include "CAnimation.h"
+#include "IImage.h"
+
+#include "../../lib/CConfigHandler.h"
+
+ImageCache & ImageCache::get()
+{
+	static ImageCache instance;
+	return instance;
+}
+
+ImageCache::ImageCache()
+{
+	statistics.budgetBytes = settings["video"]["imageCacheLimit"].Integer() * 1024 * 1024;
+}
+
+void ImageCache::setBudget(size_t bytes)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	statistics.budgetBytes = bytes;
+	trim();
+}
+
+void ImageCache::addEntry(const TKey & key, const std::shared_ptr<IImage> & image)
+{
+	removeEntry(key);
+
+	size_t bytes = image->getMemoryUsage();
+
+	lru.push_front({key, image, bytes});
+	entries[key] = lru.begin();
+
+	statistics.residentBytes += bytes;
+	statistics.residentImages++;
+}
+
+void ImageCache::removeEntry(const TKey & key)
+{
+	auto pending = pendingEvictions.find(std::get<0>(key));
+	if(pending != pendingEvictions.end())
+	{
+		pending->second.erase(std::make_pair(std::get<1>(key), std::get<2>(key)));
+		if(pending->second.empty())
+			pendingEvictions.erase(pending);
+	}
+
+	auto it = entries.find(key);
+	if(it == entries.end())
+		return;
+
+	statistics.residentBytes -= it->second->bytes;
+	statistics.residentImages--;
+	lru.erase(it->second);
+	entries.erase(it);
+}
+
+void ImageCache::registerImage(const CAnimation * owner, size_t frame, size_t group, const std::shared_ptr<IImage> & image)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	addEntry(TKey(owner, group, frame), image);
+	statistics.misses++;
+
+	trim();
+}
+
+void ImageCache::restoreImage(const CAnimation * owner, size_t frame, size_t group, const std::shared_ptr<IImage> & image)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	addEntry(TKey(owner, group, frame), image);
+
+	trim();
+}
+
+void ImageCache::touchImage(const CAnimation * owner, size_t frame, size_t group)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	auto it = entries.find(TKey(owner, group, frame));
+	if(it == entries.end())
+		return;
+
+	statistics.hits++;
+	lru.splice(lru.begin(), lru, it->second);
+}
+
+void ImageCache::unregisterImage(const CAnimation * owner, size_t frame, size_t group)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	removeEntry(TKey(owner, group, frame));
+}
+
+void ImageCache::unregisterAnimation(const CAnimation * owner)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	pendingEvictions.erase(owner);
+
+	auto it = entries.lower_bound(TKey(owner, 0, 0));
+	while(it != entries.end() && std::get<0>(it->first) == owner)
+	{
+		statistics.residentBytes -= it->second->bytes;
+		statistics.residentImages--;
+		lru.erase(it->second);
+		it = entries.erase(it);
+	}
+}
+
+std::set<std::pair<size_t, size_t>> ImageCache::takePendingEvictions(const CAnimation * owner)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	std::set<std::pair<size_t, size_t>> result;
+
+	auto it = pendingEvictions.find(owner);
+	if(it != pendingEvictions.end())
+	{
+		result = std::move(it->second);
+		pendingEvictions.erase(it);
+	}
+
+	return result;
+}
+
+bool ImageCache::isEvictable(const Entry & entry) const
+{
+	auto image = entry.image.lock();
+
+	// expired entries are removed by their owners, nothing to free here
+	if(!image)
+		return false;
+
+	// one reference is held by owning animation and one by us right now, anything above means that image is in use
+	if(image.use_count() > 2)
+		return false;
+
+	// image can not be restored to its current state by loading it again
+	return !image->isModified();
+}
+
+void ImageCache::trim()
+{
+	if(statistics.budgetBytes == 0 || lru.empty())
+		return;
+
+	// most recently used frame is never evicted - it is the one that caller is loading right now
+	auto it = std::prev(lru.end());
+	while(statistics.residentBytes > statistics.budgetBytes && it != lru.begin())
+	{
+		auto current = it--;
+
+		if(!isEvictable(*current))
+			continue;
+
+		const CAnimation * owner = std::get<0>(current->key);
+		size_t group = std::get<1>(current->key);
+		size_t frame = std::get<2>(current->key);
+
+		statistics.evictions++;
+		statistics.residentBytes -= current->bytes;
+		statistics.residentImages--;
+		entries.erase(current->key);
+		lru.erase(current);
+
+		// animation may be in use by another thread, it unloads the frame on its next access
+		pendingEvictions[owner].insert(std::make_pair(group, frame));
+	}
+}
+
+ImageCacheStatistics ImageCache::getStatistics() const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	return statistics;
+}
+
+void ImageCache::resetStatistics()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	statistics.hits = 0;
+	statistics.misses = 0;
+	statistics.evictions = 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * ImageCache.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+class CAnimation;
+class IImage;
+
+/// Counters collected by image cache, can be viewed using "imagecache" console command
+struct ImageCacheStatistics
+{
+	/// number of requests to already decoded frames
+	uint64_t hits = 0;
+	/// number of frames that had to be decoded
+	uint64_t misses = 0;
+	/// number of frames that were unloaded to fit into memory budget
+	uint64_t evictions = 0;
+
+	/// total size of pixel data of all decoded frames
+	size_t residentBytes = 0;
+	/// total number of decoded frames
+	size_t residentImages = 0;
+	/// memory budget, 0 if unlimited
+	size_t budgetBytes = 0;
+};
+
+/// Tracks all frames decoded by CAnimation objects and keeps their total size within configured memory budget
+/// When budget is exceeded, least recently used frames are scheduled for unloading and will be decoded again on next access
+/// Animations may be used by other threads, so frames are unloaded by owning animation itself on its next access
+/// Frames that are referenced outside of their animation (e.g. by widget on screen) or were modified after loading are never unloaded
+class ImageCache : boost::noncopyable
+{
+	using TKey = std::tuple<const CAnimation *, size_t, size_t>;
+
+	struct Entry
+	{
+		TKey key;
+		std::weak_ptr<IImage> image;
+		size_t bytes;
+	};
+
+	/// all tracked frames, most recently used frames are in front
+	std::list<Entry> lru;
+	std::map<TKey, std::list<Entry>::iterator> entries;
+	/// frames that are no longer tracked and should be unloaded by their animations, as (group, frame)
+	std::map<const CAnimation *, std::set<std::pair<size_t, size_t>>> pendingEvictions;
+
+	ImageCacheStatistics statistics;
+
+	mutable boost::mutex mx;
+
+	ImageCache();
+
+	void trim();
+	bool isEvictable(const Entry & entry) const;
+	void addEntry(const TKey & key, const std::shared_ptr<IImage> & image);
+	void removeEntry(const TKey & key);
+
+public:
+	static ImageCache & get();
+
+	/// changes memory budget and immediately unloads frames that no longer fit. 0 disables limit
+	void setBudget(size_t bytes);
+
+	/// called by animation when frame was decoded
+	void registerImage(const CAnimation * owner, size_t frame, size_t group, const std::shared_ptr<IImage> & image);
+	/// called by animation when frame scheduled for unloading is in use again and has to be kept
+	void restoreImage(const CAnimation * owner, size_t frame, size_t group, const std::shared_ptr<IImage> & image);
+	/// called by animation when frame was requested and is already decoded
+	void touchImage(const CAnimation * owner, size_t frame, size_t group);
+	/// called by animation when frame was unloaded
+	void unregisterImage(const CAnimation * owner, size_t frame, size_t group);
+	/// called by animation on destruction
+	void unregisterAnimation(const CAnimation * owner);
+	/// frames of animation that should be unloaded to fit into memory budget, as (group, frame)
+	std::set<std::pair<size_t, size_t>> takePendingEvictions(const CAnimation * owner);
+
+	ImageCacheStatistics getStatistics() const;
+	void resetStatistics();
+};
@@ -56,6 +56,8 @@ SDLImage::SDLImage(CDefFile * data, size_t frame, size_t group)
 	: surf(nullptr),
 	margins(0, 0),
 	fullSize(0, 0),
+	blitMode(EImageBlitMode::ALPHA),
+	modified(false),
 	originalPalette(nullptr)
 {
 	SDLImageLoader loader(this);
@@ -69,6 +71,8 @@ SDLImage::SDLImage(SDL_Surface * from, EImageBlitMode mode)
 	: surf(nullptr),
 	margins(0, 0),
 	fullSize(0, 0),
+	blitMode(mode),
+	modified(false),
 	originalPalette(nullptr)
 {
 	surf = from;
@@ -87,6 +91,8 @@ SDLImage::SDLImage(const JsonNode & conf, EImageBlitMode mode)
 	: surf(nullptr),
 	margins(0, 0),
 	fullSize(0, 0),
+	blitMode(mode),
+	modified(false),
 	originalPalette(nullptr)
 {
 	std::string filename = conf["file"].String();
@@ -122,6 +128,8 @@ SDLImage::SDLImage(std::string filename, EImageBlitMode mode)
 	: surf(nullptr),
 	margins(0, 0),
 	fullSize(0, 0),
+	blitMode(mode),
+	modified(false),
 	originalPalette(nullptr)
 {
 	surf = BitmapHandler::loadBitmap(filename);
@@ -225,11 +233,13 @@ void SDLImage::exportBitmap(const boost::filesystem::path& path) const
 
 void SDLImage::playerColored(PlayerColor player)
 {
+	modified = true;
 	graphics->blueToPlayersAdv(surf, player);
 }
 
 void SDLImage::setAlpha(uint8_t value)
 {
+	modified = true;
 	CSDL_Ext::setAlpha (surf, value);
 	if (value != 255)
 		SDL_SetSurfaceBlendMode(surf, SDL_BLENDMODE_BLEND);
@@ -237,6 +247,9 @@ void SDLImage::setAlpha(uint8_t value)
 
 void SDLImage::setBlitMode(EImageBlitMode mode)
 {
+	if (blitMode != mode)
+		modified = true;
+
 	blitMode = mode;
 
 	if (blitMode != EImageBlitMode::OPAQUE && surf->format->Amask != 0)
@@ -247,6 +260,7 @@ void SDLImage::setBlitMode(EImageBlitMode mode)
 
 void SDLImage::setFlagColor(PlayerColor player)
 {
+	modified = true;
 	if(player < PlayerColor::PLAYER_LIMIT || player==PlayerColor::NEUTRAL)
 		CSDL_Ext::setPlayerColor(surf, player);
 }
@@ -261,8 +275,22 @@ Point SDLImage::dimensions() const
 	return fullSize;
 }
 
+size_t SDLImage::getMemoryUsage() const
+{
+	if (surf == nullptr)
+		return 0;
+
+	return static_cast<size_t>(surf->pitch) * surf->h;
+}
+
+bool SDLImage::isModified() const
+{
+	return modified;
+}
+
 void SDLImage::horizontalFlip()
 {
+	modified = true;
 	margins.y = fullSize.y - surf->h - margins.y;
 
 	//todo: modify in-place
@@ -273,6 +301,7 @@ void SDLImage::horizontalFlip()
 
 void SDLImage::verticalFlip()
 {
+	modified = true;
 	margins.x = fullSize.x - surf->w - margins.x;
 
 	//todo: modify in-place
@@ -296,6 +325,7 @@ void SDLImage::savePalette()
 
 void SDLImage::shiftPalette(uint32_t firstColorID, uint32_t colorsToMove, uint32_t distanceToMove)
 {
+	modified = true;
 	if(surf->format->palette)
 	{
 		std::vector<SDL_Color> shifterColors(colorsToMove);
@@ -310,6 +340,7 @@ void SDLImage::shiftPalette(uint32_t firstColorID, uint32_t colorsToMove, uint32
 
 void SDLImage::adjustPalette(const ColorFilter & shifter, uint32_t colorsToSkipMask)
 {
+	modified = true;
 	if(originalPalette == nullptr)
 		return;
 
@@ -327,6 +358,7 @@ void SDLImage::adjustPalette(const ColorFilter & shifter, uint32_t colorsToSkipM
 
 void SDLImage::resetPalette()
 {
+	modified = true;
 	if(originalPalette == nullptr)
 		return;
 	
@@ -336,6 +368,7 @@ void SDLImage::resetPalette()
 
 void SDLImage::resetPalette( int colorID )
 {
+	modified = true;
 	if(originalPalette == nullptr)
 		return;
 
@@ -345,6 +378,7 @@ void SDLImage::resetPalette( int colorID )
 
 void SDLImage::setSpecialPallete(const IImage::SpecialPalette & specialPalette, uint32_t colorsToSkipMask)
 {
+	modified = true;
 	if(surf->format->palette)
 	{
 		size_t last = std::min<size_t>(specialPalette.size(), surf->format->palette->ncolors);
@@ -39,6 +39,9 @@ public:
 
 	EImageBlitMode blitMode;
 
+	//set by all methods that change image after loading
+	bool modified;
+
 public:
 	//Load image from def file
 	SDLImage(CDefFile *data, size_t frame, size_t group=0);
@@ -61,6 +64,8 @@ public:
 	void setFlagColor(PlayerColor player) override;
 	bool isTransparent(const Point & coords) const override;
 	Point dimensions() const override;
+	size_t getMemoryUsage() const override;
+	bool isModified() const override;
 
 	void horizontalFlip() override;
 	void verticalFlip() override;
@@ -8,10 +8,13 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 
 		${MAIN_LIB_DIR}/battle/AccessibilityInfo.cpp
 		${MAIN_LIB_DIR}/battle/BattleAction.cpp
+		${MAIN_LIB_DIR}/battle/BattleActionProcessor.cpp
 		${MAIN_LIB_DIR}/battle/BattleAttackInfo.cpp
 		${MAIN_LIB_DIR}/battle/BattleHex.cpp
+		${MAIN_LIB_DIR}/battle/BattleHexMask.cpp
 		${MAIN_LIB_DIR}/battle/BattleInfo.cpp
 		${MAIN_LIB_DIR}/battle/BattleProxy.cpp
+		${MAIN_LIB_DIR}/battle/BattleSimulator.cpp
 		${MAIN_LIB_DIR}/battle/BattleStateInfoForRetreat.cpp
 		${MAIN_LIB_DIR}/battle/CBattleInfoCallback.cpp
 		${MAIN_LIB_DIR}/battle/CBattleInfoEssentials.cpp
@@ -22,6 +25,7 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/battle/DamageCalculator.cpp
 		${MAIN_LIB_DIR}/battle/Destination.cpp
 		${MAIN_LIB_DIR}/battle/IBattleState.cpp
+		${MAIN_LIB_DIR}/battle/ReachabilityCache.cpp
 		${MAIN_LIB_DIR}/battle/ReachabilityInfo.cpp
 		${MAIN_LIB_DIR}/battle/SideInBattle.cpp
 		${MAIN_LIB_DIR}/battle/SiegeInfo.cpp
@@ -129,6 +133,9 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/serializer/JsonSerializeFormat.cpp
 		${MAIN_LIB_DIR}/serializer/JsonSerializer.cpp
 		${MAIN_LIB_DIR}/serializer/JsonUpdater.cpp
+		${MAIN_LIB_DIR}/serializer/PackJournal.cpp
+		${MAIN_LIB_DIR}/serializer/PackRecording.cpp
+		${MAIN_LIB_DIR}/serializer/PackStatistics.cpp
 		${MAIN_LIB_DIR}/serializer/ILICReader.cpp
 
 		${MAIN_LIB_DIR}/spells/AbilityCaster.cpp
@@ -165,6 +172,7 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 
 		${MAIN_LIB_DIR}/vstd/StringUtils.cpp
 
+		${MAIN_LIB_DIR}/AIBenchmark.cpp
 		${MAIN_LIB_DIR}/BasicTypes.cpp
 		${MAIN_LIB_DIR}/BattleFieldHandler.cpp
 		${MAIN_LIB_DIR}/CAndroidVMHelper.cpp
@@ -200,6 +208,7 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/LogicalExpression.cpp
 		${MAIN_LIB_DIR}/NetPacksLib.cpp
 		${MAIN_LIB_DIR}/ObstacleHandler.cpp
+		${MAIN_LIB_DIR}/Profiler.cpp
 		${MAIN_LIB_DIR}/StartInfo.cpp
 		${MAIN_LIB_DIR}/ResourceSet.cpp
 		${MAIN_LIB_DIR}/RiverHandler.cpp
@@ -270,11 +279,14 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 
 		${MAIN_LIB_DIR}/battle/AccessibilityInfo.h
 		${MAIN_LIB_DIR}/battle/BattleAction.h
+		${MAIN_LIB_DIR}/battle/BattleActionProcessor.h
 		${MAIN_LIB_DIR}/battle/BattleAttackInfo.h
 		${MAIN_LIB_DIR}/battle/BattleHex.h
+		${MAIN_LIB_DIR}/battle/BattleHexMask.h
 		${MAIN_LIB_DIR}/battle/BattleInfo.h
 		${MAIN_LIB_DIR}/battle/BattleStateInfoForRetreat.h
 		${MAIN_LIB_DIR}/battle/BattleProxy.h
+		${MAIN_LIB_DIR}/battle/BattleSimulator.h
 		${MAIN_LIB_DIR}/battle/CBattleInfoCallback.h
 		${MAIN_LIB_DIR}/battle/CBattleInfoEssentials.h
 		${MAIN_LIB_DIR}/battle/CCallbackBase.h
@@ -287,6 +299,7 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/battle/IBattleState.h
 		${MAIN_LIB_DIR}/battle/IUnitInfo.h
 		${MAIN_LIB_DIR}/battle/PossiblePlayerBattleAction.h
+		${MAIN_LIB_DIR}/battle/ReachabilityCache.h
 		${MAIN_LIB_DIR}/battle/ReachabilityInfo.h
 		${MAIN_LIB_DIR}/battle/SideInBattle.h
 		${MAIN_LIB_DIR}/battle/SiegeInfo.h
@@ -395,6 +408,9 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/serializer/JsonSerializeFormat.h
 		${MAIN_LIB_DIR}/serializer/JsonSerializer.h
 		${MAIN_LIB_DIR}/serializer/JsonUpdater.h
+		${MAIN_LIB_DIR}/serializer/PackJournal.h
+		${MAIN_LIB_DIR}/serializer/PackRecording.h
+		${MAIN_LIB_DIR}/serializer/PackStatistics.h
 		${MAIN_LIB_DIR}/serializer/ILICReader.h
 		${MAIN_LIB_DIR}/serializer/Cast.h
 
@@ -430,6 +446,7 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/spells/effects/RemoveObstacle.h
 		${MAIN_LIB_DIR}/spells/effects/Sacrifice.h
 
+		${MAIN_LIB_DIR}/AIBenchmark.h
 		${MAIN_LIB_DIR}/AI_Base.h
 		${MAIN_LIB_DIR}/BattleFieldHandler.h
 		${MAIN_LIB_DIR}/CAndroidVMHelper.h
@@ -482,6 +499,7 @@ macro(add_main_lib TARGET_NAME LIBRARY_TYPE)
 		${MAIN_LIB_DIR}/ObstacleHandler.h
 		${MAIN_LIB_DIR}/PathfinderUtil.h
 		${MAIN_LIB_DIR}/Point.h
+		${MAIN_LIB_DIR}/Profiler.h
 		${MAIN_LIB_DIR}/Rect.h
 		${MAIN_LIB_DIR}/Rect.cpp
 		${MAIN_LIB_DIR}/ResourceSet.h
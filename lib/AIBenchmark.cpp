@@ -0,0 +1,188 @@
+/*
+ * AIBenchmark.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "AIBenchmark.h"
+
+#include "JsonNode.h"
+
+#ifdef VCMI_WINDOWS
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+JsonNode AITurnReport::toJson() const
+{
+	JsonNode result;
+
+	result["player"].String() = player.getStr();
+	result["ai"].String() = ai;
+	result["day"].Integer() = day;
+	result["turnTime"].Integer() = turnTime;
+	result["pathfinderNodes"].Integer() = pathfinderNodes;
+
+	for(auto & section : sections)
+		result["sections"][section.first].Integer() = section.second;
+
+	for(auto & counter : counters)
+		result["counters"][counter.first].Integer() = counter.second;
+
+	return result;
+}
+
+AIBenchmark & AIBenchmark::get()
+{
+	static AIBenchmark instance;
+	return instance;
+}
+
+AIBenchmark::AIBenchmark()
+	: active(false), daysLeft(0), seed(0)
+{
+}
+
+void AIBenchmark::start(int days, uint32_t randomSeed)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	active = true;
+	daysLeft = days;
+	seed = randomSeed;
+	turns.clear();
+}
+
+bool AIBenchmark::isActive() const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	return active;
+}
+
+std::optional<uint32_t> AIBenchmark::getRandomSeed() const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(!active)
+		return std::nullopt;
+
+	return seed;
+}
+
+void AIBenchmark::addTurn(const AITurnReport & turn)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(active)
+		turns.push_back(turn);
+}
+
+void AIBenchmark::addToTurn(const AITurnReport & turn)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(!active)
+		return;
+
+	auto existing = std::find_if(turns.begin(), turns.end(), [&](const AITurnReport & other) -> bool
+	{
+		return other.player == turn.player && other.ai == turn.ai && other.day == turn.day;
+	});
+
+	if(existing == turns.end())
+	{
+		turns.push_back(turn);
+		return;
+	}
+
+	existing->turnTime += turn.turnTime;
+	existing->pathfinderNodes += turn.pathfinderNodes;
+
+	for(auto & section : turn.sections)
+		existing->sections[section.first] += section.second;
+
+	for(auto & counter : turn.counters)
+		existing->counters[counter.first] += counter.second;
+}
+
+std::vector<AITurnReport> AIBenchmark::getTurns() const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	return turns;
+}
+
+bool AIBenchmark::dayPassed()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(!active)
+		return false;
+
+	return --daysLeft <= 0;
+}
+
+void AIBenchmark::save(const boost::filesystem::path & file, const std::string & runName) const
+{
+	JsonNode report;
+
+	if(boost::filesystem::exists(file))
+	{
+		boost::filesystem::ifstream input(file, std::ios::binary);
+		std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		report = JsonNode(data.data(), data.size());
+	}
+
+	JsonNode run;
+
+	run["name"].String() = runName;
+	run["seed"].Integer() = seed;
+	run["peakMemory"].Integer() = getPeakMemoryUsage();
+	run["turns"].setType(JsonNode::JsonType::DATA_VECTOR);
+
+	{
+		boost::unique_lock<boost::mutex> lock(mx);
+
+		for(auto & turn : turns)
+			run["turns"].Vector().push_back(turn.toJson());
+	}
+
+	report["runs"].Vector().push_back(run);
+
+	boost::filesystem::ofstream output(file, std::ios::binary | std::ios::trunc);
+	output << report.toJson();
+
+	logGlobal->info("AI benchmark report for %s written to %s", runName, file.string());
+}
+
+uint64_t AIBenchmark::getPeakMemoryUsage()
+{
+#ifdef VCMI_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+
+	return 0;
+#else
+	struct rusage usage;
+
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+#ifdef VCMI_APPLE
+	return usage.ru_maxrss; // in bytes
+#else
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // in kilobytes
+#endif
+#endif
+}
+
+VCMI_LIB_NAMESPACE_END
@@ -0,0 +1,77 @@
+/*
+ * AIBenchmark.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "GameConstants.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+class JsonNode;
+
+/// Measurements of single turn made by adventure AI
+struct DLL_LINKAGE AITurnReport
+{
+	PlayerColor player;
+	std::string ai;
+	int day = 0;
+	/// time between start of turn and decision to end it, in ms
+	uint64_t turnTime = 0;
+	/// number of nodes that pathfinders of this AI took from their queues during turn
+	uint64_t pathfinderNodes = 0;
+	/// total time spent in named parts of turn, e.g. Nullkiller behaviors, in ms
+	std::map<std::string, uint64_t> sections;
+	/// AI specific counters, e.g. number of evaluated tasks
+	std::map<std::string, uint64_t> counters;
+
+	JsonNode toJson() const;
+};
+
+/// Collects AI turn measurements when client is started in benchmark mode (see --benchmark option)
+/// Client plays given number of days from loaded save and writes report with all turns made by AI players
+/// Thread-safe, reports are ignored if benchmark mode is not active
+class DLL_LINKAGE AIBenchmark : boost::noncopyable
+{
+	bool active;
+	int daysLeft;
+	uint32_t seed;
+	std::vector<AITurnReport> turns;
+
+	mutable boost::mutex mx;
+
+	AIBenchmark();
+
+public:
+	static AIBenchmark & get();
+
+	void start(int days, uint32_t randomSeed);
+	bool isActive() const;
+
+	/// seed that AI should use instead of random device to make benchmark runs reproducible
+	std::optional<uint32_t> getRandomSeed() const;
+
+	void addTurn(const AITurnReport & turn);
+	/// adds measurements to report of same player, AI and day, for AIs that report many times per turn
+	/// times, nodes, sections and counters are summed, report is added if there is none yet
+	void addToTurn(const AITurnReport & turn);
+
+	/// reports collected since start of benchmark
+	std::vector<AITurnReport> getTurns() const;
+
+	/// called on each new day, returns true when requested number of days was played
+	bool dayPassed();
+
+	/// appends results of this run to report file, creating it if needed
+	void save(const boost::filesystem::path & file, const std::string & runName) const;
+
+	/// peak resident memory of whole process in bytes, 0 if not supported on this platform
+	static uint64_t getPeakMemoryUsage();
+};
+
+VCMI_LIB_NAMESPACE_END
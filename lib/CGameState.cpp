@@ -34,9 +34,11 @@
 #include "GameConstants.h"
 #include "rmg/CMapGenerator.h"
 #include "CStopWatch.h"
+#include "Profiler.h"
 #include "mapping/CMapEditManager.h"
 #include "serializer/CTypeList.h"
 #include "serializer/CMemorySerializer.h"
+#include "serializer/PackStatistics.h"
 #include "VCMIDirs.h"
 
 VCMI_LIB_NAMESPACE_BEGIN
@@ -2087,6 +2089,8 @@ PlayerRelations::PlayerRelations CGameState::getPlayerRelations( PlayerColor col
 void CGameState::apply(CPack *pack)
 {
 	ui16 typ = typeList.getTypeID(pack);
+	PackStatistics::Scope scope(PackStatistics::EStage::APPLY, typ);
+	PROFILE_ZONE_DETAIL("CGameState::apply", typeid(*pack).name());
 	applier->getApplier(typ)->applyOnGS(this, pack);
 }
 
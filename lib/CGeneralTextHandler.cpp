@@ -260,15 +260,20 @@ void CGeneralTextHandler::readToVector(const std::string & sourceID, const std::
 	while (parser.endLine());
 }
 
+/// strings of maps that are being parsed by this thread, not yet merged to handler
+static thread_local CGeneralTextHandler::StringsCollector * threadCollector = nullptr;
+
 const std::string & CGeneralTextHandler::deserialize(const TextIdentifier & identifier) const
 {
-	if(stringsLocalizations.count(identifier.get()) == 0)
+	const auto & storage = threadCollector && threadCollector->strings.count(identifier.get()) ? threadCollector->strings : stringsLocalizations;
+
+	if(storage.count(identifier.get()) == 0)
 	{
 		logGlobal->error("Unable to find localization for string '%s'", identifier.get());
 		return identifier.get();
 	}
 
-	const auto & entry = stringsLocalizations.at(identifier.get());
+	const auto & entry = storage.at(identifier.get());
 
 	if (!entry.overrideValue.empty())
 		return entry.overrideValue;
@@ -282,9 +287,11 @@ void CGeneralTextHandler::registerString(const std::string & modContext, const T
 	assert(UID.get().find("..") == std::string::npos); // invalid identifier - there is section that was evaluated to empty string
 	//assert(stringsLocalizations.count(UID.get()) == 0); // registering already registered string?
 
-	if(stringsLocalizations.count(UID.get()) > 0)
+	auto & storage = threadCollector ? threadCollector->strings : stringsLocalizations;
+
+	if(storage.count(UID.get()) > 0)
 	{
-		auto & value = stringsLocalizations[UID.get()];
+		auto & value = storage[UID.get()];
 
 		if(value.baseLanguage.empty())
 		{
@@ -304,7 +311,7 @@ void CGeneralTextHandler::registerString(const std::string & modContext, const T
 		result.baseValue = localized;
 		result.modContext = modContext;
 
-		stringsLocalizations[UID.get()] = result;
+		storage[UID.get()] = result;
 	}
 }
 
@@ -322,6 +329,21 @@ void CGeneralTextHandler::registerStringOverride(const std::string & modContext,
 		entry.modContext = modContext;
 }
 
+void CGeneralTextHandler::setThreadCollector(StringsCollector * collector)
+{
+	threadCollector = collector;
+}
+
+void CGeneralTextHandler::mergeCollected(StringsCollector & collector)
+{
+	assert(threadCollector == nullptr);
+
+	for(const auto & entry : collector.strings)
+		registerString(entry.second.modContext, entry.first, entry.second.baseValue);
+
+	collector.strings.clear();
+}
+
 bool CGeneralTextHandler::validateTranslation(const std::string & language, const std::string & modContext, const JsonNode & config) const
 {
 	bool allPresent = true;
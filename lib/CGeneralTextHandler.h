@@ -158,6 +158,19 @@ public:
 	/// add selected string to internal storage as high-priority strings
 	void registerStringOverride(const std::string & modContext, const std::string & language, const TextIdentifier & UID, const std::string & localized);
 
+	/// Strings registered by thread that has collector set are stored in it instead of internal storage
+	/// Allows registering strings from several threads without locking, e.g. when lobby parses map headers in parallel
+	struct StringsCollector
+	{
+		std::unordered_map<std::string, StringState> strings;
+	};
+
+	/// sets collector of calling thread, nullptr to register strings directly again
+	static void setThreadCollector(StringsCollector * collector);
+
+	/// moves collected strings to internal storage, no other thread may access texts meanwhile
+	void mergeCollected(StringsCollector & collector);
+
 	// returns true if identifier with such name was registered, even if not translated to current language
 	// not required right now, can be added if necessary
 	// bool identifierExists( const std::string identifier) const;
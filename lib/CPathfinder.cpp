@@ -19,6 +19,7 @@
 #include "CConfigHandler.h"
 #include "CPlayerState.h"
 #include "PathfinderUtil.h"
+#include "Profiler.h"
 
 VCMI_LIB_NAMESPACE_BEGIN
 
@@ -303,6 +304,8 @@ CGPathNode * CPathfinder::topAndPop()
 
 void CPathfinder::calculatePaths()
 {
+	PROFILE_ZONE("CPathfinder::calculatePaths");
+
 	//logGlobal->info("Calculating paths for hero %s (adress  %d) of player %d", hero->name, hero , hero->tempOwner);
 
 	//initial tile - set cost on 0 and add to the queue
@@ -428,6 +431,7 @@ void CPathfinder::calculatePaths()
 		}
 	} //queue loop
 
+	config->nodeStorage->addExpandedNodes(counter);
 	logAi->trace("CPathfinder finished with %s iterations", std::to_string(counter));
 }
 
@@ -384,6 +384,9 @@ struct DLL_LINKAGE PathfinderOptions
 
 class DLL_LINKAGE INodeStorage
 {
+private:
+	std::atomic<uint64_t> expandedNodes{0};
+
 public:
 	using ELayer = EPathfindingLayer;
 
@@ -404,6 +407,18 @@ public:
 	virtual void commit(CDestinationNodeInfo & destination, const PathNodeInfo & source) = 0;
 
 	virtual void initialize(const PathfinderOptions & options, const CGameState * gs) = 0;
+
+	/// number of nodes that pathfinder has taken from its queue while filling this storage
+	/// storage may be filled by several threads at once, so counter is atomic
+	uint64_t getExpandedNodes() const
+	{
+		return expandedNodes.load(std::memory_order_relaxed);
+	}
+
+	void addExpandedNodes(uint64_t count)
+	{
+		expandedNodes.fetch_add(count, std::memory_order_relaxed);
+	}
 };
 
 class DLL_LINKAGE NodeStorage : public INodeStorage
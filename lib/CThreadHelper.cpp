@@ -9,6 +9,7 @@
  */
 #include "StdInc.h"
 #include "CThreadHelper.h"
+#include "Profiler.h"
 
 #ifdef VCMI_WINDOWS
 	#include <windows.h>
@@ -56,6 +57,8 @@ void CThreadHelper::processTasks()
 // NOTE: on *nix string will be trimmed to 16 symbols
 void setThreadName(const std::string &name)
 {
+	Profiler::get().setThreadName(name);
+
 #ifdef VCMI_WINDOWS
 #ifndef __GNUC__
 	//follows http://msdn.microsoft.com/en-us/library/xcb2z8hs.aspx
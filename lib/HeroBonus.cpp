@@ -24,6 +24,7 @@
 #include "CModHandler.h"
 #include "TerrainHandler.h"
 #include "StringConstants.h"
+#include "Profiler.h"
 #include "battle/BattleInfo.h"
 
 VCMI_LIB_NAMESPACE_BEGIN
@@ -968,6 +969,8 @@ TConstBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, co
 		// cache all bonus objects. Selector objects doesn't matter.
 		if (cachedLast != treeChanged)
 		{
+			PROFILE_ZONE("CBonusSystemNode::updateCachedBonuses");
+
 			BonusList allBonuses;
 			allBonuses.reserve(cachedBonuses.capacity()); //we assume we'll get about the same number of bonuses
 
@@ -1012,6 +1015,8 @@ TConstBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, co
 
 TConstBonusListPtr CBonusSystemNode::getAllBonusesWithoutCaching(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root) const
 {
+	PROFILE_ZONE("CBonusSystemNode::getAllBonusesWithoutCaching");
+
 	auto ret = std::make_shared<BonusList>();
 
 	// Get bonus results without caching enabled.
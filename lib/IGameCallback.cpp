@@ -23,6 +23,7 @@
 #include "serializer/BinaryDeserializer.h"
 #include "serializer/BinarySerializer.h"
 #include "serializer/CLoadIntegrityValidator.h"
+#include "serializer/PackRecording.h"
 #include "rmg/CMapGenOptions.h"
 #include "mapping/CCampaignHandler.h"
 #include "mapObjects/CObjectClassesHandler.h"
@@ -31,6 +32,7 @@
 #include "mapping/CMap.h"
 #include "CPlayerState.h"
 #include "GameSettings.h"
+#include "Profiler.h"
 #include "ScriptHandler.h"
 #include "RoadHandler.h"
 #include "RiverHandler.h"
@@ -184,6 +186,7 @@ CGameState * CPrivilegedInfoCallback::gameState()
 template<typename Loader>
 void CPrivilegedInfoCallback::loadCommonState(Loader & in)
 {
+	PROFILE_ZONE("CPrivilegedInfoCallback::loadCommonState");
 	logGlobal->info("Loading lib part of game...");
 	in.checkMagicBytes(SAVEGAME_MAGIC);
 
@@ -206,6 +209,7 @@ void CPrivilegedInfoCallback::loadCommonState(Loader & in)
 template<typename Saver>
 void CPrivilegedInfoCallback::saveCommonState(Saver & out) const
 {
+	PROFILE_ZONE("CPrivilegedInfoCallback::saveCommonState");
 	logGlobal->info("Saving lib part of game...");
 	out.putMagicBytes(SAVEGAME_MAGIC);
 	logGlobal->info("\tSaving header");
@@ -222,6 +226,7 @@ void CPrivilegedInfoCallback::saveCommonState(Saver & out) const
 template DLL_LINKAGE void CPrivilegedInfoCallback::loadCommonState<CLoadIntegrityValidator>(CLoadIntegrityValidator &);
 template DLL_LINKAGE void CPrivilegedInfoCallback::loadCommonState<CLoadFile>(CLoadFile &);
 template DLL_LINKAGE void CPrivilegedInfoCallback::saveCommonState<CSaveFile>(CSaveFile &) const;
+template DLL_LINKAGE void CPrivilegedInfoCallback::saveCommonState<PackCheckpoint>(PackCheckpoint &) const;
 
 TerrainTile * CNonConstInfoCallback::getTile(const int3 & pos)
 {
@@ -2191,7 +2191,7 @@ void BattleTriggerEffect::applyGs(CGameState * gs) const
 void BattleUpdateGateState::applyGs(CGameState * gs) const
 {
 	if(gs->curB)
-		gs->curB->si.gateState = state;
+		gs->curB->setGateState(state);
 }
 
 void BattleResultAccepted::applyGs(CGameState * gs) const
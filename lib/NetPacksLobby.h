@@ -39,6 +39,8 @@ struct DLL_LINKAGE LobbyClientConnected : public CLobbyPackToPropagate
 	std::string uuid;
 	std::vector<std::string> names;
 	StartInfo::EMode mode = StartInfo::INVALID;
+	// Set by client that reconnects during game and still has its game state, number of gameplay packs it has received
+	std::optional<ui64> receivedPacks;
 	// Changed by server before announcing pack
 	int clientId = -1;
 	int hostClientId = -1;
@@ -50,6 +52,7 @@ struct DLL_LINKAGE LobbyClientConnected : public CLobbyPackToPropagate
 		h & uuid;
 		h & names;
 		h & mode;
+		h & receivedPacks;
 
 		h & clientId;
 		h & hostClientId;
@@ -118,12 +121,15 @@ struct DLL_LINKAGE LobbyStartGame : public CLobbyPackToPropagate
 	std::shared_ptr<StartInfo> initializedStartInfo = nullptr;
 	CGameState * initializedGameState = nullptr;
 	int clientId = -1; //-1 means to all clients
+	// Client keeps its game state, packs it has missed follow this pack
+	bool resync = false;
 
 	virtual void visitTyped(ICPackVisitor & visitor) override;
 
 	template <typename Handler> void serialize(Handler &h, const int version)
 	{
 		h & clientId;
+		h & resync;
 		h & initializedStartInfo;
 		bool sps = h.smartPointerSerialization;
 		h.smartPointerSerialization = true;
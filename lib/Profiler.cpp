@@ -0,0 +1,195 @@
+/*
+ * Profiler.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "Profiler.h"
+
+#include "VCMIDirs.h"
+
+#include <boost/core/demangle.hpp>
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+std::atomic<bool> Profiler::running{false};
+
+static void writeJsonString(std::ostream & out, const std::string & value)
+{
+	out << '"';
+	for(char c : value)
+	{
+		if(c == '"' || c == '\\')
+			out << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+			out << boost::format("\\u%04x") % static_cast<int>(c);
+		else
+			out << c;
+	}
+	out << '"';
+}
+
+Profiler::Profiler():
+	epoch(Clock::now())
+{
+}
+
+Profiler & Profiler::get()
+{
+	static Profiler instance;
+	return instance;
+}
+
+void Profiler::start()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	//zones of threads that already finished are only referenced from here
+	vstd::erase_if(threads, [](const std::shared_ptr<ThreadZones> & thread)
+	{
+		return thread.use_count() == 1;
+	});
+
+	for(auto & thread : threads)
+	{
+		boost::unique_lock<boost::mutex> threadLock(thread->mx);
+		thread->zones.clear();
+		thread->droppedZones = 0;
+	}
+
+	running = true;
+	logGlobal->info("Profiler started");
+}
+
+void Profiler::stop()
+{
+	running = false;
+	logGlobal->info("Profiler stopped, %d zones recorded", zonesCount());
+}
+
+Profiler::ThreadZones & Profiler::currentThread()
+{
+	static thread_local std::shared_ptr<ThreadZones> thread;
+
+	if(!thread)
+	{
+		thread = std::make_shared<ThreadZones>();
+
+		boost::unique_lock<boost::mutex> lock(mx);
+		thread->id = ++threadsRegistered;
+		threads.push_back(thread);
+	}
+
+	return *thread;
+}
+
+void Profiler::recordZone(const char * name, const char * detail, Clock::time_point start, Clock::time_point end)
+{
+	auto & thread = currentThread();
+	boost::unique_lock<boost::mutex> lock(thread.mx);
+
+	if(thread.zones.size() >= MAX_ZONES_PER_THREAD)
+	{
+		thread.droppedZones++;
+		return;
+	}
+
+	Zone zone;
+	zone.name = name;
+	zone.detail = detail;
+	zone.start = std::chrono::duration_cast<std::chrono::microseconds>(start - epoch).count();
+	zone.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	thread.zones.push_back(zone);
+}
+
+void Profiler::setThreadName(const std::string & name)
+{
+	auto & thread = currentThread();
+	boost::unique_lock<boost::mutex> lock(thread.mx);
+	thread.name = name;
+}
+
+size_t Profiler::zonesCount() const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	size_t ret = 0;
+	for(const auto & thread : threads)
+	{
+		boost::unique_lock<boost::mutex> threadLock(thread->mx);
+		ret += thread->zones.size();
+	}
+	return ret;
+}
+
+void Profiler::writeTrace(std::ostream & out) const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	//details are mostly names of types, demangle each of them only once
+	std::map<const char *, std::string> details;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+
+	for(const auto & thread : threads)
+	{
+		boost::unique_lock<boost::mutex> threadLock(thread->mx);
+
+		if(!first)
+			out << ",";
+		first = false;
+
+		out << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread->id << ",\"args\":{\"name\":";
+		writeJsonString(out, thread->name.empty() ? "Thread " + std::to_string(thread->id) : thread->name);
+		out << "}}";
+
+		for(const auto & zone : thread->zones)
+		{
+			out << ",\n{\"ph\":\"X\",\"name\":";
+			writeJsonString(out, zone.name);
+			out << ",\"pid\":1,\"tid\":" << thread->id << ",\"ts\":" << zone.start << ",\"dur\":" << zone.duration;
+
+			if(zone.detail)
+			{
+				auto detail = details.find(zone.detail);
+				if(detail == details.end())
+					detail = details.emplace(zone.detail, boost::core::demangle(zone.detail)).first;
+
+				out << ",\"args\":{\"detail\":";
+				writeJsonString(out, detail->second);
+				out << "}";
+			}
+			out << "}";
+		}
+
+		if(thread->droppedZones)
+			logGlobal->warn("Profiler: %d zones of thread %s were dropped", thread->droppedZones, thread->name);
+	}
+
+	out << "\n]}\n";
+}
+
+boost::filesystem::path Profiler::saveTrace(const std::string & prefix) const
+{
+	const auto directory = VCMIDirs::get().userDataPath() / "Profiles";
+	const auto time = boost::posix_time::second_clock::local_time();
+	const auto path = directory / (prefix + "_" + boost::posix_time::to_iso_string(time) + ".json");
+
+	boost::filesystem::create_directories(directory);
+
+	std::ofstream file(path.string(), std::ios::trunc);
+	writeTrace(file);
+
+	if(!file.good())
+		throw std::runtime_error("Failed to write profiler trace to " + path.string());
+
+	logGlobal->info("Profiler trace saved to %s", path.string());
+	return path;
+}
+
+VCMI_LIB_NAMESPACE_END
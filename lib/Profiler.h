@@ -0,0 +1,111 @@
+/*
+ * Profiler.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+/// Records nested zones of all threads and writes them in Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+/// While profiler is not running each zone only costs a single relaxed atomic load
+class DLL_LINKAGE Profiler : boost::noncopyable
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+
+	/// further zones of thread are dropped once it recorded this many of them
+	static constexpr size_t MAX_ZONES_PER_THREAD = 1 << 20;
+
+	static Profiler & get();
+
+	static bool isRunning()
+	{
+		return running.load(std::memory_order_relaxed);
+	}
+
+	/// discards zones recorded so far and starts recording new ones
+	void start();
+	void stop();
+
+	/// zone that ended in calling thread, name and detail must remain valid until trace is written
+	void recordZone(const char * name, const char * detail, Clock::time_point start, Clock::time_point end);
+	/// name of calling thread shown in trace
+	void setThreadName(const std::string & name);
+
+	size_t zonesCount() const;
+
+	void writeTrace(std::ostream & out) const;
+	/// writes trace into Profiles directory in user data, returns its path, throws std::runtime_error on failure
+	boost::filesystem::path saveTrace(const std::string & prefix) const;
+
+private:
+	struct Zone
+	{
+		const char * name;
+		const char * detail;
+		/// microseconds since start of profiler
+		ui64 start;
+		ui64 duration;
+	};
+
+	struct ThreadZones
+	{
+		ui32 id = 0;
+		std::string name;
+		std::vector<Zone> zones;
+		size_t droppedZones = 0;
+		mutable boost::mutex mx;
+	};
+
+	static std::atomic<bool> running;
+
+	const Clock::time_point epoch;
+
+	mutable boost::mutex mx;
+	std::vector<std::shared_ptr<ThreadZones>> threads;
+	ui32 threadsRegistered = 0;
+
+	Profiler();
+
+	ThreadZones & currentThread();
+};
+
+/// Zone that lasts until end of its scope, see PROFILE_ZONE
+class ProfilerZone : boost::noncopyable
+{
+	const char * name;
+	const char * detail;
+	bool active;
+	Profiler::Clock::time_point start;
+
+public:
+	explicit ProfilerZone(const char * name, const char * detail = nullptr):
+		name(name),
+		detail(detail),
+		active(Profiler::isRunning())
+	{
+		if(active)
+			start = Profiler::Clock::now();
+	}
+
+	~ProfilerZone()
+	{
+		if(active)
+			Profiler::get().recordZone(name, detail, start, Profiler::Clock::now());
+	}
+};
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+/// Measures time from this point until end of current scope, name must be string literal
+#define PROFILE_ZONE(name) ProfilerZone PROFILER_CONCAT(profilerZone, __LINE__)(name)
+/// Same as PROFILE_ZONE, detail is shown as argument of zone and must outlive profiler too, e.g. name from std::type_info
+#define PROFILE_ZONE_DETAIL(name, detail) ProfilerZone PROFILER_CONCAT(profilerZone, __LINE__)(name, detail)
+
+VCMI_LIB_NAMESPACE_END
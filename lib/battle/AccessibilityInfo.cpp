@@ -50,4 +50,21 @@ bool AccessibilityInfo::accessible(BattleHex tile, bool doubleWide, ui8 side) co
 	return true;
 }
 
+BattleHexMask AccessibilityInfo::accessibleHexes(bool doubleWide, ui8 side) const
+{
+	BattleHexMask ret;
+
+	for(si16 hex = 0; hex < GameConstants::BFIELD_SIZE; hex++)
+	{
+		if(tileAccessibleWithGate(hex, side))
+			ret.set(hex);
+	}
+
+	// second tile of double wide unit is located directly before or after its position, see battle::Unit::occupiedHex
+	if(doubleWide)
+		ret &= ret.shifted(side == BattleSide::ATTACKER ? 1 : -1);
+
+	return ret;
+}
+
 VCMI_LIB_NAMESPACE_END
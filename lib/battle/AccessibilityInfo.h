@@ -9,6 +9,7 @@
  */
 #pragma once
 #include "BattleHex.h"
+#include "BattleHexMask.h"
 #include "../GameConstants.h"
 
 VCMI_LIB_NAMESPACE_BEGIN
@@ -38,6 +39,7 @@ struct DLL_LINKAGE AccessibilityInfo : TAccessibilityArray
 	public:
 		bool accessible(BattleHex tile, const battle::Unit * stack) const; //checks for both tiles if stack is double wide
 		bool accessible(BattleHex tile, bool doubleWide, ui8 side) const; //checks for both tiles if stack is double wide
+		BattleHexMask accessibleHexes(bool doubleWide, ui8 side) const; //all tiles for which accessible() returns true
 	private:
 		bool tileAccessibleWithGate(BattleHex tile, ui8 side) const;
 };
@@ -0,0 +1,85 @@
+/*
+ * BattleActionProcessor.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "BattleHex.h"
+#include "Destination.h"
+#include "../GameSettings.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+class BattleAction;
+class BattleInfo;
+class CRandomGenerator;
+class CStack;
+class SpellCastEnvironment;
+struct BattleAttack;
+struct BattleLogMessage;
+
+namespace battle
+{
+	class CUnitState;
+}
+
+/// Battle rules for actions of creatures, shared by server and battle simulator
+/// All changes of battle state are made by packs passed to environment
+class DLL_LINKAGE BattleActionProcessor : boost::noncopyable
+{
+public:
+	BattleActionProcessor(BattleInfo * battle, SpellCastEnvironment * env, CRandomGenerator & rand);
+	virtual ~BattleActionProcessor() = default;
+
+	/// Makes wait, defend, movement, attack, shot or creature spell action, wrapped in StartAction and EndAction
+	/// Action must be already validated to be about active stack, returns false if action is invalid
+	bool makeAction(const BattleAction & ba);
+
+	/// true if luck or morale of given value takes effect, dice sizes are taken from game settings
+	bool rollDice(EGameSettings dice, int value);
+	/// unit with negative morale loses its turn
+	bool rollBadMorale(const CStack * stack);
+	/// unit with positive morale gets extra turn after its action, at most once per round
+	bool rollGoodMorale(const CStack * stack);
+
+	/// regeneration at the beginning of unit turn
+	void regenerate(const CStack * stack);
+
+	/// walks unit to destination along its path, opening gates and triggering obstacles on the way
+	/// returns travelled distance
+	int moveStack(const CStack * stack, BattleHex dest);
+
+	void makeAttack(const CStack * attacker, const CStack * defender, int distance, BattleHex targetHex, bool first, bool ranged, bool counter);
+
+	/// opens or closes siege gate depending on units standing on it
+	void updateGateState();
+
+	static void addGenericKilledLog(BattleLogMessage & blm, const CStack * defender, int32_t killed, bool multiple);
+
+protected:
+	BattleInfo * battle;
+	SpellCastEnvironment * env;
+	CRandomGenerator & rand;
+
+	/// spells cast by attacker before and after attack, not used by default
+	virtual void beforeAttack(bool ranged, const CStack * attacker, const CStack * defender);
+	virtual void afterAttack(bool ranged, const CStack * attacker, const CStack * defender);
+
+private:
+	using FireShieldInfo = std::vector<std::pair<const CStack *, int64_t>>;
+
+	void defend(const CStack * stack);
+	bool meleeAttack(const CStack * stack, const battle::Target & target);
+	void shoot(const CStack * stack, const CStack * destinationStack, BattleHex destination);
+	void castCreatureSpell(const CStack * stack, const BattleAction & ba, const battle::Target & target);
+
+	// damage, drain life & fire shield; returns amount of drained life
+	int64_t applyBattleEffects(BattleAttack & bat, std::shared_ptr<battle::CUnitState> attackerState, FireShieldInfo & fireShield, const CStack * def, int distance, bool secondary);
+};
+
+VCMI_LIB_NAMESPACE_END
@@ -0,0 +1,231 @@
+/*
+ * BattleHexMask.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "BattleHexMask.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+static BattleHexMask makeMask(const std::function<bool(BattleHex)> & predicate)
+{
+	BattleHexMask ret;
+
+	for(si16 hex = 0; hex < GameConstants::BFIELD_SIZE; hex++)
+	{
+		if(predicate(hex))
+			ret.set(hex);
+	}
+
+	return ret;
+}
+
+static const BattleHexMask & evenRows()
+{
+	static const BattleHexMask mask = makeMask([](BattleHex hex){ return hex.getY() % 2 == 0; });
+	return mask;
+}
+
+static const BattleHexMask & oddRows()
+{
+	static const BattleHexMask mask = makeMask([](BattleHex hex){ return hex.getY() % 2 != 0; });
+	return mask;
+}
+
+BattleHexMask::BattleHexMask()
+{
+	words.fill(0);
+}
+
+const BattleHexMask & BattleHexMask::allHexes()
+{
+	static const BattleHexMask mask = makeMask([](BattleHex hex){ return true; });
+	return mask;
+}
+
+const BattleHexMask & BattleHexMask::sideColumns()
+{
+	static const BattleHexMask mask = makeMask([](BattleHex hex){ return hex.getX() == 0 || hex.getX() == GameConstants::BFIELD_WIDTH - 1; });
+	return mask;
+}
+
+const BattleHexMask & BattleHexMask::availableHexes()
+{
+	static const BattleHexMask mask = makeMask([](BattleHex hex){ return hex.isAvailable(); });
+	return mask;
+}
+
+void BattleHexMask::clearUnusedBits()
+{
+	const int usedBits = GameConstants::BFIELD_SIZE - (WORDS - 1) * BITS_PER_WORD;
+
+	if(usedBits < BITS_PER_WORD)
+		words[WORDS - 1] &= (ui64(1) << usedBits) - 1;
+}
+
+bool BattleHexMask::test(BattleHex hex) const
+{
+	if(!hex.isValid())
+		return false;
+
+	return (words[hex / BITS_PER_WORD] >> (hex % BITS_PER_WORD)) & 1;
+}
+
+void BattleHexMask::set(BattleHex hex)
+{
+	if(hex.isValid())
+		words[hex / BITS_PER_WORD] |= ui64(1) << (hex % BITS_PER_WORD);
+}
+
+void BattleHexMask::reset(BattleHex hex)
+{
+	if(hex.isValid())
+		words[hex / BITS_PER_WORD] &= ~(ui64(1) << (hex % BITS_PER_WORD));
+}
+
+bool BattleHexMask::any() const
+{
+	for(auto word : words)
+	{
+		if(word)
+			return true;
+	}
+
+	return false;
+}
+
+bool BattleHexMask::none() const
+{
+	return !any();
+}
+
+int BattleHexMask::count() const
+{
+	int ret = 0;
+
+	for(auto word : words)
+	{
+		for(; word; word &= word - 1)
+			ret++;
+	}
+
+	return ret;
+}
+
+BattleHexMask BattleHexMask::shifted(int offset) const
+{
+	BattleHexMask ret;
+
+	const int wordOffset = std::abs(offset) / BITS_PER_WORD;
+	const int bitOffset = std::abs(offset) % BITS_PER_WORD;
+
+	for(int i = 0; i < WORDS; i++)
+	{
+		// word of result is assembled from two neighbouring source words
+		int source = offset >= 0 ? i - wordOffset : i + wordOffset;
+		int carrySource = offset >= 0 ? source - 1 : source + 1;
+
+		ui64 value = 0;
+
+		if(source >= 0 && source < WORDS)
+			value = offset >= 0 ? words[source] << bitOffset : words[source] >> bitOffset;
+
+		if(bitOffset != 0 && carrySource >= 0 && carrySource < WORDS)
+			value |= offset >= 0 ? words[carrySource] >> (BITS_PER_WORD - bitOffset) : words[carrySource] << (BITS_PER_WORD - bitOffset);
+
+		ret.words[i] = value;
+	}
+
+	ret.clearUnusedBits();
+	return ret;
+}
+
+BattleHexMask BattleHexMask::neighbours() const
+{
+	// horizontal offset of neighbours in adjacent rows depends on parity of row, see BattleHex::moveInDirection
+	// neighbours that wrap around battlefield edge always end up in side columns and are removed together with them
+	const int width = GameConstants::BFIELD_WIDTH;
+
+	BattleHexMask even = *this & evenRows();
+	BattleHexMask odd = *this & oddRows();
+
+	BattleHexMask ret = shifted(-1) | shifted(1) | shifted(-width) | shifted(width);
+
+	ret |= odd.shifted(-width - 1) | odd.shifted(width - 1);
+	ret |= even.shifted(-width + 1) | even.shifted(width + 1);
+
+	return ret & availableHexes();
+}
+
+BattleHexMask BattleHexMask::operator~() const
+{
+	BattleHexMask ret;
+
+	for(int i = 0; i < WORDS; i++)
+		ret.words[i] = ~words[i];
+
+	ret.clearUnusedBits();
+	return ret;
+}
+
+BattleHexMask BattleHexMask::operator&(const BattleHexMask & other) const
+{
+	BattleHexMask ret(*this);
+	ret &= other;
+	return ret;
+}
+
+BattleHexMask BattleHexMask::operator|(const BattleHexMask & other) const
+{
+	BattleHexMask ret(*this);
+	ret |= other;
+	return ret;
+}
+
+BattleHexMask BattleHexMask::operator-(const BattleHexMask & other) const
+{
+	BattleHexMask ret(*this);
+	ret -= other;
+	return ret;
+}
+
+BattleHexMask & BattleHexMask::operator&=(const BattleHexMask & other)
+{
+	for(int i = 0; i < WORDS; i++)
+		words[i] &= other.words[i];
+
+	return *this;
+}
+
+BattleHexMask & BattleHexMask::operator|=(const BattleHexMask & other)
+{
+	for(int i = 0; i < WORDS; i++)
+		words[i] |= other.words[i];
+
+	return *this;
+}
+
+BattleHexMask & BattleHexMask::operator-=(const BattleHexMask & other)
+{
+	for(int i = 0; i < WORDS; i++)
+		words[i] &= ~other.words[i];
+
+	return *this;
+}
+
+bool BattleHexMask::operator==(const BattleHexMask & other) const
+{
+	return words == other.words;
+}
+
+bool BattleHexMask::operator!=(const BattleHexMask & other) const
+{
+	return words != other.words;
+}
+
+VCMI_LIB_NAMESPACE_END
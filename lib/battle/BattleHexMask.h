@@ -0,0 +1,65 @@
+/*
+ * BattleHexMask.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "BattleHex.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+/// Set of battlefield hexes stored as bitboard of three 64-bit words, bit index is equal to hex number
+/// Bits outside of battlefield are always zero
+class DLL_LINKAGE BattleHexMask
+{
+	static constexpr int BITS_PER_WORD = 64;
+	static constexpr int WORDS = (GameConstants::BFIELD_SIZE + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+	std::array<ui64, WORDS> words;
+
+	void clearUnusedBits();
+
+public:
+	BattleHexMask();
+
+	/// all hexes of battlefield
+	static const BattleHexMask & allHexes();
+	/// first and last column of battlefield
+	static const BattleHexMask & sideColumns();
+	/// all hexes except for side columns, see BattleHex::isAvailable
+	static const BattleHexMask & availableHexes();
+
+	bool test(BattleHex hex) const;
+	void set(BattleHex hex);
+	void reset(BattleHex hex);
+
+	bool any() const;
+	bool none() const;
+	int count() const;
+
+	/// moves every hex by given number of positions in hex numbering, hexes moved outside of battlefield are dropped
+	BattleHexMask shifted(int offset) const;
+
+	/// all hexes adjacent to any hex of this set, only hexes returned by BattleHex::neighbouringTiles are included
+	BattleHexMask neighbours() const;
+
+	BattleHexMask operator~() const;
+	BattleHexMask operator&(const BattleHexMask & other) const;
+	BattleHexMask operator|(const BattleHexMask & other) const;
+	/// hexes of this set that are not present in other set
+	BattleHexMask operator-(const BattleHexMask & other) const;
+
+	BattleHexMask & operator&=(const BattleHexMask & other);
+	BattleHexMask & operator|=(const BattleHexMask & other);
+	BattleHexMask & operator-=(const BattleHexMask & other);
+
+	bool operator==(const BattleHexMask & other) const;
+	bool operator!=(const BattleHexMask & other) const;
+};
+
+VCMI_LIB_NAMESPACE_END
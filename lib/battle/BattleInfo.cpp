@@ -65,6 +65,7 @@ CStack * BattleInfo::generateNewStack(uint32_t id, const CStackInstance & base,
 	auto * ret = new CStack(&base, owner, id, side, slot);
 	ret->initialPosition = getAvaliableHex(base.getCreatureID(), side, position); //TODO: what if no free tile on battlefield was found?
 	stacks.push_back(ret);
+	updateStateVersion();
 	return ret;
 }
 
@@ -74,6 +75,7 @@ CStack * BattleInfo::generateNewStack(uint32_t id, const CStackBasicDescriptor &
 	auto * ret = new CStack(&base, owner, id, side, slot);
 	ret->initialPosition = position;
 	stacks.push_back(ret);
+	updateStateVersion();
 	return ret;
 }
 
@@ -275,6 +277,7 @@ BattleInfo * BattleInfo::setupBattle(const int3 & tile, TerrainId terrain, const
 				obstPtr->ID = obidgen.getSuchNumber(appropriateAbsoluteObstacle);
 				obstPtr->uniqueID = static_cast<si32>(curB->obstacles.size());
 				curB->obstacles.push_back(obstPtr);
+				curB->updateStateVersion();
 
 				for(BattleHex blocked : obstPtr->getBlockedTiles())
 					blockedTiles.push_back(blocked);
@@ -328,6 +331,7 @@ BattleInfo * BattleInfo::setupBattle(const int3 & tile, TerrainId terrain, const
 				obstPtr->pos = posgenerator.getSuchNumber(validPosition);
 				obstPtr->uniqueID = static_cast<si32>(curB->obstacles.size());
 				curB->obstacles.push_back(obstPtr);
+				curB->updateStateVersion();
 
 				for(BattleHex blocked : obstPtr->getBlockedTiles())
 					blockedTiles.push_back(blocked);
@@ -522,6 +526,7 @@ BattleInfo * BattleInfo::setupBattle(const int3 & tile, TerrainId terrain, const
 			curB->tacticDistance = 0;
 	}
 
+	curB->updateStateVersion();
 	return curB;
 }
 
@@ -557,7 +562,8 @@ BattleInfo::BattleInfo():
 	tile(-1,-1,-1),
 	battlefieldType(BattleField::NONE),
 	tacticsSide(0),
-	tacticDistance(0)
+	tacticDistance(0),
+	stateVersion(makeStateVersion())
 {
 	setBattle(this);
 	setNodeType(BATTLE);
@@ -688,6 +694,16 @@ int64_t BattleInfo::getActualDamage(const DamageRange & damage, int32_t attacker
 	}
 }
 
+int64_t BattleInfo::getStateVersion() const
+{
+	return stateVersion;
+}
+
+void BattleInfo::updateStateVersion()
+{
+	stateVersion = makeStateVersion();
+}
+
 void BattleInfo::nextRound(int32_t roundNr)
 {
 	for(int i = 0; i < 2; ++i)
@@ -707,6 +723,8 @@ void BattleInfo::nextRound(int32_t roundNr)
 
 	for(auto & obst : obstacles)
 		obst->battleTurnPassed();
+
+	updateStateVersion();
 }
 
 void BattleInfo::nextTurn(uint32_t unitId)
@@ -734,6 +752,7 @@ void BattleInfo::addUnit(uint32_t id, const JsonNode & data)
 	stacks.push_back(ret);
 	ret->localInit(this);
 	ret->summoned = info.summoned;
+	updateStateVersion();
 }
 
 void BattleInfo::moveUnit(uint32_t id, BattleHex destination)
@@ -745,6 +764,7 @@ void BattleInfo::moveUnit(uint32_t id, BattleHex destination)
 		return;
 	}
 	sta->position = destination;
+	updateStateVersion();
 	//Bonuses can be limited by unit placement, so, change tree version 
 	//to force updating a bonus. TODO: update version only when such bonuses are present
 	CBonusSystemNode::treeHasChanged();
@@ -774,6 +794,7 @@ void BattleInfo::setUnitState(uint32_t id, const JsonNode & data, int64_t health
 
 	//applying changes
 	changedStack->load(data);
+	updateStateVersion();
 
 
 	if(healthDelta < 0)
@@ -856,6 +877,8 @@ void BattleInfo::removeUnit(uint32_t id)
 
 		ids.erase(toRemoveId);
 	}
+
+	updateStateVersion();
 }
 
 void BattleInfo::updateUnit(uint32_t id, const JsonNode & data)
@@ -952,6 +975,13 @@ void BattleInfo::addOrUpdateUnitBonus(CStack * sta, const Bonus & value, bool fo
 void BattleInfo::setWallState(EWallPart partOfWall, EWallState state)
 {
 	si.wallState[partOfWall] = state;
+	updateStateVersion();
+}
+
+void BattleInfo::setGateState(EGateState state)
+{
+	si.gateState = state;
+	updateStateVersion();
 }
 
 void BattleInfo::addObstacle(const ObstacleChanges & changes)
@@ -959,6 +989,7 @@ void BattleInfo::addObstacle(const ObstacleChanges & changes)
 	std::shared_ptr<SpellCreatedObstacle> obstacle = std::make_shared<SpellCreatedObstacle>();
 	obstacle->fromInfo(changes);
 	obstacles.push_back(obstacle);
+	updateStateVersion();
 }
 
 void BattleInfo::updateObstacle(const ObstacleChanges& changes)
@@ -975,6 +1006,7 @@ void BattleInfo::updateObstacle(const ObstacleChanges& changes)
 
 			// Currently we only support to update the "revealed" property
 			spellObstacle->revealed = changedObstacle->revealed;
+			updateStateVersion();
 
 			break;
 		}
@@ -988,6 +1020,7 @@ void BattleInfo::removeObstacle(uint32_t id)
 		if(obstacles[i]->uniqueID == id) //remove this obstacle
 		{
 			obstacles.erase(obstacles.begin() + i);
+			updateStateVersion();
 			break;
 		}
 	}
@@ -45,6 +45,8 @@ public:
 	ui8 tacticsSide; //which side is requested to play tactics phase
 	ui8 tacticDistance; //how many hexes we can go forward (1 = only hexes adjacent to margin line)
 
+	int64_t stateVersion; //runtime only, see getStateVersion
+
 	template <typename Handler> void serialize(Handler &h, const int version)
 	{
 		h & sides;
@@ -100,6 +102,8 @@ public:
 
 	int64_t getActualDamage(const DamageRange & damage, int32_t attackerCount, vstd::RNG & rng) const override;
 
+	int64_t getStateVersion() const override;
+
 	//////////////////////////////////////////////////////////////////////////
 	// IBattleState
 
@@ -124,6 +128,11 @@ public:
 
 	static void addOrUpdateUnitBonus(CStack * sta, const Bonus & value, bool forceAdd);
 
+	void setGateState(EGateState state);
+
+	/// must be called after any direct change of units or obstacles that affects accessibility of hexes
+	void updateStateVersion();
+
 	//////////////////////////////////////////////////////////////////////////
 	CStack * getStack(int stackID, bool onlyAlive = true);
 	using CBattleInfoEssentials::battleGetArmyObject;
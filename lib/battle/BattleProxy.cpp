@@ -113,5 +113,10 @@ const IBonusBearer * BattleProxy::getBonusBearer() const
 	return subject->getBonusBearer();
 }
 
+int64_t BattleProxy::getStateVersion() const
+{
+	return subject->battleGetStateVersion();
+}
+
 
 VCMI_LIB_NAMESPACE_END
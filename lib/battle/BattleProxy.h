@@ -51,6 +51,8 @@ public:
 	int32_t getEnchanterCounter(ui8 side) const override;
 
 	const IBonusBearer * getBonusBearer() const override;
+
+	int64_t getStateVersion() const override;
 protected:
 	Subject subject;
 };
@@ -0,0 +1,762 @@
+/*
+ * BattleSimulator.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "BattleSimulator.h"
+
+#include "BattleActionProcessor.h"
+#include "BattleInfo.h"
+#include "../CCreatureHandler.h"
+#include "../CModHandler.h"
+#include "../CRandomGenerator.h"
+#include "../CStack.h"
+#include "../GameSettings.h"
+#include "../JsonNode.h"
+#include "../NetPacks.h"
+#include "../NetPackVisitor.h"
+#include "../TerrainHandler.h"
+#include "../VCMI_Lib.h"
+#include "../mapObjects/CArmedInstance.h"
+#include "../spells/CSpellHandler.h"
+#include "../spells/ISpellMechanics.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+namespace
+{
+
+/// Bonus system nodes of creature types are shared by all battles, attaching to and detaching from them is not thread-safe
+boost::mutex bonusTreeMutex;
+
+const std::array<std::string, 2> sideNames = {"attacker", "defender"};
+
+/// Abilities that CGameHandler handles outside of shared battle rules: spells before and after attacks, on start of turn or battle
+const std::vector<Bonus::BonusType> unsupportedBonuses =
+{
+	Bonus::SPELL_BEFORE_ATTACK,
+	Bonus::SPELL_AFTER_ATTACK,
+	Bonus::DEATH_STARE,
+	Bonus::ACID_BREATH,
+	Bonus::TRANSMUTATION,
+	Bonus::DESTRUCTION,
+	Bonus::BONUS_DAMAGE_CHANCE,
+	Bonus::BIND_EFFECT,
+	Bonus::POISON,
+	Bonus::MANA_DRAIN,
+	Bonus::FEAR,
+	Bonus::ENCHANTER,
+	Bonus::ENCHANTED,
+	Bonus::SUMMON_GUARDIANS,
+	Bonus::OPENING_BATTLE_SPELL,
+	Bonus::ATTACKS_NEAREST_CREATURE
+};
+
+bool createsObstacles(const CSpell * spell)
+{
+	for(int32_t level = 0; level < GameConstants::SPELL_SCHOOL_LEVELS; level++)
+	{
+		for(const auto & effect : spell->getLevelInfo(level).battleEffects.Struct())
+		{
+			if(effect.second["type"].String() == "core:obstacle")
+				return true;
+		}
+	}
+	return false;
+}
+
+uint64_t elapsedMicroseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Applies packs that change battle state only through CGameState
+class BattleStateApplier : public ICPackVisitor
+{
+	BattleInfo & battle;
+
+public:
+	explicit BattleStateApplier(BattleInfo & battle)
+		: battle(battle)
+	{
+	}
+
+	void visitStartAction(StartAction & pack) override
+	{
+		CStack * stack = battle.getStack(pack.ba.stackNumber);
+
+		switch(pack.ba.actionType)
+		{
+		case EActionType::DEFEND:
+			stack->waiting = false;
+			stack->defending = true;
+			stack->defendingAnim = true;
+			break;
+		case EActionType::WAIT:
+			stack->defendingAnim = false;
+			stack->waiting = true;
+			stack->waitedThisTurn = true;
+			break;
+		default:
+			stack->waiting = false;
+			stack->defendingAnim = false;
+			stack->movedThisRound = true;
+			break;
+		}
+	}
+
+	void visitBattleAttack(BattleAttack & pack) override
+	{
+		pack.attackerChanges.applyBattle(&battle);
+
+		for(BattleStackAttacked & stackAttacked : pack.bsa)
+			stackAttacked.applyBattle(&battle);
+
+		battle.getStack(pack.stackAttacking)->removeBonusesRecursive(Bonus::UntilAttack);
+	}
+
+	void visitBattleTriggerEffect(BattleTriggerEffect & pack) override
+	{
+		if(pack.effect == Bonus::HP_REGENERATION)
+		{
+			int64_t toHeal = pack.val;
+			battle.getStack(pack.stackID)->heal(toHeal, EHealLevel::HEAL, EHealPower::PERMANENT);
+		}
+	}
+
+	void visitBattleUpdateGateState(BattleUpdateGateState & pack) override
+	{
+		battle.setGateState(pack.state);
+	}
+};
+
+/// Single battle, actions are made by battle rules shared with CGameHandler
+class SimulatedBattle : public SpellCastEnvironment, boost::noncopyable
+{
+	const BattleSimulationSetup & setup;
+	uint32_t seed;
+
+	CRandomGenerator rand;
+	CBonusSystemNode globalEffects;
+	std::array<std::unique_ptr<CArmedInstance>, 2> armies;
+	std::unique_ptr<BattleInfo> battle;
+	std::unique_ptr<BattleActionProcessor> rules;
+	std::array<std::unique_ptr<IBattleSimulationPlayer>, 2> players;
+
+	bool finished() const;
+
+	const CStack * getNextStack();
+	void removeGhosts();
+	void activateStack(const CStack * stack);
+	bool makeAction(const BattleAction & action);
+
+public:
+	SimulatedBattle(const BattleSimulationSetup & setup, uint32_t seed);
+	~SimulatedBattle();
+
+	BattleSimulationOutcome play(const BattleSimulationPlayerFactory & playerFactory);
+
+	void complain(const std::string & problem) override;
+	bool describeChanges() const override;
+
+	vstd::RNG * getRNG() override;
+
+	void apply(CPackForClient * pack) override;
+
+	void apply(BattleLogMessage * pack) override;
+	void apply(BattleStackMoved * pack) override;
+	void apply(BattleUnitsChanged * pack) override;
+	void apply(SetStackEffect * pack) override;
+	void apply(StacksInjured * pack) override;
+	void apply(BattleObstaclesChanged * pack) override;
+	void apply(CatapultAttack * pack) override;
+
+	const CMap * getMap() const override;
+	const CGameInfoCallback * getCb() const override;
+	bool moveHero(ObjectInstanceID hid, int3 dst, bool teleporting) override;
+	void genericQuery(Query * request, PlayerColor color, std::function<void(const JsonNode &)> callback) override;
+};
+
+SimulatedBattle::SimulatedBattle(const BattleSimulationSetup & setup, uint32_t seed)
+	: setup(setup),
+	seed(seed)
+{
+	rand.setSeed(static_cast<int>(seed));
+
+	for(const auto & b : VLC->settings()->getValue(EGameSettings::BONUSES_GLOBAL).Struct())
+	{
+		auto bonus = JsonUtils::parseBonus(b.second);
+		bonus->source = Bonus::GLOBAL;
+		bonus->sid = -1;
+		globalEffects.addNewBonus(bonus);
+	}
+
+	BattleField battlefield = setup.battlefield;
+	if(battlefield == BattleField::NONE)
+		battlefield = *RandomGeneratorUtil::nextItem(VLC->terrainTypeHandler->getById(setup.terrain)->battleFields, rand);
+
+	const CArmedInstance * sideArmies[2];
+	const CGHeroInstance * heroes[2] = {nullptr, nullptr};
+
+	boost::unique_lock<boost::mutex> lock(bonusTreeMutex);
+
+	for(int side = 0; side < 2; side++)
+	{
+		const auto & description = setup.sides[side];
+
+		armies[side] = std::make_unique<CArmedInstance>();
+		armies[side]->tempOwner = PlayerColor(side);
+		armies[side]->formation = description.tightFormation ? EArmyFormation::TIGHT : EArmyFormation::LOOSE;
+		armies[side]->attachTo(globalEffects);
+
+		for(const auto & bonus : description.bonuses)
+			armies[side]->addNewBonus(std::make_shared<Bonus>(*bonus));
+
+		for(size_t slot = 0; slot < description.stacks.size() && slot < GameConstants::ARMY_SIZE; slot++)
+			armies[side]->putStack(SlotID(static_cast<si32>(slot)), new CStackInstance(description.stacks[slot].type, description.stacks[slot].count));
+
+		sideArmies[side] = armies[side].get();
+	}
+
+	battle.reset(BattleInfo::setupBattle(setup.tile, setup.terrain, battlefield, sideArmies, heroes, false, nullptr));
+
+	if(!setup.obstacles)
+	{
+		battle->obstacles.clear();
+		battle->updateStateVersion();
+	}
+
+	battle->localInit();
+
+	rules = std::make_unique<BattleActionProcessor>(battle.get(), this, rand);
+}
+
+SimulatedBattle::~SimulatedBattle()
+{
+	for(auto & player : players)
+		player.reset();
+
+	rules.reset();
+
+	boost::unique_lock<boost::mutex> lock(bonusTreeMutex);
+
+	battle.reset();
+
+	for(auto & army : armies)
+		army.reset();
+}
+
+BattleSimulationOutcome SimulatedBattle::play(const BattleSimulationPlayerFactory & playerFactory)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	BattleSimulationOutcome outcome;
+	outcome.seed = seed;
+
+	//some decisions of AI use thread-specific generator
+	CRandomGenerator::getDefault().setSeed(static_cast<int>(seed));
+
+	std::map<uint32_t, int32_t> initialCount;
+	for(const CStack * stack : battle->stacks)
+		initialCount[stack->unitId()] = stack->getCount();
+
+	for(int side = 0; side < 2; side++)
+	{
+		players[side] = playerFactory(setup.sides[side]);
+		players[side]->battleStart(battle.get(), side);
+	}
+
+	while(!finished() && outcome.rounds < setup.maxRounds)
+	{
+		battle->nextRound(battle->round + 1);
+		outcome.rounds++;
+
+		while(const CStack * next = getNextStack())
+			activateStack(next);
+	}
+
+	auto result = battle->battleIsFinished();
+	if(result && *result < 2)
+		outcome.winner = *result;
+
+	for(const CStack * stack : battle->stacks)
+	{
+		auto initial = initialCount.find(stack->unitId());
+
+		//summoned units are not counted
+		if(initial == initialCount.end())
+			continue;
+
+		int64_t lost = initial->second - (stack->alive() ? stack->getCount() : 0);
+		outcome.unitsLost[stack->unitSide()] += lost;
+		outcome.valueLost[stack->unitSide()] += lost * stack->unitType()->getAIValue();
+	}
+
+	outcome.time = elapsedMicroseconds(start);
+	return outcome;
+}
+
+bool SimulatedBattle::finished() const
+{
+	return battle->battleIsFinished().has_value();
+}
+
+const CStack * SimulatedBattle::getNextStack()
+{
+	if(finished())
+		return nullptr;
+
+	std::vector<battle::Units> queue;
+	battle->battleGetTurnOrder(queue, 1, 0, -1);
+
+	if(queue.empty() || queue.front().empty())
+		return nullptr;
+
+	const battle::Unit * next = queue.front().front();
+	const CStack * stack = battle->battleGetStackByID(next->unitId(), false);
+
+	// regeneration takes place before everything else but only during first turn attempt in each round
+	if(stack)
+		rules->regenerate(stack);
+
+	if(stack && next->willMove())
+		return stack;
+
+	return nullptr;
+}
+
+void SimulatedBattle::removeGhosts()
+{
+	std::vector<uint32_t> ghosts;
+
+	for(const CStack * stack : battle->stacks)
+	{
+		if(stack->ghostPending)
+			ghosts.push_back(stack->unitId());
+	}
+
+	if(ghosts.empty())
+		return;
+
+	boost::unique_lock<boost::mutex> lock(bonusTreeMutex);
+
+	for(auto id : ghosts)
+		battle->removeUnit(id);
+}
+
+void SimulatedBattle::activateStack(const CStack * stack)
+{
+	removeGhosts();
+
+	const uint32_t id = stack->unitId();
+
+	BattleAction doNothing;
+	doNothing.side = stack->unitSide();
+	doNothing.stackNumber = id;
+	doNothing.actionType = EActionType::NO_ACTION;
+
+	if(rules->rollBadMorale(stack))
+	{
+		//unit loses its turn
+		battle->nextTurn(id);
+		doNothing.actionType = EActionType::BAD_MORALE;
+		makeAction(doNothing);
+		return;
+	}
+
+	do
+	{
+		battle->nextTurn(id);
+
+		BattleAction action = players[stack->unitSide()]->activeStack(stack);
+
+		//unit that made invalid action still loses its turn, otherwise it would be asked again forever
+		if(!makeAction(action))
+			makeAction(doNothing);
+
+		if(finished())
+			return;
+	}
+	while(rules->rollGoodMorale(stack));
+}
+
+bool SimulatedBattle::makeAction(const BattleAction & action)
+{
+	const CStack * stack = battle->battleGetStackByID(action.stackNumber);
+
+	if(!stack || action.stackNumber != battle->getActiveStackID())
+	{
+		complain("Action has to be about active stack!");
+		return false;
+	}
+
+	//unit that waits again would never leave turn queue
+	if(action.actionType == EActionType::WAIT && stack->waitedThisTurn)
+	{
+		complain("Stack has already waited this turn!");
+		return false;
+	}
+
+	return rules->makeAction(action);
+}
+
+void SimulatedBattle::complain(const std::string & problem)
+{
+	logGlobal->debug("Battle simulation %d: %s", seed, problem);
+}
+
+bool SimulatedBattle::describeChanges() const
+{
+	return false;
+}
+
+vstd::RNG * SimulatedBattle::getRNG()
+{
+	return &rand;
+}
+
+void SimulatedBattle::apply(CPackForClient * pack)
+{
+	//remaining packs (action start and end, spell cast animation, mana) do not change battle state
+	BattleStateApplier applier(*battle);
+	pack->visit(applier);
+}
+
+void SimulatedBattle::apply(BattleLogMessage * pack)
+{
+	pack->applyBattle(battle.get());
+}
+
+void SimulatedBattle::apply(BattleStackMoved * pack)
+{
+	pack->applyBattle(battle.get());
+}
+
+void SimulatedBattle::apply(BattleUnitsChanged * pack)
+{
+	//summoned units are attached to creature type
+	boost::unique_lock<boost::mutex> lock(bonusTreeMutex);
+	pack->applyBattle(battle.get());
+}
+
+void SimulatedBattle::apply(SetStackEffect * pack)
+{
+	pack->applyBattle(battle.get());
+}
+
+void SimulatedBattle::apply(StacksInjured * pack)
+{
+	pack->applyBattle(battle.get());
+}
+
+void SimulatedBattle::apply(BattleObstaclesChanged * pack)
+{
+	pack->applyBattle(battle.get());
+}
+
+void SimulatedBattle::apply(CatapultAttack * pack)
+{
+	pack->applyBattle(battle.get());
+}
+
+const CMap * SimulatedBattle::getMap() const
+{
+	return nullptr;
+}
+
+const CGameInfoCallback * SimulatedBattle::getCb() const
+{
+	return nullptr;
+}
+
+bool SimulatedBattle::moveHero(ObjectInstanceID hid, int3 dst, bool teleporting)
+{
+	return false;
+}
+
+void SimulatedBattle::genericQuery(Query * request, PlayerColor color, std::function<void(const JsonNode &)> callback)
+{
+	//simulated armies have no heroes to ask
+}
+
+}
+
+BattleSimulationSetup BattleSimulationSetup::fromJson(const JsonNode & config)
+{
+	BattleSimulationSetup ret;
+
+	for(int side = 0; side < 2; side++)
+	{
+		const JsonNode & sideConfig = config[sideNames[side]];
+		BattleSimulationSide & result = ret.sides[side];
+
+		for(const JsonNode & stackConfig : sideConfig["army"].Vector())
+		{
+			auto creature = VLC->modh->identifiers.getIdentifier(CModHandler::scopeGame(), "creature", stackConfig["type"].String());
+
+			if(!creature)
+				throw std::runtime_error("Unknown creature " + stackConfig["type"].String());
+
+			result.stacks.emplace_back(CreatureID(creature.value()), static_cast<TQuantity>(stackConfig["amount"].Integer()));
+		}
+
+		if(result.stacks.empty() || result.stacks.size() > GameConstants::ARMY_SIZE)
+			throw std::runtime_error("Army of " + sideNames[side] + " must have from 1 to 7 stacks");
+
+		result.tightFormation = sideConfig["tight"].Bool();
+		result.ai = sideConfig["ai"].String();
+
+		for(JsonNode bonusConfig : sideConfig["bonuses"].Vector())
+		{
+			bonusConfig.setMeta(CModHandler::scopeGame());
+			auto bonus = JsonUtils::parseBonus(bonusConfig);
+
+			if(!bonus)
+				throw std::runtime_error("Invalid bonus of " + sideNames[side]);
+
+			result.bonuses.push_back(bonus);
+		}
+	}
+
+	if(!config["terrain"].isNull())
+	{
+		auto terrain = VLC->modh->identifiers.getIdentifier(CModHandler::scopeGame(), "terrain", config["terrain"].String());
+
+		if(!terrain)
+			throw std::runtime_error("Unknown terrain " + config["terrain"].String());
+
+		ret.terrain = TerrainId(terrain.value());
+	}
+
+	if(!config["battlefield"].isNull())
+	{
+		ret.battlefield = BattleField::fromString(config["battlefield"].String());
+
+		if(ret.battlefield == BattleField::NONE)
+			throw std::runtime_error("Unknown battlefield " + config["battlefield"].String());
+	}
+
+	if(!config["obstacles"].isNull())
+		ret.obstacles = config["obstacles"].Bool();
+	if(!config["tile"].isNull())
+	{
+		const JsonVector & tile = config["tile"].Vector();
+
+		if(tile.size() != 3)
+			throw std::runtime_error("Tile must have 3 coordinates");
+
+		ret.tile = int3(static_cast<si32>(tile[0].Integer()), static_cast<si32>(tile[1].Integer()), static_cast<si32>(tile[2].Integer()));
+	}
+	if(!config["battles"].isNull())
+		ret.battles = static_cast<int>(config["battles"].Integer());
+	if(!config["threads"].isNull())
+		ret.threads = static_cast<int>(config["threads"].Integer());
+	if(!config["maxRounds"].isNull())
+		ret.maxRounds = static_cast<int>(config["maxRounds"].Integer());
+	if(!config["seed"].isNull())
+		ret.seed = static_cast<uint32_t>(config["seed"].Integer());
+
+	return ret;
+}
+
+std::vector<std::string> BattleSimulationSetup::unsupportedAbilities() const
+{
+	std::vector<std::string> ret;
+
+	auto bonusName = [](Bonus::BonusType type)
+	{
+		return vstd::findKey(bonusNameMap, type);
+	};
+
+	for(int side = 0; side < 2; side++)
+	{
+		for(const auto & bonus : sides[side].bonuses)
+		{
+			if(vstd::contains(unsupportedBonuses, bonus->type))
+				ret.push_back(boost::str(boost::format("%s: bonus %s") % sideNames[side] % bonusName(bonus->type)));
+		}
+
+		for(const auto & stack : sides[side].stacks)
+		{
+			const CCreature * creature = stack.type;
+
+			for(auto type : unsupportedBonuses)
+			{
+				if(creature->hasBonusOfType(type))
+					ret.push_back(boost::str(boost::format("%s: %s has %s") % sideNames[side] % creature->getJsonKey() % bonusName(type)));
+			}
+
+			for(const auto & bonus : *creature->getBonuses(Selector::type()(Bonus::SPELLCASTER)))
+			{
+				const CSpell * spell = SpellID(bonus->subtype).toSpell();
+
+				if(spell && createsObstacles(spell))
+					ret.push_back(boost::str(boost::format("%s: %s casts %s") % sideNames[side] % creature->getJsonKey() % spell->getJsonKey()));
+			}
+		}
+	}
+
+	return ret;
+}
+
+int BattleSimulationReport::wins(int side) const
+{
+	return static_cast<int>(boost::range::count_if(battles, [side](const BattleSimulationOutcome & battle)
+	{
+		return battle.winner == side;
+	}));
+}
+
+int BattleSimulationReport::draws() const
+{
+	return wins(-1);
+}
+
+JsonNode BattleSimulationReport::toJson(bool withBattles) const
+{
+	JsonNode result;
+
+	const double count = std::max<size_t>(1, battles.size());
+
+	result["battles"].Integer() = battles.size();
+	result["threads"].Integer() = threads;
+	result["totalTime"].Float() = totalTime / 1000.0;
+	result["battlesPerSecond"].Float() = totalTime ? battles.size() * 1000000.0 / totalTime : 0.0;
+	result["draws"].Integer() = draws();
+
+	uint64_t minTime = battles.empty() ? 0 : std::numeric_limits<uint64_t>::max();
+	uint64_t maxTime = 0;
+	uint64_t sumTime = 0;
+	int64_t sumRounds = 0;
+
+	for(const auto & battle : battles)
+	{
+		vstd::amin(minTime, battle.time);
+		vstd::amax(maxTime, battle.time);
+		sumTime += battle.time;
+		sumRounds += battle.rounds;
+	}
+
+	result["averageRounds"].Float() = sumRounds / count;
+	result["battleTime"]["average"].Float() = sumTime / count / 1000.0;
+	result["battleTime"]["min"].Float() = minTime / 1000.0;
+	result["battleTime"]["max"].Float() = maxTime / 1000.0;
+
+	for(int side = 0; side < 2; side++)
+	{
+		JsonNode & sideResult = result[sideNames[side]];
+
+		int64_t unitsLost = 0;
+		int64_t valueLost = 0;
+
+		for(const auto & battle : battles)
+		{
+			unitsLost += battle.unitsLost[side];
+			valueLost += battle.valueLost[side];
+		}
+
+		sideResult["wins"].Integer() = wins(side);
+		sideResult["winRate"].Float() = wins(side) / count;
+		sideResult["averageUnitsLost"].Float() = unitsLost / count;
+		sideResult["averageValueLost"].Float() = valueLost / count;
+	}
+
+	if(withBattles)
+	{
+		for(const auto & battle : battles)
+		{
+			JsonNode entry;
+
+			entry["seed"].Integer() = battle.seed;
+			entry["winner"].Integer() = battle.winner;
+			entry["rounds"].Integer() = battle.rounds;
+			entry["time"].Float() = battle.time / 1000.0;
+
+			for(int side = 0; side < 2; side++)
+			{
+				entry[sideNames[side]]["unitsLost"].Integer() = battle.unitsLost[side];
+				entry[sideNames[side]]["valueLost"].Integer() = battle.valueLost[side];
+			}
+
+			result["results"].Vector().push_back(entry);
+		}
+	}
+
+	return result;
+}
+
+BattleSimulator::BattleSimulator(BattleSimulationSetup setup, BattleSimulationPlayerFactory playerFactory)
+	: setup(std::move(setup)),
+	playerFactory(std::move(playerFactory))
+{
+	auto unsupported = this->setup.unsupportedAbilities();
+
+	if(!unsupported.empty())
+		throw std::runtime_error("Battle simulation does not support " + boost::algorithm::join(unsupported, ", "));
+}
+
+BattleSimulationReport BattleSimulator::run() const
+{
+	auto start = std::chrono::steady_clock::now();
+
+	BattleSimulationReport report;
+	report.battles.resize(std::max(0, setup.battles));
+
+	//seeds are generated upfront so that each battle gets same seed regardless of number of threads
+	CRandomGenerator seedGenerator;
+	seedGenerator.setSeed(static_cast<int>(setup.seed));
+
+	std::vector<uint32_t> seeds;
+	for(size_t i = 0; i < report.battles.size(); i++)
+		seeds.push_back(static_cast<uint32_t>(seedGenerator.nextInt()));
+
+	std::vector<std::exception_ptr> errors(report.battles.size());
+	std::atomic<size_t> nextBattle(0);
+
+	auto worker = [&]()
+	{
+		for(size_t i = nextBattle++; i < report.battles.size(); i = nextBattle++)
+		{
+			try
+			{
+				report.battles[i] = runBattle(seeds[i]);
+			}
+			catch(...)
+			{
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+
+	size_t threadsCount = setup.threads > 0 ? setup.threads : std::max(1u, boost::thread::hardware_concurrency());
+	vstd::amin(threadsCount, std::max<size_t>(1, report.battles.size()));
+
+	boost::thread_group workers;
+	for(size_t i = 1; i < threadsCount; ++i)
+		workers.create_thread(worker);
+	worker();
+	workers.join_all();
+
+	for(auto & error : errors)
+	{
+		if(error)
+			std::rethrow_exception(error);
+	}
+
+	report.threads = static_cast<int>(threadsCount);
+	report.totalTime = elapsedMicroseconds(start);
+	return report;
+}
+
+BattleSimulationOutcome BattleSimulator::runBattle(uint32_t seed) const
+{
+	SimulatedBattle battle(setup, seed);
+	return battle.play(playerFactory);
+}
+
+VCMI_LIB_NAMESPACE_END
@@ -0,0 +1,130 @@
+/*
+ * BattleSimulator.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "../CCreatureSet.h"
+#include "../int3.h"
+#include "BattleAction.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+class BattleInfo;
+class CStack;
+class JsonNode;
+struct Bonus;
+
+/// One side of simulated battle
+struct DLL_LINKAGE BattleSimulationSide
+{
+	std::vector<CStackBasicDescriptor> stacks;
+	bool tightFormation = false;
+	/// bonuses given to whole army, used instead of hero (primary skills, secondary skills, artifacts)
+	std::vector<std::shared_ptr<Bonus>> bonuses;
+	/// name of battle AI library that controls this side, only used by players that load AI libraries
+	std::string ai;
+};
+
+/// Description of series of battles between same armies
+struct DLL_LINKAGE BattleSimulationSetup
+{
+	std::array<BattleSimulationSide, 2> sides;
+	TerrainId terrain = ETerrainId::GRASS;
+	/// random battlefield of terrain is used if not set
+	BattleField battlefield = BattleField::NONE;
+	bool obstacles = true;
+	/// position of battle on adventure map, random obstacles are placed same way as in game battle on this tile
+	int3 tile;
+
+	int battles = 100;
+	/// 0 - use all available cores
+	int threads = 0;
+	/// battle is declared a draw if it is not finished after this number of rounds
+	int maxRounds = 100;
+	uint32_t seed = 0;
+
+	/// Reads setup from json, throws std::runtime_error on invalid creature or terrain
+	/// {
+	///   "attacker" : { "army" : [ { "type" : "archangel", "amount" : 10 } ], "tight" : false, "bonuses" : [ ... ], "ai" : "BattleAI" },
+	///   "defender" : { ... },
+	///   "terrain" : "grass", "battlefield" : "grass_hills", "obstacles" : true, "tile" : [ 0, 0, 0 ],
+	///   "battles" : 1000, "threads" : 0, "maxRounds" : 100, "seed" : 0
+	/// }
+	static BattleSimulationSetup fromJson(const JsonNode & config);
+
+	/// Abilities of armies that need rules not implemented by simulator, one description per ability and side
+	std::vector<std::string> unsupportedAbilities() const;
+};
+
+/// Result of single simulated battle
+struct DLL_LINKAGE BattleSimulationOutcome
+{
+	uint32_t seed = 0;
+	/// winning side or -1 for draw
+	int winner = -1;
+	int rounds = 0;
+	/// number of creatures lost by each side
+	std::array<int64_t, 2> unitsLost = {0, 0};
+	/// AI value of creatures lost by each side
+	std::array<int64_t, 2> valueLost = {0, 0};
+	/// wall time of battle including AI decisions, in microseconds
+	uint64_t time = 0;
+};
+
+struct DLL_LINKAGE BattleSimulationReport
+{
+	std::vector<BattleSimulationOutcome> battles;
+	/// wall time of whole run, in microseconds
+	uint64_t totalTime = 0;
+	int threads = 0;
+
+	int wins(int side) const;
+	int draws() const;
+
+	/// summary with win rates, average casualties and battle times, optionally followed by all battles
+	JsonNode toJson(bool withBattles) const;
+};
+
+/// Makes decisions for one side of simulated battle
+/// Each battle gets its own instance, so implementations do not need to be thread-safe
+class DLL_LINKAGE IBattleSimulationPlayer
+{
+public:
+	virtual ~IBattleSimulationPlayer() = default;
+
+	virtual void battleStart(const BattleInfo * battle, ui8 side) = 0;
+	virtual BattleAction activeStack(const CStack * stack) = 0;
+};
+
+using BattleSimulationPlayerFactory = std::function<std::unique_ptr<IBattleSimulationPlayer>(const BattleSimulationSide & side)>;
+
+/// Plays battles between two armies without game state, server or client, e.g. for balance testing and quick combat
+/// Battles run in parallel, each with its own random seed derived from setup seed, so results do not depend on number of threads
+/// Actions are made by BattleActionProcessor, same rules as used by server
+/// Supported actions: movement, melee and ranged attacks with retaliation, defend, wait and creature spells
+/// Not supported: hero spells, war machines, tactics, sieges and abilities listed in unsupportedAbilities
+/// (spells before and after attack, death stare, acid breath, transmutation, destruction, start of turn effects,
+/// summoning at battle start, berserk and creature spells that create obstacles)
+class DLL_LINKAGE BattleSimulator
+{
+	BattleSimulationSetup setup;
+	BattleSimulationPlayerFactory playerFactory;
+
+public:
+	/// throws std::runtime_error if setup has abilities that simulator does not implement
+	BattleSimulator(BattleSimulationSetup setup, BattleSimulationPlayerFactory playerFactory);
+
+	/// plays all battles of setup
+	BattleSimulationReport run() const;
+
+	/// plays single battle in calling thread
+	BattleSimulationOutcome runBattle(uint32_t seed) const;
+};
+
+VCMI_LIB_NAMESPACE_END
@@ -17,6 +17,7 @@
 #include "CObstacleInstance.h"
 #include "DamageCalculator.h"
 #include "PossiblePlayerBattleAction.h"
+#include "ReachabilityCache.h"
 #include "../NetPacks.h"
 #include "../spells/ObstacleCasterProxy.h"
 #include "../spells/ISpellMechanics.h"
@@ -890,7 +891,35 @@ bool CBattleInfoCallback::handleObstacleTriggersForUnit(SpellCastEnvironment & s
 	return unit.alive() && !movementStopped;
 }
 
+CBattleInfoCallback::CBattleInfoCallback()
+	: reachabilityCache(std::make_shared<ReachabilityCache>())
+{
+}
+
+int64_t CBattleInfoCallback::battleGetStateVersion() const
+{
+	RETURN_IF_NOT_BATTLE(-1);
+	return getBattle()->getStateVersion();
+}
+
 AccessibilityInfo CBattleInfoCallback::getAccesibility() const
+{
+	const int64_t version = battleGetStateVersion();
+
+	if(version < 0)
+		return calculateAccessibility();
+
+	const auto viewer = battleGetMySide();
+
+	if(auto cached = reachabilityCache->getAccessibility(version, viewer))
+		return *cached;
+
+	auto ret = calculateAccessibility();
+	reachabilityCache->storeAccessibility(version, viewer, ret);
+	return ret;
+}
+
+AccessibilityInfo CBattleInfoCallback::calculateAccessibility() const
 {
 	AccessibilityInfo ret;
 	ret.fill(EAccessibility::ACCESSIBLE);
@@ -988,6 +1017,17 @@ AccessibilityInfo CBattleInfoCallback::getAccesibility(const std::vector<BattleH
 }
 
 ReachabilityInfo CBattleInfoCallback::makeBFS(const AccessibilityInfo &accessibility, const ReachabilityInfo::Parameters & params) const
+{
+	auto stoppingHexes = getStoppers(params.perspective);
+
+	//moat under drawbridge stops only attackers
+	if(battleGetGateState() == EGateState::DESTROYED || params.side != BattleSide::ATTACKER)
+		stoppingHexes.reset(ESiegeHex::GATE_BRIDGE);
+
+	return makeBFS(accessibility, params, stoppingHexes);
+}
+
+ReachabilityInfo CBattleInfoCallback::makeBFS(const AccessibilityInfo & accessibility, const ReachabilityInfo::Parameters & params, const BattleHexMask & stoppingHexes)
 {
 	ReachabilityInfo ret;
 	ret.accessibility = accessibility;
@@ -999,40 +1039,53 @@ ReachabilityInfo CBattleInfoCallback::makeBFS(const AccessibilityInfo &accessibi
 	if(!params.startPosition.isValid()) //if got call for arrow turrets
 		return ret;
 
-	const std::set<BattleHex> obstacles = getStoppers(params.perspective);
-	auto checkParams = params;
-	checkParams.ignoreKnownAccessible = true; //Ignore starting hexes obstacles
+	//starting hexes never stop the unit
+	BattleHexMask stoppers = stoppingHexes;
+	for(auto hex : params.knownAccessible)
+		stoppers.reset(hex);
 
-	std::queue<BattleHex> hexq; //bfs queue
+	//walking stack can't step past the obstacles, double wide stack is stopped if any of its hexes is on obstacle
+	if(params.doubleWide)
+		stoppers |= stoppers.shifted(params.side == BattleSide::ATTACKER ? 1 : -1);
 
-	//first element
-	hexq.push(params.startPosition);
+	const BattleHexMask accessible = accessibility.accessibleHexes(params.doubleWide, params.side);
+
+	//hexes reached so far, in order of processing
+	std::array<BattleHex, GameConstants::BFIELD_SIZE> queue;
+	size_t head = 0;
+	size_t tail = 0;
+
+	queue[tail++] = params.startPosition;
 	ret.distances[params.startPosition] = 0;
 
-	std::array<bool, GameConstants::BFIELD_SIZE> accessibleCache{};
-	for(int hex = 0; hex < GameConstants::BFIELD_SIZE; hex++)
-		accessibleCache[hex] = accessibility.accessible(hex, params.doubleWide, params.side);
+	BattleHexMask reached;
+	reached.set(params.startPosition);
+
+	BattleHexMask frontier = reached;
 
-	while(!hexq.empty()) //bfs loop
+	for(uint32_t distance = 1; frontier.any(); distance++)
 	{
-		const BattleHex curHex = hexq.front();
-		hexq.pop();
+		//all hexes of next layer are found at once, queue is then only used to pick predecessors in same order as plain BFS does
+		BattleHexMask nextLayer = (frontier - stoppers).neighbours() & accessible;
+		nextLayer -= reached;
 
-		//walking stack can't step past the obstacles
-		if(isInObstacle(curHex, obstacles, checkParams))
-			continue;
+		reached |= nextLayer;
+		frontier = nextLayer;
 
-		const int costToNeighbour = ret.distances[curHex.hex] + 1;
-		for(BattleHex neighbour : BattleHex::neighbouringTilesCache[curHex.hex])
+		for(size_t layerEnd = tail; head < layerEnd; head++)
 		{
-			if(neighbour.isValid())
-			{
-				const int costFoundSoFar = ret.distances[neighbour.hex];
+			const BattleHex curHex = queue[head];
+
+			if(stoppers.test(curHex))
+				continue;
 
-				if(accessibleCache[neighbour.hex] && costToNeighbour < costFoundSoFar)
+			for(BattleHex neighbour : BattleHex::neighbouringTilesCache[curHex.hex])
+			{
+				if(nextLayer.test(neighbour))
 				{
-					hexq.push(neighbour);
-					ret.distances[neighbour.hex] = costToNeighbour;
+					nextLayer.reset(neighbour);
+					queue[tail++] = neighbour;
+					ret.distances[neighbour.hex] = distance;
 					ret.predecessors[neighbour.hex] = curHex;
 				}
 			}
@@ -1042,36 +1095,9 @@ ReachabilityInfo CBattleInfoCallback::makeBFS(const AccessibilityInfo &accessibi
 	return ret;
 }
 
-bool CBattleInfoCallback::isInObstacle(
-	BattleHex hex,
-	const std::set<BattleHex> & obstacles,
-	const ReachabilityInfo::Parameters & params) const
-{
-	auto occupiedHexes = battle::Unit::getHexes(hex, params.doubleWide, params.side);
-
-	for(auto occupiedHex : occupiedHexes)
-	{
-		if(params.ignoreKnownAccessible && vstd::contains(params.knownAccessible, occupiedHex))
-			continue;
-
-		if(vstd::contains(obstacles, occupiedHex))
-		{
-			if(occupiedHex == ESiegeHex::GATE_BRIDGE)
-			{
-				if(battleGetGateState() != EGateState::DESTROYED && params.side == BattleSide::ATTACKER)
-					return true;
-			}
-			else
-				return true;
-		}
-	}
-
-	return false;
-}
-
-std::set<BattleHex> CBattleInfoCallback::getStoppers(BattlePerspective::BattlePerspective whichSidePerspective) const
+BattleHexMask CBattleInfoCallback::getStoppers(BattlePerspective::BattlePerspective whichSidePerspective) const
 {
-	std::set<BattleHex> ret;
+	BattleHexMask ret;
 	RETURN_IF_NOT_BATTLE(ret);
 
 	for(auto &oi : battleGetAllObstacles(whichSidePerspective))
@@ -1086,7 +1112,7 @@ std::set<BattleHex> CBattleInfoCallback::getStoppers(BattlePerspective::BattlePe
 				if(battleGetGateState() == EGateState::OPENED || battleGetGateState() == EGateState::DESTROYED)
 					continue; // this tile is disabled by drawbridge on top of it
 			}
-			ret.insert(hex);
+			ret.set(hex);
 		}
 	}
 	return ret;
@@ -1198,6 +1224,23 @@ ReachabilityInfo CBattleInfoCallback::getReachability(const battle::Unit * unit)
 }
 
 ReachabilityInfo CBattleInfoCallback::getReachability(const ReachabilityInfo::Parameters &params) const
+{
+	const int64_t version = battleGetStateVersion();
+
+	if(version < 0)
+		return calculateReachability(params);
+
+	const auto viewer = battleGetMySide();
+
+	if(auto cached = reachabilityCache->getReachability(version, viewer, params))
+		return *cached;
+
+	auto ret = std::make_shared<ReachabilityInfo>(calculateReachability(params));
+	reachabilityCache->storeReachability(version, viewer, ret);
+	return *ret;
+}
+
+ReachabilityInfo CBattleInfoCallback::calculateReachability(const ReachabilityInfo::Parameters &params) const
 {
 	if(params.flying)
 		return getFlyingReachability(params);
@@ -1210,9 +1253,11 @@ ReachabilityInfo CBattleInfoCallback::getFlyingReachability(const ReachabilityIn
 	ReachabilityInfo ret;
 	ret.accessibility = getAccesibility(params.knownAccessible);
 
+	const BattleHexMask accessible = ret.accessibility.accessibleHexes(params.doubleWide, params.side);
+
 	for(int i = 0; i < GameConstants::BFIELD_SIZE; i++)
 	{
-		if(ret.accessibility.accessible(i, params.doubleWide, params.side))
+		if(accessible.test(i))
 		{
 			ret.predecessors[i] = params.startPosition;
 			ret.distances[i] = BattleHex::getDistance(params.startPosition, i);
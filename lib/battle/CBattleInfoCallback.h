@@ -26,6 +26,7 @@ struct CObstacleInstance;
 class IBonusBearer;
 class CRandomGenerator;
 class PossiblePlayerBattleAction;
+class ReachabilityCache;
 
 namespace spells
 {
@@ -52,12 +53,17 @@ struct DLL_LINKAGE BattleClientInterfaceData
 
 class DLL_LINKAGE CBattleInfoCallback : public virtual CBattleInfoEssentials
 {
+	/// results of queries for current state version, shared by copies of callback
+	std::shared_ptr<ReachabilityCache> reachabilityCache;
+
 public:
 	enum ERandomSpell
 	{
 		RANDOM_GENIE, RANDOM_AIMED
 	};
 
+	CBattleInfoCallback();
+
 	std::optional<int> battleIsFinished() const override; //return none if battle is ongoing; otherwise the victorious side (0/1) or 2 if it is a draw
 
 	std::vector<std::shared_ptr<const CObstacleInstance>> battleGetAllObstaclesOnPos(BattleHex tile, bool onlyBlocking = true) const override;
@@ -137,6 +143,8 @@ public:
 	std::set<const CStack*> getAttackedCreatures(const CStack* attacker, BattleHex destinationTile, bool rangedAttack, BattleHex attackerPos = BattleHex::INVALID) const; //calculates range of multi-hex attacks
 	bool isToReverse(const battle::Unit * attacker, const battle::Unit * defender) const; //determines if attacker standing at attackerHex should reverse in order to attack defender
 
+	int64_t battleGetStateVersion() const; //see IBattleInfo::getStateVersion
+
 	ReachabilityInfo getReachability(const battle::Unit * unit) const;
 	ReachabilityInfo getReachability(const ReachabilityInfo::Parameters & params) const;
 	AccessibilityInfo getAccesibility() const;
@@ -144,12 +152,17 @@ public:
 	AccessibilityInfo getAccesibility(const std::vector<BattleHex> & accessibleHexes) const; //given hexes will be marked as accessible
 	std::pair<const battle::Unit *, BattleHex> getNearestStack(const battle::Unit * closest) const;
 
+	/// Breadth-first search of walking unit movement, stopping hexes are hexes where unit has to end its movement (e.g. quicksands)
+	/// Does not depend on battle state, so it can be used with any accessibility
+	static ReachabilityInfo makeBFS(const AccessibilityInfo & accessibility, const ReachabilityInfo::Parameters & params, const BattleHexMask & stoppingHexes);
+
 	BattleHex getAvaliableHex(const CreatureID & creID, ui8 side, int initialPos = -1) const; //find place for adding new stack
 protected:
+	AccessibilityInfo calculateAccessibility() const;
+	ReachabilityInfo calculateReachability(const ReachabilityInfo::Parameters & params) const;
 	ReachabilityInfo getFlyingReachability(const ReachabilityInfo::Parameters & params) const;
 	ReachabilityInfo makeBFS(const AccessibilityInfo & accessibility, const ReachabilityInfo::Parameters & params) const;
-	bool isInObstacle(BattleHex hex, const std::set<BattleHex> & obstacles, const ReachabilityInfo::Parameters & params) const;
-	std::set<BattleHex> getStoppers(BattlePerspective::BattlePerspective whichSidePerspective) const; //get hexes with stopping obstacles (quicksands)
+	BattleHexMask getStoppers(BattlePerspective::BattlePerspective whichSidePerspective) const; //get hexes with stopping obstacles (quicksands)
 };
 
 VCMI_LIB_NAMESPACE_END
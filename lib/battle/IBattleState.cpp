@@ -11,3 +11,32 @@
 
 #include "IBattleState.h"
 
+VCMI_LIB_NAMESPACE_BEGIN
+
+int64_t IBattleInfo::getStateVersion() const
+{
+	return -1;
+}
+
+int64_t IBattleInfo::makeStateVersion()
+{
+	static std::atomic<int64_t> lastVersion(0);
+	return ++lastVersion;
+}
+
+int64_t DerivedStateVersion::update(int64_t baseVersion, Placement placement)
+{
+	if(baseVersion < 0)
+		return -1;
+
+	if(baseVersion != lastBaseVersion || placement != lastPlacement)
+	{
+		version = IBattleInfo::makeStateVersion();
+		lastBaseVersion = baseVersion;
+		lastPlacement = std::move(placement);
+	}
+
+	return version;
+}
+
+VCMI_LIB_NAMESPACE_END
@@ -65,6 +65,32 @@ public:
 	virtual uint32_t nextUnitId() const = 0;
 
 	virtual int64_t getActualDamage(const DamageRange & damage, int32_t attackerCount, vstd::RNG & rng) const = 0;
+
+	/// Version of battle state that changes whenever accessibility of hexes may change - units moved, killed or summoned, obstacles or walls changed
+	/// Versions are unique among all battle states, negative value means that state is not versioned and queries on it must not be cached
+	virtual int64_t getStateVersion() const;
+
+protected:
+	friend class DerivedStateVersion;
+
+	/// returns version that was not used by any battle state before
+	static int64_t makeStateVersion();
+};
+
+/// State version of battle whose units may be changed directly, without notifying the battle
+/// New version is made whenever version of underlying state or placement of units differs from previous query
+class DLL_LINKAGE DerivedStateVersion
+{
+public:
+	/// id and position of each unit in stable order, invalid hex for units that are not on battlefield
+	using Placement = std::vector<std::pair<uint32_t, si16>>;
+
+	int64_t update(int64_t baseVersion, Placement placement);
+
+private:
+	int64_t version = -1;
+	int64_t lastBaseVersion = -1;
+	Placement lastPlacement;
 };
 
 class DLL_LINKAGE IBattleState : public IBattleInfo
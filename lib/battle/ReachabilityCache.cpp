@@ -0,0 +1,84 @@
+/*
+ * ReachabilityCache.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "ReachabilityCache.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+ReachabilityCache::ReachabilityCache()
+	: version(-1),
+	perspective(BattlePerspective::INVALID)
+{
+}
+
+void ReachabilityCache::selectVersion(int64_t newVersion, BattlePerspective::BattlePerspective newPerspective)
+{
+	if(version == newVersion && perspective == newPerspective)
+		return;
+
+	version = newVersion;
+	perspective = newPerspective;
+	accessibility.reset();
+	reachability.clear();
+}
+
+std::optional<AccessibilityInfo> ReachabilityCache::getAccessibility(int64_t stateVersion, BattlePerspective::BattlePerspective viewer)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(version != stateVersion || perspective != viewer)
+		return std::nullopt;
+
+	return accessibility;
+}
+
+void ReachabilityCache::storeAccessibility(int64_t stateVersion, BattlePerspective::BattlePerspective viewer, const AccessibilityInfo & info)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	selectVersion(stateVersion, viewer);
+	accessibility = info;
+}
+
+std::shared_ptr<const ReachabilityInfo> ReachabilityCache::getReachability(int64_t stateVersion, BattlePerspective::BattlePerspective viewer, const ReachabilityInfo::Parameters & params)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	if(version != stateVersion || perspective != viewer)
+		return nullptr;
+
+	for(auto it = reachability.rbegin(); it != reachability.rend(); ++it)
+	{
+		if((*it)->params == params)
+		{
+			auto ret = *it;
+
+			reachability.erase(std::next(it).base());
+			reachability.push_back(ret);
+			return ret;
+		}
+	}
+
+	return nullptr;
+}
+
+void ReachabilityCache::storeReachability(int64_t stateVersion, BattlePerspective::BattlePerspective viewer, std::shared_ptr<const ReachabilityInfo> info)
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	selectVersion(stateVersion, viewer);
+
+	if(reachability.size() >= MAX_REACHABILITY_ENTRIES)
+		reachability.erase(reachability.begin());
+
+	reachability.push_back(info);
+}
+
+VCMI_LIB_NAMESPACE_END
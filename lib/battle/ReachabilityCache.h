@@ -0,0 +1,43 @@
+/*
+ * ReachabilityCache.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "ReachabilityInfo.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+/// Results of accessibility and reachability queries made for one version of battle state, see IBattleInfo::getStateVersion
+/// All results are dropped once queries are made for another version or perspective. Thread-safe
+class DLL_LINKAGE ReachabilityCache : boost::noncopyable
+{
+	static constexpr size_t MAX_REACHABILITY_ENTRIES = 16;
+
+	int64_t version;
+	BattlePerspective::BattlePerspective perspective;
+
+	std::optional<AccessibilityInfo> accessibility;
+	/// most recently used entries are at the end
+	std::vector<std::shared_ptr<const ReachabilityInfo>> reachability;
+
+	mutable boost::mutex mx;
+
+	void selectVersion(int64_t newVersion, BattlePerspective::BattlePerspective newPerspective);
+
+public:
+	ReachabilityCache();
+
+	std::optional<AccessibilityInfo> getAccessibility(int64_t stateVersion, BattlePerspective::BattlePerspective viewer);
+	void storeAccessibility(int64_t stateVersion, BattlePerspective::BattlePerspective viewer, const AccessibilityInfo & info);
+
+	std::shared_ptr<const ReachabilityInfo> getReachability(int64_t stateVersion, BattlePerspective::BattlePerspective viewer, const ReachabilityInfo::Parameters & params);
+	void storeReachability(int64_t stateVersion, BattlePerspective::BattlePerspective viewer, std::shared_ptr<const ReachabilityInfo> info);
+};
+
+VCMI_LIB_NAMESPACE_END
@@ -24,6 +24,17 @@ ReachabilityInfo::Parameters::Parameters(const battle::Unit * Stack, BattleHex S
 	knownAccessible = battle::Unit::getHexes(startPosition, doubleWide, side);
 }
 
+bool ReachabilityInfo::Parameters::operator==(const Parameters & other) const
+{
+	return side == other.side
+		&& doubleWide == other.doubleWide
+		&& flying == other.flying
+		&& ignoreKnownAccessible == other.ignoreKnownAccessible
+		&& knownAccessible == other.knownAccessible
+		&& startPosition == other.startPosition
+		&& perspective == other.perspective;
+}
+
 ReachabilityInfo::ReachabilityInfo()
 {
 	distances.fill(INFINITE_DIST);
@@ -36,6 +36,8 @@ struct DLL_LINKAGE ReachabilityInfo
 
 		Parameters() = default;
 		Parameters(const battle::Unit * Stack, BattleHex StartPosition);
+
+		bool operator==(const Parameters & other) const;
 	};
 
 	Parameters params;
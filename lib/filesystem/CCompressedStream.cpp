@@ -65,7 +65,9 @@ void CBufferedStream::ensureSize(si64 size)
 	while(static_cast<si64>(buffer.size()) < size && !endOfFileReached)
 	{
 		si64 initialSize = buffer.size();
-		si64 currentStep = std::min<si64>(size, buffer.size());
+		// read only as much as requested, so partial reads (e.g. map header) won't decompress whole stream
+		// but grow no faster than twice of current size when whole stream is requested (e.g. by getSize)
+		si64 currentStep = std::min<si64>(size - initialSize, initialSize);
 		vstd::amax(currentStep, 1024); // to avoid large number of calls at start
 
 		buffer.resize(initialSize + currentStep);
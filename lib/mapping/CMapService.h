@@ -40,6 +40,8 @@ public:
 
 	/**
 	 * Loads the VCMI/H3 map header specified by the name.
+	 * Only header part of the map is read: compressed H3M maps are decompressed only
+	 * up to the end of header and for VCMI maps only header file is extracted from archive
 	 *
 	 * @param name the name of the map
 	 * @return a unique ptr to the loaded map header class
@@ -139,6 +141,7 @@ public:
 
 	/**
 	 * Loads the VCMI/H3 map header.
+	 * Implementations must not read input stream past the header data.
 	 *
 	 * @return a unique ptr of the loaded map header class
 	 */
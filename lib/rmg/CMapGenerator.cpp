@@ -296,23 +296,25 @@ void CMapGenerator::fillZones()
 	//we need info about all town types to evaluate dwellings and pandoras with creatures properly
 	//place main town in the middle
 	Load::Progress::setupStepsTill(map->getZones().size(), 50);
+	std::list<Modificator *> modificators;
 	for (const auto& it : map->getZones())
 	{
 		it.second->initFreeTiles();
+		it.second->getRand().setSeed(rand.nextInt());
 		it.second->initModificators();
+		for(auto * modificator : it.second->getModificators())
+			modificators.push_back(modificator);
 		Progress::Progress::step();
 	}
 
-	Load::Progress::setupStepsTill(map->getZones().size(), 240);
+	Load::Progress::setupStepsTill(modificators.size(), 240);
+	processModificators(modificators);
+
 	std::vector<std::shared_ptr<Zone>> treasureZones;
 	for (const auto& it : map->getZones())
 	{
-		it.second->processModificators();
-
 		if (it.second->getType() == ETemplateZoneType::TREASURE)
 			treasureZones.push_back(it.second);
-
-		Progress::Progress::step();
 	}
 
 	//find place for Grail
@@ -331,6 +333,92 @@ void CMapGenerator::fillZones()
 	Load::Progress::set(250);
 }
 
+void CMapGenerator::processModificators(std::list<Modificator *> modificators)
+{
+	while(!modificators.empty())
+	{
+		//modificators are picked in fixed order, so generated map depends only on seed and not on number of threads
+		auto next = boost::find_if(modificators, [](const Modificator * m)
+		{
+			return m->isReady();
+		});
+
+		if(next == modificators.end())
+		{
+			//circular dependency - modificator will run its unfinished dependencies by itself
+			modificators.front()->run();
+		}
+		else if((*next)->isZoneLocal())
+		{
+			//same stage of all zones that are ready for it can be processed at once
+			std::vector<Modificator *> batch;
+			for(auto * m : modificators)
+			{
+				if(m->isZoneLocal() && m->isReady() && m->getName() == (*next)->getName())
+					batch.push_back(m);
+			}
+			processZoneLocal(batch);
+		}
+		else
+		{
+			(*next)->run();
+		}
+
+		for(auto it = modificators.begin(); it != modificators.end();)
+		{
+			if((*it)->isFinished())
+			{
+				it = modificators.erase(it);
+				Progress::Progress::step();
+			}
+			else
+				++it;
+		}
+	}
+}
+
+void CMapGenerator::processZoneLocal(const std::vector<Modificator *> & batch)
+{
+	std::vector<std::vector<CGObjectInstance *>> objects(batch.size());
+	std::vector<std::exception_ptr> errors(batch.size());
+	std::atomic<size_t> nextTask(0);
+
+	auto worker = [&]()
+	{
+		for(size_t i = nextTask++; i < batch.size(); i = nextTask++)
+		{
+			map->setObjectsQueue(&objects[i]);
+			try
+			{
+				batch[i]->run();
+			}
+			catch(...)
+			{
+				errors[i] = std::current_exception();
+			}
+			map->setObjectsQueue(nullptr);
+		}
+	};
+
+	size_t threadsCount = std::min<size_t>(batch.size(), std::max(1u, boost::thread::hardware_concurrency()));
+
+	boost::thread_group workers;
+	for(size_t i = 1; i < threadsCount; ++i)
+		workers.create_thread(worker);
+	worker();
+	workers.join_all();
+
+	//objects are inserted in order of zones to keep their identifiers independent from thread scheduling
+	for(size_t i = 0; i < batch.size(); ++i)
+	{
+		if(errors[i])
+			std::rethrow_exception(errors[i]);
+
+		for(auto * object : objects[i])
+			map->getEditManager()->insertObject(object);
+	}
+}
+
 void CMapGenerator::findZonesForQuestArts()
 {
 	//we want to place arties in zones that were not yet filled (higher index)
@@ -25,6 +25,7 @@ class JsonNode;
 class RmgMap;
 class CMap;
 class Zone;
+class Modificator;
 
 typedef std::vector<JsonNode> JsonVector;
 
@@ -98,6 +99,8 @@ private:
 	void addHeaderInfo();
 	void genZones();
 	void fillZones();
+	void processModificators(std::list<Modificator *> modificators);
+	void processZoneLocal(const std::vector<Modificator *> & batch);
 
 };
 
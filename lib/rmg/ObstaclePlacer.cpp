@@ -215,7 +215,7 @@ void ObstaclePlacer::process()
 	
 	prohibitedArea = zone.freePaths() + zone.areaUsed() + manager->getVisitableArea();
 		
-	placeObstacles(&map.map(), generator.rand);
+	placeObstacles(&map.map(), zone.getRand());
 }
 
 void ObstaclePlacer::init()
@@ -228,6 +228,12 @@ void ObstaclePlacer::init()
 	DEPENDENCY_ALL(RockPlacer);
 }
 
+bool ObstaclePlacer::isZoneLocal() const
+{
+	//obstacles are placed only within zone area, all dependencies on other zones are resolved by RockPlacer
+	return true;
+}
+
 std::pair<bool, bool> ObstaclePlacer::verifyCoverage(const int3 & t) const
 {
 	return {map.shouldBeBlocked(t), zone.areaPossible().contains(t)};
@@ -56,6 +56,7 @@ public:
 	
 	void process() override;
 	void init() override;
+	bool isZoneLocal() const override;
 	
 	std::pair<bool, bool> verifyCoverage(const int3 & t) const override;
 	
@@ -32,58 +32,241 @@ void toRelative(Tileset & tiles, const int3 & position)
 	toAbsolute(tiles, -position);
 }
 
-Area::Area(const Area & area): dTiles(area.dTiles), dTotalShiftCache(area.dTotalShiftCache)
+Area::Area(const Area & area):
+	dBits(area.dBits),
+	dOrigin(area.dOrigin),
+	dRowWords(area.dRowWords),
+	dHeight(area.dHeight),
+	dLevels(area.dLevels)
 {
 }
 
-Area::Area(Area && area) noexcept: dTiles(std::move(area.dTiles)), dTotalShiftCache(area.dTotalShiftCache)
+Area::Area(Area && area) noexcept:
+	dBits(std::move(area.dBits)),
+	dOrigin(area.dOrigin),
+	dRowWords(area.dRowWords),
+	dHeight(area.dHeight),
+	dLevels(area.dLevels)
 {
+	area.dRowWords = area.dHeight = area.dLevels = 0;
 }
 
 Area & Area::operator=(const Area & area)
 {
-	clear();
-	dTiles = area.dTiles;
-	dTotalShiftCache = area.dTotalShiftCache;
+	invalidate();
+	dBits = area.dBits;
+	dOrigin = area.dOrigin;
+	dRowWords = area.dRowWords;
+	dHeight = area.dHeight;
+	dLevels = area.dLevels;
 	return *this;
 }
 
-Area::Area(Tileset tiles): dTiles(std::move(tiles))
+Area::Area(Tileset tiles)
 {
+	assign(tiles);
 }
 
-Area::Area(Tileset relative, const int3 & position): dTiles(std::move(relative)), dTotalShiftCache(position)
+Area::Area(Tileset relative, const int3 & position)
 {
+	assign(relative);
+	dOrigin += position;
 }
 
 void Area::invalidate()
 {
-	getTiles();
+	dTilesCache.clear();
 	dTilesVectorCache.clear();
 	dBorderCache.clear();
 	dBorderOutsideCache.clear();
 }
 
+static int wordOf(int x)
+{
+	//rounds towards negative infinity
+	return x >= 0 ? x / 64 : -((-x + 63) / 64);
+}
+
+void Area::resize(const int3 & origin, int rowWords, int height, int levels)
+{
+	std::vector<ui64> bits(static_cast<size_t>(rowWords) * height * levels, 0);
+	if(!dBits.empty())
+	{
+		auto * word = bits.data();
+		for(int z = 0; z < levels; ++z)
+			for(int y = 0; y < height; ++y)
+				for(int w = 0; w < rowWords; ++w)
+					*word++ = wordAt(origin.x + w * BITS_PER_WORD, origin.y + y, origin.z + z);
+	}
+
+	dBits.swap(bits);
+	dOrigin = origin;
+	dRowWords = rowWords;
+	dHeight = height;
+	dLevels = levels;
+}
+
+void Area::extend(const int3 & minTile, const int3 & maxTile)
+{
+	if(dBits.empty())
+	{
+		resize(minTile, wordOf(maxTile.x - minTile.x) + 1, maxTile.y - minTile.y + 1, maxTile.z - minTile.z + 1);
+		return;
+	}
+
+	int3 newMin = dOrigin;
+	int3 newMax = dOrigin + int3(dRowWords * BITS_PER_WORD - 1, dHeight - 1, dLevels - 1);
+
+	if(newMin.x <= minTile.x && newMin.y <= minTile.y && newMin.z <= minTile.z
+		&& newMax.x >= maxTile.x && newMax.y >= maxTile.y && newMax.z >= maxTile.z)
+		return;
+
+	//grow with slack, so adding tiles one by one does not reallocate storage every time
+	auto grow = [](int & low, int & high, int requestedLow, int requestedHigh, int slack)
+	{
+		if(requestedLow < low)
+			low = std::min(requestedLow, low - slack);
+		if(requestedHigh > high)
+			high = std::max(requestedHigh, high + slack);
+	};
+	grow(newMin.x, newMax.x, minTile.x, maxTile.x, (newMax.x - newMin.x + 1) / 2);
+	grow(newMin.y, newMax.y, minTile.y, maxTile.y, (newMax.y - newMin.y + 1) / 2);
+	grow(newMin.z, newMax.z, minTile.z, maxTile.z, 0);
+
+	resize(newMin, wordOf(newMax.x - newMin.x) + 1, newMax.y - newMin.y + 1, newMax.z - newMin.z + 1);
+}
+
+int Area::rowIndex(int y, int z) const
+{
+	int row = y - dOrigin.y;
+	int level = z - dOrigin.z;
+	if(row < 0 || row >= dHeight || level < 0 || level >= dLevels)
+		return -1;
+	return (level * dHeight + row) * dRowWords;
+}
+
+ui64 Area::wordAt(int x, int y, int z) const
+{
+	int index = rowIndex(y, z);
+	if(index < 0)
+		return 0;
+
+	int offset = x - dOrigin.x;
+	int word = wordOf(offset);
+	int shift = offset - word * BITS_PER_WORD;
+
+	ui64 result = 0;
+	if(word >= 0 && word < dRowWords)
+		result |= dBits[index + word] >> shift;
+	if(shift != 0 && word + 1 >= 0 && word + 1 < dRowWords)
+		result |= dBits[index + word + 1] << (BITS_PER_WORD - shift);
+	return result;
+}
+
+void Area::setBit(const int3 & tile)
+{
+	int offset = tile.x - dOrigin.x;
+	dBits[rowIndex(tile.y, tile.z) + offset / BITS_PER_WORD] |= ui64(1) << (offset % BITS_PER_WORD);
+}
+
+ui64 Area::erodedWord(int index, int word) const
+{
+	if(index < 0)
+		return 0;
+
+	ui64 current = dBits[index + word];
+	ui64 previous = word > 0 ? dBits[index + word - 1] : 0;
+	ui64 next = word + 1 < dRowWords ? dBits[index + word + 1] : 0;
+
+	return current & ((current << 1) | (previous >> 63)) & ((current >> 1) | (next << 63));
+}
+
+ui64 Area::dilatedWord(int index, int word) const
+{
+	if(index < 0)
+		return 0;
+
+	ui64 current = dBits[index + word];
+	ui64 previous = word > 0 ? dBits[index + word - 1] : 0;
+	ui64 next = word + 1 < dRowWords ? dBits[index + word + 1] : 0;
+
+	return current | (current << 1) | (previous >> 63) | (current >> 1) | (next << 63);
+}
+
+Area Area::eroded() const
+{
+	Area result;
+	result.resize(dOrigin, dRowWords, dHeight, dLevels);
+
+	for(int z = dOrigin.z; z < dOrigin.z + dLevels; ++z)
+	{
+		for(int y = dOrigin.y; y < dOrigin.y + dHeight; ++y)
+		{
+			int index = rowIndex(y, z);
+			int above = rowIndex(y - 1, z);
+			int below = rowIndex(y + 1, z);
+			for(int w = 0; w < dRowWords; ++w)
+				result.dBits[index + w] = erodedWord(above, w) & erodedWord(index, w) & erodedWord(below, w);
+		}
+	}
+	return result;
+}
+
+Area Area::dilated() const
+{
+	//make sure that there is free space around all tiles
+	Area source(*this);
+	source.extend(dOrigin - int3(1, 1, 0), dOrigin + int3(dRowWords * BITS_PER_WORD, dHeight, dLevels - 1));
+
+	Area result;
+	result.resize(source.dOrigin, source.dRowWords, source.dHeight, source.dLevels);
+
+	for(int z = source.dOrigin.z; z < source.dOrigin.z + source.dLevels; ++z)
+	{
+		for(int y = source.dOrigin.y; y < source.dOrigin.y + source.dHeight; ++y)
+		{
+			int index = source.rowIndex(y, z);
+			int above = source.rowIndex(y - 1, z);
+			int below = source.rowIndex(y + 1, z);
+			for(int w = 0; w < source.dRowWords; ++w)
+				result.dBits[index + w] = source.dilatedWord(above, w) | source.dilatedWord(index, w) | source.dilatedWord(below, w);
+		}
+	}
+	return result;
+}
+
+Tileset Area::toTileset() const
+{
+	Tileset result;
+	for(const auto & tile : getTilesVector())
+		result.insert(result.end(), tile);
+	return result;
+}
+
 bool Area::connected() const
 {
-	std::list<int3> queue({*dTiles.begin()});
-	Tileset connected = dTiles; //use invalidated cache - ok
+	if(empty())
+		return true;
+
+	Area remaining(*this);
+	std::list<int3> queue({getTilesVector().front()});
+	remaining.erase(queue.front());
 	while(!queue.empty())
 	{
 		auto t = queue.front();
-		connected.erase(t);
 		queue.pop_front();
 		
 		for(auto & i : int3::getDirs())
 		{
-			if(connected.count(t + i))
+			if(remaining.contains(t + i))
 			{
+				remaining.erase(t + i);
 				queue.push_back(t + i);
 			}
 		}
 	}
 	
-	return connected.empty();
+	return remaining.empty();
 }
 
 std::list<Area> connectedAreas(const Area & area, bool disableDiagonalConnections)
@@ -94,25 +277,24 @@ std::list<Area> connectedAreas(const Area & area, bool disableDiagonalConnection
 		dirs.assign(rmg::dirs4.begin(), rmg::dirs4.end());
 	
 	std::list<Area> result;
-	Tileset connected = area.getTiles();
+	Area connected(area);
 	while(!connected.empty())
 	{
 		result.emplace_back();
-		std::list<int3> queue({*connected.begin()});
-		std::set<int3> queueSet({*connected.begin()});
+		std::list<int3> queue({connected.getTilesVector().front()});
+		connected.erase(queue.front());
 		while(!queue.empty())
 		{
 			auto t = queue.front();
-			connected.erase(t);
 			result.back().add(t);
 			queue.pop_front();
 			
 			for(auto & i : dirs)
 			{
 				auto tile = t + i;
-				if(!queueSet.count(tile) && connected.count(tile) && !result.back().contains(tile))
+				if(connected.contains(tile))
 				{
-					queueSet.insert(tile);
+					connected.erase(tile);
 					queue.push_back(tile);
 				}
 			}
@@ -123,20 +305,33 @@ std::list<Area> connectedAreas(const Area & area, bool disableDiagonalConnection
 
 const Tileset & Area::getTiles() const
 {
-	if(dTotalShiftCache != int3())
-	{
-		toAbsolute(dTiles, dTotalShiftCache);
-		dTotalShiftCache = int3();
-	}
-	return dTiles;
+	if(dTilesCache.empty())
+		dTilesCache = toTileset();
+	return dTilesCache;
 }
 
 const std::vector<int3> & Area::getTilesVector() const
 {
 	if(dTilesVectorCache.empty())
 	{
-		getTiles();
-		dTilesVectorCache.assign(dTiles.begin(), dTiles.end());
+		for(int z = 0; z < dLevels; ++z)
+		{
+			for(int y = 0; y < dHeight; ++y)
+			{
+				const auto * row = dBits.data() + (z * dHeight + y) * dRowWords;
+				for(int w = 0; w < dRowWords; ++w)
+				{
+					if(!row[w])
+						continue;
+
+					for(int bit = 0; bit < BITS_PER_WORD; ++bit)
+					{
+						if((row[w] >> bit) & 1)
+							dTilesVectorCache.push_back(dOrigin + int3(w * BITS_PER_WORD + bit, y, z));
+					}
+				}
+			}
+		}
 	}
 	return dTilesVectorCache;
 }
@@ -146,19 +341,13 @@ const Tileset & Area::getBorder() const
 	if(!dBorderCache.empty())
 		return dBorderCache;
 	
-	//compute border cache
-	for(const auto & t : dTiles)
-	{
-		for(auto & i : int3::getDirs())
-		{
-			if(!dTiles.count(t + i))
-			{
-				dBorderCache.insert(t + dTotalShiftCache);
-				break;
-			}
-		}
-	}
-	
+	//border tiles are tiles that have at least one neighbour outside of area
+	Area border(*this);
+	Area interior = eroded();
+	for(size_t i = 0; i < border.dBits.size(); ++i)
+		border.dBits[i] &= ~interior.dBits[i];
+
+	dBorderCache = border.toTileset();
 	return dBorderCache;
 }
 
@@ -167,16 +356,11 @@ const Tileset & Area::getBorderOutside() const
 	if(!dBorderOutsideCache.empty())
 		return dBorderOutsideCache;
 	
-	//compute outside border cache
-	for(const auto & t : dTiles)
-	{
-		for(auto & i : int3::getDirs())
-		{
-			if(!dTiles.count(t + i))
-				dBorderOutsideCache.insert(t + i + dTotalShiftCache);
-		}
-	}
-	
+	//outside border tiles are neighbours of area tiles that are not in area
+	Area border = dilated();
+	border.subtract(*this);
+
+	dBorderOutsideCache = border.toTileset();
 	return dBorderOutsideCache;
 }
 
@@ -184,27 +368,40 @@ DistanceMap Area::computeDistanceMap(std::map<int, Tileset> & reverseDistanceMap
 {
 	reverseDistanceMap.clear();
 	DistanceMap result;
-	auto area = *this;
+	Area area(*this);
 	int distance = 0;
 	
 	while(!area.empty())
 	{
-		for(const auto & tile : area.getBorder())
+		Area interior = area.eroded();
+		for(size_t i = 0; i < area.dBits.size(); ++i)
+			area.dBits[i] &= ~interior.dBits[i];
+
+		for(const auto & tile : area.getTilesVector())
 			result[tile] = distance;
-		reverseDistanceMap[distance++] = area.getBorder();
-		area.subtract(area.getBorder());
+		reverseDistanceMap[distance++] = area.toTileset();
+
+		area.invalidate();
+		area.dBits.swap(interior.dBits);
 	}
 	return result;
 }
 
 bool Area::empty() const
 {
-	return dTiles.empty();
+	return std::all_of(dBits.begin(), dBits.end(), [](ui64 word)
+	{
+		return word == 0;
+	});
 }
 
 bool Area::contains(const int3 & tile) const
 {
-	return dTiles.count(tile - dTotalShiftCache);
+	int index = rowIndex(tile.y, tile.z);
+	int offset = tile.x - dOrigin.x;
+	if(index < 0 || offset < 0 || offset >= dRowWords * BITS_PER_WORD)
+		return false;
+	return (dBits[index + offset / BITS_PER_WORD] >> (offset % BITS_PER_WORD)) & 1;
 }
 
 bool Area::contains(const std::vector<int3> & tiles) const
@@ -219,7 +416,19 @@ bool Area::contains(const std::vector<int3> & tiles) const
 
 bool Area::contains(const Area & area) const
 {
-	return contains(area.getTilesVector());
+	for(int z = 0; z < area.dLevels; ++z)
+	{
+		for(int y = 0; y < area.dHeight; ++y)
+		{
+			const auto * row = area.dBits.data() + (z * area.dHeight + y) * area.dRowWords;
+			for(int w = 0; w < area.dRowWords; ++w)
+			{
+				if(row[w] & ~wordAt(area.dOrigin.x + w * BITS_PER_WORD, area.dOrigin.y + y, area.dOrigin.z + z))
+					return false;
+			}
+		}
+	}
+	return true;
 }
 
 bool Area::overlap(const std::vector<int3> & tiles) const
@@ -234,7 +443,23 @@ bool Area::overlap(const std::vector<int3> & tiles) const
 
 bool Area::overlap(const Area & area) const
 {
-	return overlap(area.getTilesVector());
+	//iterate over smaller area
+	if(area.dBits.size() > dBits.size())
+		return area.overlap(*this);
+
+	for(int z = 0; z < area.dLevels; ++z)
+	{
+		for(int y = 0; y < area.dHeight; ++y)
+		{
+			const auto * row = area.dBits.data() + (z * area.dHeight + y) * area.dRowWords;
+			for(int w = 0; w < area.dRowWords; ++w)
+			{
+				if(row[w] & wordAt(area.dOrigin.x + w * BITS_PER_WORD, area.dOrigin.y + y, area.dOrigin.z + z))
+					return true;
+			}
+		}
+	}
+	return false;
 }
 
 int Area::distanceSqr(const int3 & tile) const
@@ -282,84 +507,129 @@ int3 Area::nearest(const Area & area) const
 Area Area::getSubarea(const std::function<bool(const int3 &)> & filter) const
 {
 	Area subset;
+	subset.resize(dOrigin, dRowWords, dHeight, dLevels);
 	for(const auto & t : getTilesVector())
 		if(filter(t))
-			subset.add(t);
+			subset.setBit(t);
 	return subset;
 }
 
 void Area::clear()
 {
-	dTiles.clear();
-	dTotalShiftCache = int3();
+	dBits.clear();
+	dOrigin = int3();
+	dRowWords = dHeight = dLevels = 0;
 	invalidate();
 }
 
 void Area::assign(const Tileset tiles)
 {
 	clear();
-	dTiles = tiles;
+	if(tiles.empty())
+		return;
+
+	//tiles are sorted by level and row, only column range is unknown
+	int3 minTile = *tiles.begin();
+	int3 maxTile = *tiles.rbegin();
+	for(const auto & t : tiles)
+	{
+		vstd::amin(minTile.x, t.x);
+		vstd::amin(minTile.y, t.y);
+		vstd::amax(maxTile.x, t.x);
+		vstd::amax(maxTile.y, t.y);
+	}
+
+	extend(minTile, maxTile);
+	for(const auto & t : tiles)
+		setBit(t);
 }
 
 void Area::add(const int3 & tile)
 {
 	invalidate();
-	dTiles.insert(tile);
+	extend(tile, tile);
+	setBit(tile);
 }
 
 void Area::erase(const int3 & tile)
 {
+	if(!contains(tile))
+		return;
+
 	invalidate();
-	dTiles.erase(tile);
+	int offset = tile.x - dOrigin.x;
+	dBits[rowIndex(tile.y, tile.z) + offset / BITS_PER_WORD] &= ~(ui64(1) << (offset % BITS_PER_WORD));
 }
+
 void Area::unite(const Area & area)
 {
+	if(area.dBits.empty())
+		return;
+
 	invalidate();
-	for(const auto & t : area.getTilesVector())
+	extend(area.dOrigin, area.dOrigin + int3(area.dRowWords * BITS_PER_WORD - 1, area.dHeight - 1, area.dLevels - 1));
+
+	int firstWord = wordOf(area.dOrigin.x - dOrigin.x);
+	int lastWord = std::min(dRowWords - 1, wordOf(area.dOrigin.x + area.dRowWords * BITS_PER_WORD - 1 - dOrigin.x));
+	for(int z = area.dOrigin.z; z < area.dOrigin.z + area.dLevels; ++z)
 	{
-		dTiles.insert(t);
+		for(int y = area.dOrigin.y; y < area.dOrigin.y + area.dHeight; ++y)
+		{
+			int index = rowIndex(y, z);
+			for(int w = firstWord; w <= lastWord; ++w)
+				dBits[index + w] |= area.wordAt(dOrigin.x + w * BITS_PER_WORD, y, z);
+		}
 	}
 }
+
 void Area::intersect(const Area & area)
 {
 	invalidate();
-	Tileset result;
-	for(const auto & t : area.getTilesVector())
+	for(int z = 0; z < dLevels; ++z)
 	{
-		if(dTiles.count(t))
-			result.insert(t);
+		for(int y = 0; y < dHeight; ++y)
+		{
+			auto * row = dBits.data() + (z * dHeight + y) * dRowWords;
+			for(int w = 0; w < dRowWords; ++w)
+			{
+				if(row[w])
+					row[w] &= area.wordAt(dOrigin.x + w * BITS_PER_WORD, dOrigin.y + y, dOrigin.z + z);
+			}
+		}
 	}
-	dTiles = result;
 }
 
 void Area::subtract(const Area & area)
 {
 	invalidate();
-	for(const auto & t : area.getTilesVector())
+
+	//only rows and columns that overlap with other area can change
+	int firstWord = std::max(0, wordOf(area.dOrigin.x - dOrigin.x));
+	int lastWord = std::min(dRowWords - 1, wordOf(area.dOrigin.x + area.dRowWords * BITS_PER_WORD - 1 - dOrigin.x));
+	for(int z = std::max(dOrigin.z, area.dOrigin.z); z < std::min(dOrigin.z + dLevels, area.dOrigin.z + area.dLevels); ++z)
 	{
-		dTiles.erase(t);
+		for(int y = std::max(dOrigin.y, area.dOrigin.y); y < std::min(dOrigin.y + dHeight, area.dOrigin.y + area.dHeight); ++y)
+		{
+			int index = rowIndex(y, z);
+			for(int w = firstWord; w <= lastWord; ++w)
+				dBits[index + w] &= ~area.wordAt(dOrigin.x + w * BITS_PER_WORD, y, z);
+		}
 	}
 }
 
 void Area::translate(const int3 & shift)
 {
+	dTilesCache.clear();
 	dBorderCache.clear();
 	dBorderOutsideCache.clear();
 	
-	if(dTilesVectorCache.empty())
-	{
-		getTiles();
-		getTilesVector();
-	}
-	
-	//avoid recomputation within std::set, use vector instead
-	dTotalShiftCache += shift;
+	dOrigin += shift;
 	
+	//translation does not change order of tiles
 	for(auto & t : dTilesVectorCache)
 	{
 		t += shift;
 	}
-	//toAbsolute(dTiles, shift);
 }
 
 Area operator- (const Area & l, const int3 & r)
@@ -399,7 +669,7 @@ Area operator* (const Area & l, const Area & r)
 
 bool operator== (const Area & l, const Area & r)
 {
-	return l.getTiles() == r.getTiles();
+	return l.getTilesVector() == r.getTilesVector();
 }
 
 }
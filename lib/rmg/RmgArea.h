@@ -74,16 +74,42 @@ namespace rmg
 		friend std::list<Area> connectedAreas(const Area & area, bool disableDiagonalConnections);
 		
 	private:
+		static constexpr int BITS_PER_WORD = 64;
 		
 		void invalidate();
-		void computeBorderCache();
-		void computeBorderOutsideCache();
 		
-		mutable Tileset dTiles;
+		/// grows bounding box so it includes all tiles between minTile and maxTile
+		void extend(const int3 & minTile, const int3 & maxTile);
+		void resize(const int3 & origin, int rowWords, int height, int levels);
+		void setBit(const int3 & tile);
+		
+		/// index of first word of row, or -1 if row is outside bounding box
+		int rowIndex(int y, int z) const;
+		/// 64 tiles of row starting at given x as bit mask, tiles outside bounding box are not set
+		ui64 wordAt(int x, int y, int z) const;
+		/// tiles of row that have both horizontal neighbours in area, or either of them for dilation
+		ui64 erodedWord(int index, int word) const;
+		ui64 dilatedWord(int index, int word) const;
+		
+		/// tiles that have all 8 neighbours in area
+		Area eroded() const;
+		/// tiles of area and all their neighbours
+		Area dilated() const;
+		
+		Tileset toTileset() const;
+		
+		/// tiles are stored as bit planes over bounding box: one bit per tile, rows of 64-bit words
+		/// translation only moves origin of bounding box
+		std::vector<ui64> dBits;
+		int3 dOrigin;
+		int dRowWords = 0;
+		int dHeight = 0;
+		int dLevels = 0;
+		
+		mutable Tileset dTilesCache;
 		mutable std::vector<int3> dTilesVectorCache;
 		mutable Tileset dBorderCache;
 		mutable Tileset dBorderOutsideCache;
-		mutable int3 dTotalShiftCache;
 	};
 }
 
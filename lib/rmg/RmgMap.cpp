@@ -36,7 +36,7 @@
 VCMI_LIB_NAMESPACE_BEGIN
 
 RmgMap::RmgMap(const CMapGenOptions& mapGenOptions) :
-	mapGenOptions(mapGenOptions), zonesTotal(0)
+	mapGenOptions(mapGenOptions), zonesTotal(0), objectsQueue([](std::vector<CGObjectInstance *> *){})
 {
 	mapInstance = std::make_unique<CMap>();
 	getEditManager()->getUndoManager().setUndoRedoLimit(0);
@@ -162,6 +162,19 @@ CMapEditManager* RmgMap::getEditManager() const
 	return mapInstance->getEditManager();
 }
 
+void RmgMap::insertObject(CGObjectInstance * object)
+{
+	if(objectsQueue.get())
+		objectsQueue->push_back(object);
+	else
+		getEditManager()->insertObject(object);
+}
+
+void RmgMap::setObjectsQueue(std::vector<CGObjectInstance *> * queue)
+{
+	objectsQueue.reset(queue);
+}
+
 bool RmgMap::isOnMap(const int3 & tile) const
 {
 	return mapInstance->isInTheMap(tile);
@@ -20,6 +20,7 @@ class TileInfo;
 class CMapGenOptions;
 class Zone;
 class CMapGenerator;
+class CGObjectInstance;
 
 class RmgMap
 {
@@ -31,6 +32,11 @@ public:
 	~RmgMap() = default;
 
 	CMapEditManager* getEditManager() const;
+
+	/// inserts object into map, or into objects queue of current thread if one was set
+	void insertObject(CGObjectInstance * object);
+	/// objects inserted by current thread will be added to provided queue instead of map until queue is reset to nullptr
+	void setObjectsQueue(std::vector<CGObjectInstance *> * queue);
 	const CMapGenOptions& getMapGenOptions() const;
 
 	void foreach_neighbour(const int3 & pos, const std::function<void(int3 & pos)> & foo) const;
@@ -80,6 +86,7 @@ private:
 	const CMapGenOptions& mapGenOptions;
 	boost::multi_array<TileInfo, 3> tiles; //[x][y][z]
 	boost::multi_array<TRmgTemplateZoneId, 3> zoneColouring; //[x][y][z]
+	boost::thread_specific_ptr<std::vector<CGObjectInstance *>> objectsQueue; //not owned
 };
 
 VCMI_LIB_NAMESPACE_END
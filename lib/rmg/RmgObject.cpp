@@ -336,7 +336,7 @@ void Object::Instance::finalize(RmgMap & map)
 		map.setOccupied(tile, ETileType::ETileType::USED);
 	}
 	
-	map.getEditManager()->insertObject(&dObject);
+	map.insertObject(&dObject);
 }
 
 void Object::finalize(RmgMap & map)
@@ -82,7 +82,7 @@ void RoadPlacer::drawRoads(bool secondary)
 
 	std::string roadName = (secondary ? generator.getConfig().secondaryRoadType : generator.getConfig().defaultRoadType);
 	RoadId roadType(*VLC->modh->identifiers.getIdentifier(CModHandler::scopeGame(), "road", roadName));
-	map.getEditManager()->drawRoad(roadType, &generator.rand);
+	map.getEditManager()->drawRoad(roadType, &zone.getRand());
 }
 
 void RoadPlacer::addRoadNode(const int3& node)
@@ -59,7 +59,7 @@ void RockPlacer::processMap()
 		if(auto * m = z.second->getModificator<RockPlacer>())
 		{
 			map.getEditManager()->getTerrainSelection().setSelection(m->rockArea.getTilesVector());
-			map.getEditManager()->drawTerrain(m->rockTerrain, &generator.rand);
+			map.getEditManager()->drawTerrain(m->rockTerrain, &zone.getRand());
 		}
 	}
 	
@@ -69,7 +69,7 @@ void RockPlacer::processMap()
 		{
 			//now make sure all accessible tiles have no additional rock on them
 			map.getEditManager()->getTerrainSelection().setSelection(m->accessibleArea.getTilesVector());
-			map.getEditManager()->drawTerrain(z.second->getTerrainType(), &generator.rand);
+			map.getEditManager()->drawTerrain(z.second->getTerrainType(), &zone.getRand());
 			m->postProcess();
 		}
 	}
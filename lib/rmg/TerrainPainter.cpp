@@ -24,7 +24,7 @@ VCMI_LIB_NAMESPACE_BEGIN
 void TerrainPainter::process()
 {
 	initTerrainType(zone, generator);
-	paintZoneTerrain(zone, generator.rand, map, zone.getTerrainType());
+	paintZoneTerrain(zone, zone.getRand(), map, zone.getTerrainType());
 }
 
 void TerrainPainter::init()
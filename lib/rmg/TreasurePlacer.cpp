@@ -109,7 +109,7 @@ void TreasurePlacer::addAllPossibleObjects()
 					possibleHeroes.push_back(j);
 			}
 			
-			auto hid = *RandomGeneratorUtil::nextItem(possibleHeroes, generator.rand);
+			auto hid = *RandomGeneratorUtil::nextItem(possibleHeroes, zone.getRand());
 			auto factory = VLC->objtypeh->getHandlerFor(Obj::PRISON, 0);
 			auto * obj = dynamic_cast<CGHeroInstance *>(factory->create());
 
@@ -204,7 +204,7 @@ void TreasurePlacer::addAllPossibleObjects()
 					out.push_back(spell->id);
 				}
 			}
-			auto * a = CArtifactInstance::createScroll(*RandomGeneratorUtil::nextItem(out, generator.rand));
+			auto * a = CArtifactInstance::createScroll(*RandomGeneratorUtil::nextItem(out, zone.getRand()));
 			obj->storedArtifact = a;
 			return obj;
 		};
@@ -318,7 +318,7 @@ void TreasurePlacer::addAllPossibleObjects()
 					spells.push_back(spell);
 			}
 			
-			RandomGeneratorUtil::randomShuffle(spells, generator.rand);
+			RandomGeneratorUtil::randomShuffle(spells, zone.getRand());
 			for(int j = 0; j < std::min(12, static_cast<int>(spells.size())); j++)
 			{
 				obj->spells.push_back(spells[j]->id);
@@ -347,7 +347,7 @@ void TreasurePlacer::addAllPossibleObjects()
 					spells.push_back(spell);
 			}
 			
-			RandomGeneratorUtil::randomShuffle(spells, generator.rand);
+			RandomGeneratorUtil::randomShuffle(spells, zone.getRand());
 			for(int j = 0; j < std::min(15, static_cast<int>(spells.size())); j++)
 			{
 				obj->spells.push_back(spells[j]->id);
@@ -375,7 +375,7 @@ void TreasurePlacer::addAllPossibleObjects()
 				spells.push_back(spell);
 		}
 		
-		RandomGeneratorUtil::randomShuffle(spells, generator.rand);
+		RandomGeneratorUtil::randomShuffle(spells, zone.getRand());
 		for(int j = 0; j < std::min(60, static_cast<int>(spells.size())); j++)
 		{
 			obj->spells.push_back(spells[j]->id);
@@ -408,7 +408,7 @@ void TreasurePlacer::addAllPossibleObjects()
 		}
 		oi.maxPerZone = seerHutsPerType;
 		
-		RandomGeneratorUtil::randomShuffle(creatures, generator.rand);
+		RandomGeneratorUtil::randomShuffle(creatures, zone.getRand());
 
 		auto generateArtInfo = [this](const ArtifactID & id) -> ObjectInfo
 		{
@@ -433,7 +433,7 @@ void TreasurePlacer::addAllPossibleObjects()
 			if(!creaturesAmount)
 				continue;
 			
-			int randomAppearance = chooseRandomAppearance(generator.rand, Obj::SEER_HUT, zone.getTerrainType());
+			int randomAppearance = chooseRandomAppearance(zone.getRand(), Obj::SEER_HUT, zone.getTerrainType());
 			
 			oi.generateObject = [creature, creaturesAmount, randomAppearance, this, generateArtInfo]() -> CGObjectInstance *
 			{
@@ -444,7 +444,7 @@ void TreasurePlacer::addAllPossibleObjects()
 				obj->rVal = creaturesAmount;
 				
 				obj->quest->missionType = CQuest::MISSION_ART;
-				ArtifactID artid = *RandomGeneratorUtil::nextItem(generator.getQuestArtsRemaning(), generator.rand);
+				ArtifactID artid = *RandomGeneratorUtil::nextItem(generator.getQuestArtsRemaning(), zone.getRand());
 				obj->quest->addArtifactID(artid);
 				obj->quest->lastDay = -1;
 				obj->quest->isCustomFirst = obj->quest->isCustomNext = obj->quest->isCustomComplete = false;
@@ -465,7 +465,7 @@ void TreasurePlacer::addAllPossibleObjects()
 		static int seerLevels = std::min(generator.getConfig().questValues.size(), generator.getConfig().questRewardValues.size());
 		for(int i = 0; i < seerLevels; i++) //seems that code for exp and gold reward is similiar
 		{
-			int randomAppearance = chooseRandomAppearance(generator.rand, Obj::SEER_HUT, zone.getTerrainType());
+			int randomAppearance = chooseRandomAppearance(zone.getRand(), Obj::SEER_HUT, zone.getTerrainType());
 			
 			oi.setTemplate(Obj::SEER_HUT, randomAppearance, zone.getTerrainType());
 			oi.value = generator.getConfig().questValues[i];
@@ -481,7 +481,7 @@ void TreasurePlacer::addAllPossibleObjects()
 				obj->rVal = generator.getConfig().questRewardValues[i];
 				
 				obj->quest->missionType = CQuest::MISSION_ART;
-				ArtifactID artid = *RandomGeneratorUtil::nextItem(generator.getQuestArtsRemaning(), generator.rand);
+				ArtifactID artid = *RandomGeneratorUtil::nextItem(generator.getQuestArtsRemaning(), zone.getRand());
 				obj->quest->addArtifactID(artid);
 				obj->quest->lastDay = -1;
 				obj->quest->isCustomFirst = obj->quest->isCustomNext = obj->quest->isCustomComplete = false;
@@ -504,7 +504,7 @@ void TreasurePlacer::addAllPossibleObjects()
 				obj->rVal = generator.getConfig().questRewardValues[i];
 				
 				obj->quest->missionType = CQuest::MISSION_ART;
-				ArtifactID artid = *RandomGeneratorUtil::nextItem(generator.getQuestArtsRemaning(), generator.rand);
+				ArtifactID artid = *RandomGeneratorUtil::nextItem(generator.getQuestArtsRemaning(), zone.getRand());
 				obj->quest->addArtifactID(artid);
 				obj->quest->lastDay = -1;
 				obj->quest->isCustomFirst = obj->quest->isCustomNext = obj->quest->isCustomComplete = false;
@@ -537,7 +537,7 @@ std::vector<ObjectInfo*> TreasurePlacer::prepareTreasurePile(const CTreasureInfo
 	int maxValue = treasureInfo.max;
 	int minValue = treasureInfo.min;
 	
-	const ui32 desiredValue = generator.rand.nextInt(minValue, maxValue);
+	const ui32 desiredValue = zone.getRand().nextInt(minValue, maxValue);
 	
 	int currentValue = 0;
 	bool hasLargeObject = false;
@@ -615,7 +615,7 @@ rmg::Object TreasurePlacer::constructTreasurePile(const std::vector<ObjectInfo*>
 				bestPositions = accessibleArea.getTilesVector();
 			}
 			
-			int3 nextPos = *RandomGeneratorUtil::nextItem(bestPositions, generator.rand);
+			int3 nextPos = *RandomGeneratorUtil::nextItem(bestPositions, zone.getRand());
 			instance.setPosition(nextPos - rmgObject.getPosition());
 			
 			auto instanceAccessibleArea = instance.getAccessibleArea();
@@ -670,7 +670,7 @@ ObjectInfo * TreasurePlacer::getRandomObject(ui32 desiredValue, ui32 currentValu
 	}
 	else
 	{
-		int r = generator.rand.nextInt(1, total);
+		int r = zone.getRand().nextInt(1, total);
 		auto sorter = [](const std::pair<ui32, ObjectInfo *> & rhs, const ui32 lhs) -> bool 
 		{
 			return static_cast<int>(rhs.first) < lhs; 
@@ -123,6 +123,11 @@ rmg::Area & Zone::freePaths()
 	return dAreaFree;
 }
 
+CRandomGenerator & Zone::getRand()
+{
+	return rand;
+}
+
 FactionID Zone::getTownType() const
 {
 	return FactionID(townType);
@@ -206,7 +211,7 @@ void Zone::fractalize()
 		{
 			//link tiles in random order
 			std::vector<int3> tilesToMakePath = possibleTiles.getTilesVector();
-			RandomGeneratorUtil::randomShuffle(tilesToMakePath, generator.rand);
+			RandomGeneratorUtil::randomShuffle(tilesToMakePath, rand);
 			
 			int3 nodeFound(-1, -1, -1);
 
@@ -281,21 +286,12 @@ void Zone::initModificators()
 	logGlobal->info("Zone %d modificators initialized", getId());
 }
 
-void Zone::processModificators()
+std::vector<Modificator *> Zone::getModificators() const
 {
-	for(auto & modificator : modificators)
-	{
-		try
-		{
-			modificator->run();
-		}
-		catch (const rmgException & e)
-		{
-			logGlobal->info("Zone %d, modificator %s - FAILED: %s", getId(), e.what());
-			throw e;
-		}
-	}
-	logGlobal->info("Zone %d filled successfully", getId());
+	std::vector<Modificator *> result;
+	for(const auto & modificator : modificators)
+		result.push_back(modificator.get());
+	return result;
 }
 
 Modificator::Modificator(Zone & zone, RmgMap & map, CMapGenerator & generator) : zone(zone), map(map), generator(generator)
@@ -317,6 +313,16 @@ bool Modificator::isFinished() const
 	return finished;
 }
 
+bool Modificator::isReady() const
+{
+	for(const auto * modificator : preceeders)
+	{
+		if(!modificator->finished)
+			return false;
+	}
+	return true;
+}
+
 void Modificator::run()
 {
 	started = true;
@@ -13,6 +13,7 @@
 #include "../GameConstants.h"
 #include "float3.h"
 #include "../int3.h"
+#include "../CRandomGenerator.h"
 #include "CRmgTemplate.h"
 #include "RmgArea.h"
 #include "RmgPath.h"
@@ -50,6 +51,10 @@ public:
 	virtual char dump(const int3 &);
 	virtual ~Modificator() = default;
 
+	/// Modificator that reads and modifies only tiles and objects of its own zone can be processed in parallel with modificators of the same type in other zones
+	/// Objects placed by such modificator are inserted into map only after all zones in batch are processed, in order of zones
+	virtual bool isZoneLocal() const { return false; }
+
 	void setName(const std::string & n);
 	const std::string & getName() const;
 	
@@ -57,13 +62,15 @@ public:
 	void dependency(Modificator * modificator);
 	void postfunction(Modificator * modificator);
 
+	bool isFinished() const;
+	/// returns true if all modificators this one depends on are finished
+	bool isReady() const;
+
 protected:
 	RmgMap & map;
 	CMapGenerator & generator;
 	Zone & zone;
 	
-	bool isFinished() const;
-	
 private:
 	std::string name;
 	bool started = false;
@@ -98,6 +105,9 @@ public:
 	void clearTiles();
 	void fractalize();
 	
+	/// random generator used by modificators of this zone, independent from other zones so result does not depends on order in which zones are processed
+	CRandomGenerator & getRand();
+
 	FactionID getTownType() const;
 	void setTownType(si32 town);
 	TerrainId getTerrainType() const;
@@ -123,7 +133,7 @@ public:
 	}
 	
 	void initModificators();
-	void processModificators();
+	std::vector<Modificator *> getModificators() const;
 	
 protected:
 	CMapGenerator & generator;
@@ -141,6 +151,8 @@ protected:
 	//template info
 	si32 townType;
 	TerrainId terrainType;
+
+	CRandomGenerator rand;
 	
 };
 
@@ -14,7 +14,7 @@
 
 VCMI_LIB_NAMESPACE_BEGIN
 
-const ui32 SERIALIZATION_VERSION = 822;
+const ui32 SERIALIZATION_VERSION = 823;
 const ui32 MINIMAL_SERIALIZATION_VERSION = 822;
 const std::string SAVEGAME_MAGIC = "VCMISVG";
 
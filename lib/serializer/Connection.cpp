@@ -9,6 +9,7 @@
  */
 #include "StdInc.h"
 #include "Connection.h"
+#include "PackStatistics.h"
 
 #include "../registerTypes/RegisterTypes.h"
 #include "../mapping/CMap.h"
@@ -21,13 +22,58 @@ VCMI_LIB_NAMESPACE_BEGIN
 using namespace boost;
 using namespace boost::asio::ip;
 
+/// Every pack is sent as frame with size of serialized pack in front of it
+static constexpr size_t FRAME_HEADER_SIZE = 4;
+
 struct ConnectionBuffers
 {
 	boost::asio::streambuf readBuffer;
 	boost::asio::streambuf writeBuffer;
+
+	// asynchronous mode, members below are used by thread that runs io_service unless stated otherwise
+	bool asyncMode = false;
+	/// socket is never reset in asynchronous mode, so that it can be used by thread that runs io_service
+	std::shared_ptr<TSocket> socket;
+	CConnection::FrameHandler onFrame;
+	CConnection::ErrorHandler onError;
+	CConnection::HandshakeHandler onHandshake;
+
+	std::array<ui8, FRAME_HEADER_SIZE> header;
+	std::vector<ui8> body;
+
+	// guards members below, which are also used by threads that send and process packs
+	boost::mutex mx;
+
+	bool failed = false;
+	bool writing = false;
+	std::deque<CConnection::SharedFrame> writeQueue;
+	size_t queuedWriteBytes = 0;
+
+	bool readPaused = false;
+	size_t unprocessedReadBytes = 0;
 };
 
-void CConnection::init()
+static ui32 readFrameHeader(const std::array<ui8, FRAME_HEADER_SIZE> & header)
+{
+	return header[0] | (header[1] << 8) | (header[2] << 16) | (static_cast<ui32>(header[3]) << 24);
+}
+
+/// first string of identification, connections with different protocol are rejected before any pack is sent
+static std::string protocolGreeting()
+{
+	return "Aiya! VCMI protocol " + std::to_string(SERIALIZATION_VERSION) + "\n";
+}
+
+static void postToSocket(const std::shared_ptr<TSocket> & socket, const std::function<void()> & task)
+{
+#if BOOST_VERSION >= 107000  // Boost version >= 1.70
+	boost::asio::post(socket->get_executor(), task);
+#else
+	socket->get_io_service().post(task);
+#endif
+}
+
+void CConnection::initSocket()
 {
 	enableBufferedWrite = false;
 	enableBufferedRead = false;
@@ -54,19 +100,39 @@ void CConnection::init()
 	myEndianess = false;
 #endif
 	connected = true;
+}
+
+void CConnection::init()
+{
+	initSocket();
+
+	std::string greeting;
 	std::string pom;
 	//we got connection
-	oser & std::string("Aiya!\n") & name & uuid & myEndianess; //identify ourselves
-	iser & pom & pom & contactUuid & contactEndianess;
-	logNetwork->info("Established connection with %s. UUID: %s", pom, contactUuid);
+	oser & protocolGreeting() & name & uuid & myEndianess; //identify ourselves
+	iser & greeting & pom & contactUuid & contactEndianess;
+
+	if(greeting != protocolGreeting())
+	{
+		logNetwork->error("Connection with %s rejected, protocol does not match: %s", pom, greeting);
+		close();
+		throw std::runtime_error("Can't establish connection: protocol of other side does not match");
+	}
+
+	handshakeFinished(pom);
+}
+
+void CConnection::handshakeFinished(const std::string & contactName)
+{
+	logNetwork->info("Established connection with %s. UUID: %s", contactName, contactUuid);
 	mutexRead = std::make_shared<boost::mutex>();
 	mutexWrite = std::make_shared<boost::mutex>();
 
 	iser.fileVersion = SERIALIZATION_VERSION;
 }
 
-CConnection::CConnection(const std::string & host, ui16 port, std::string Name, std::string UUID):
-	io_service(std::make_shared<asio::io_service>()),
+CConnection::CConnection(const std::string & host, ui16 port, std::string Name, std::string UUID, std::shared_ptr<boost::asio::io_service> Io_service):
+	io_service(Io_service ? std::move(Io_service) : std::make_shared<asio::io_service>()),
 	iser(this),
 	oser(this),
 	name(std::move(Name)),
@@ -125,6 +191,116 @@ CConnection::CConnection(std::shared_ptr<TSocket> Socket, std::string Name, std:
 {
 	init();
 }
+
+CConnection::CConnection(std::shared_ptr<TSocket> Socket, std::string Name, std::string UUID, AsyncHandshake):
+	iser(this),
+	oser(this),
+	socket(std::move(Socket)),
+	name(std::move(Name)),
+	uuid(std::move(UUID))
+{
+	initSocket();
+}
+
+void CConnection::acceptAsync(std::shared_ptr<TSocket> Socket, std::string Name, std::string UUID, HandshakeHandler onHandshake)
+{
+	std::shared_ptr<CConnection> c(new CConnection(std::move(Socket), std::move(Name), std::move(UUID), AsyncHandshake()));
+	auto & buffers = *c->connectionBuffers;
+
+	buffers.onHandshake = std::move(onHandshake);
+
+	c->enableBufferedWrite = true;
+	c->oser & protocolGreeting() & c->name & c->uuid & c->myEndianess;
+	c->enableBufferedWrite = false;
+
+	auto identification = std::make_shared<std::vector<ui8>>(buffers.writeBuffer.size());
+	buffers.writeBuffer.sgetn(reinterpret_cast<char *>(identification->data()), identification->size());
+
+	//both sides send their identification before reading identification of other side
+	auto activeSocket = c->socket;
+	asio::async_write(*activeSocket, asio::buffer(*identification), [c, activeSocket, identification](const boost::system::error_code & ec, size_t)
+	{
+		if(ec)
+		{
+			c->connected = false;
+			c->connectionBuffers->onHandshake(c, ec.message());
+			return;
+		}
+
+		//greeting, name and uuid followed by endianness
+		c->asyncReadHandshake(3);
+	});
+}
+
+void CConnection::asyncReadHandshake(int stringsLeft)
+{
+	auto self = shared_from_this();
+	auto activeSocket = socket;
+	auto & buffers = *connectionBuffers;
+
+	auto fail = [self](const std::string & error)
+	{
+		self->connected = false;
+		self->connectionBuffers->onHandshake(self, error);
+	};
+
+	if(stringsLeft == 0)
+	{
+		asio::async_read(*activeSocket, asio::buffer(buffers.header.data(), 1), [self, activeSocket, fail](const boost::system::error_code & ec, size_t)
+		{
+			if(ec)
+				return fail(ec.message());
+
+			auto & buffers = *self->connectionBuffers;
+			buffers.body.push_back(buffers.header[0]);
+
+			std::string greeting;
+			std::string pom;
+			buffers.readBuffer.sputn(reinterpret_cast<const char *>(buffers.body.data()), buffers.body.size());
+			buffers.body.clear();
+
+			self->enableBufferedRead = true;
+			self->iser & greeting & pom & self->contactUuid & self->contactEndianess;
+			self->enableBufferedRead = false;
+
+			if(greeting != protocolGreeting())
+				return fail(boost::str(boost::format("protocol of %s does not match: %s") % pom % greeting));
+
+			self->handshakeFinished(pom);
+			buffers.onHandshake(self, std::string());
+		});
+		return;
+	}
+
+	asio::async_read(*activeSocket, asio::buffer(buffers.header), [self, activeSocket, fail, stringsLeft](const boost::system::error_code & ec, size_t)
+	{
+		if(ec)
+			return fail(ec.message());
+
+		auto & buffers = *self->connectionBuffers;
+
+		//length of string is read in native byte order, same as deserializer does before endianness of other side is known
+		ui32 length;
+		static_assert(sizeof(length) == FRAME_HEADER_SIZE, "length of string is read into buffer of frame header");
+		std::memcpy(&length, buffers.header.data(), sizeof(length));
+
+		if(length > MAX_HANDSHAKE_STRING_SIZE)
+			return fail(boost::str(boost::format("identification string of %d bytes is too long") % length));
+
+		const size_t stringStart = buffers.body.size() + sizeof(length);
+		buffers.body.insert(buffers.body.end(), buffers.header.begin(), buffers.header.end());
+		buffers.body.resize(stringStart + length);
+
+		asio::async_read(*activeSocket, asio::buffer(buffers.body.data() + stringStart, length), [self, activeSocket, fail, stringsLeft](const boost::system::error_code & ec, size_t)
+		{
+			if(ec)
+				return fail(ec.message());
+
+			self->asyncReadHandshake(stringsLeft - 1);
+		});
+	});
+}
+
 CConnection::CConnection(const std::shared_ptr<TAcceptor> & acceptor,
 						 const std::shared_ptr<boost::asio::io_service> & io_service,
 						 std::string Name,
@@ -147,23 +323,89 @@ CConnection::CConnection(const std::shared_ptr<TAcceptor> & acceptor,
 	init();
 }
 
-void CConnection::flushBuffers()
+CConnection::Statistics & CConnection::statistics()
 {
-	if(!enableBufferedWrite)
-		return;
+	static Statistics stats;
+	return stats;
+}
 
-	try
+CConnection::SharedFrame CConnection::takeWrittenFrame()
+{
+	auto & buffers = *connectionBuffers;
+	const auto size = static_cast<ui32>(buffers.writeBuffer.size());
+
+	auto frame = std::make_shared<std::vector<ui8>>(FRAME_HEADER_SIZE + size);
+	for(size_t i = 0; i < FRAME_HEADER_SIZE; i++)
+		(*frame)[i] = static_cast<ui8>(size >> (8 * i));
+	buffers.writeBuffer.sgetn(reinterpret_cast<char *>(frame->data() + FRAME_HEADER_SIZE), size);
+
+	statistics().packsSerialized++;
+	statistics().bytesSerialized += frame->size();
+
+	return frame;
+}
+
+CConnection::SharedFrame CConnection::serializeFrame(const CPack * pack)
+{
+	PackStatistics::Scope scope(PackStatistics::EStage::SERIALIZE, typeList.getTypeID(pack));
+
+	enableBufferedWrite = true;
+
+	oser & pack;
+
+	enableBufferedWrite = false;
+
+	auto frame = takeWrittenFrame();
+	scope.setBytes(frame->size());
+	return frame;
+}
+
+void CConnection::writeFrame(const SharedFrame & frame)
+{
+	auto & buffers = *connectionBuffers;
+
+	if(!buffers.asyncMode)
 	{
-		asio::write(*socket, connectionBuffers->writeBuffer);
+		try
+		{
+			asio::write(*socket, asio::buffer(*frame));
+		}
+		catch(...)
+		{
+			//connection has been lost
+			connected = false;
+			throw;
+		}
+
+		statistics().packsSent++;
+		statistics().bytesSent += frame->size();
+		return;
 	}
-	catch(...)
+
+	boost::unique_lock<boost::mutex> lock(buffers.mx);
+
+	//connection loss is reported by ErrorHandler
+	if(buffers.failed)
+		return;
+
+	//sending thread never waits for slow client, it is disconnected and may reconnect to receive missed packs
+	//there is always place for at least one pack in queue, so that game state can be sent
+	if(buffers.queuedWriteBytes > 0 && buffers.queuedWriteBytes + frame->size() > MAX_QUEUED_WRITE_BYTES)
 	{
-		//connection has been lost
-		connected = false;
-		throw;
+		buffers.failed = true;
+		const auto reason = boost::str(boost::format("%d bytes are waiting to be sent") % buffers.queuedWriteBytes);
+		postToSocket(buffers.socket, std::bind(&CConnection::asyncClose, shared_from_this(), reason));
+		return;
 	}
 
-	enableBufferedWrite = false;
+	buffers.queuedWriteBytes += frame->size();
+	buffers.writeQueue.push_back(frame);
+
+	if(!buffers.writing)
+	{
+		buffers.writing = true;
+		postToSocket(buffers.socket, std::bind(&CConnection::asyncWriteNext, shared_from_this()));
+	}
 }
 
 int CConnection::write(const void * data, unsigned size)
@@ -196,14 +438,9 @@ int CConnection::read(void * data, unsigned size)
 	{
 		if(enableBufferedRead)
 		{
-			auto available = connectionBuffers->readBuffer.size();
-
-			while(available < size)
-			{
-				auto bytesRead = socket->read_some(connectionBuffers->readBuffer.prepare(1024));
-				connectionBuffers->readBuffer.commit(bytesRead);
-				available = connectionBuffers->readBuffer.size();
-			}
+			//whole frame is read before deserialization starts
+			if(connectionBuffers->readBuffer.size() < size)
+				throw std::runtime_error("Pack is larger than its frame, client and server ABI probably do not match");
 
 			std::istream istream(&connectionBuffers->readBuffer);
 
@@ -244,7 +481,19 @@ void CConnection::close()
 {
 	if(socket)
 	{
-		socket->close();
+		//in asynchronous mode socket may be in use by thread that runs io_service
+		if(connectionBuffers->asyncMode)
+		{
+			auto closedSocket = socket;
+			postToSocket(closedSocket, [closedSocket]()
+			{
+				boost::system::error_code ignored;
+				closedSocket->close(ignored);
+			});
+		}
+		else
+			socket->close();
+
 		socket.reset();
 	}
 }
@@ -265,11 +514,67 @@ void CConnection::reportState(vstd::CLoggerBase * out)
 }
 
 CPack * CConnection::retrievePack()
+{
+	boost::unique_lock<boost::mutex> lock(*mutexRead);
+
+	std::array<ui8, FRAME_HEADER_SIZE> header;
+	try
+	{
+		asio::read(*socket, asio::buffer(header));
+		auto size = readFrameHeader(header);
+
+		if(size > MAX_FRAME_SIZE)
+		{
+			//reported same as lost connection
+			socket->close();
+			throw boost::system::system_error(asio::error::message_size, boost::str(boost::format("received frame of %d bytes") % size));
+		}
+
+		auto bytesRead = asio::read(*socket, connectionBuffers->readBuffer.prepare(size));
+		connectionBuffers->readBuffer.commit(bytesRead);
+	}
+	catch(...)
+	{
+		//connection has been lost
+		connected = false;
+		throw;
+	}
+
+	return deserializePack();
+}
+
+CPack * CConnection::retrievePack(const std::vector<ui8> & frame)
+{
+	CPack * pack = nullptr;
+
+	{
+		boost::unique_lock<boost::mutex> lock(*mutexRead);
+		connectionBuffers->readBuffer.sputn(reinterpret_cast<const char *>(frame.data()), frame.size());
+		pack = deserializePack();
+	}
+
+	auto & buffers = *connectionBuffers;
+	boost::unique_lock<boost::mutex> lock(buffers.mx);
+
+	buffers.unprocessedReadBytes -= frame.size();
+
+	if(buffers.readPaused && buffers.unprocessedReadBytes <= MAX_UNPROCESSED_READ_BYTES)
+	{
+		buffers.readPaused = false;
+		postToSocket(buffers.socket, std::bind(&CConnection::asyncReadHeader, shared_from_this()));
+	}
+
+	return pack;
+}
+
+CPack * CConnection::deserializePack()
 {
 	enableBufferedRead = true;
 
+	PackStatistics::Scope scope(PackStatistics::EStage::DESERIALIZE);
+	scope.setBytes(FRAME_HEADER_SIZE + connectionBuffers->readBuffer.size());
+
 	CPack * pack = nullptr;
-	boost::unique_lock<boost::mutex> lock(*mutexRead);
 	iser & pack;
 	logNetwork->trace("Received CPack of type %s", (pack ? typeid(*pack).name() : "nullptr"));
 	if(pack == nullptr)
@@ -278,11 +583,15 @@ CPack * CConnection::retrievePack()
 	}
 	else
 	{
+		scope.setType(typeList.getTypeID(pack));
 		pack->c = this->shared_from_this();
 	}
 
 	enableBufferedRead = false;
 
+	//remains of malformed pack must not be read as part of next one
+	connectionBuffers->readBuffer.consume(connectionBuffers->readBuffer.size());
+
 	return pack;
 }
 
@@ -291,11 +600,155 @@ void CConnection::sendPack(const CPack * pack)
 	boost::unique_lock<boost::mutex> lock(*mutexWrite);
 	logNetwork->trace("Sending a pack of type %s", typeid(*pack).name());
 
-	enableBufferedWrite = true;
+	writeFrame(serializeFrame(pack));
+}
 
-	oser & pack;
+CConnection::SharedFrame CConnection::serializePack(const CPack * pack)
+{
+	boost::unique_lock<boost::mutex> lock(*mutexWrite);
+	logNetwork->trace("Serializing a pack of type %s", typeid(*pack).name());
+
+	return serializeFrame(pack);
+}
+
+void CConnection::sendFrame(const SharedFrame & frame)
+{
+	boost::unique_lock<boost::mutex> lock(*mutexWrite);
+	writeFrame(frame);
+}
+
+bool CConnection::canShareFrames() const
+{
+	//with smart pointers serializer remembers pointers that were already sent through this connection
+	//and writes references to them, which are only valid for this connection
+	return !oser.smartPointerSerialization;
+}
+
+void CConnection::startAsyncMode(FrameHandler onFrame, ErrorHandler onError)
+{
+	connectionBuffers->socket = socket;
+	connectionBuffers->onFrame = std::move(onFrame);
+	connectionBuffers->onError = std::move(onError);
+	connectionBuffers->asyncMode = true;
+
+	postToSocket(socket, std::bind(&CConnection::asyncReadHeader, shared_from_this()));
+}
+
+void CConnection::asyncReadHeader()
+{
+	auto self = shared_from_this();
+	auto activeSocket = connectionBuffers->socket;
+
+	asio::async_read(*activeSocket, asio::buffer(connectionBuffers->header), [self, activeSocket](const boost::system::error_code & ec, size_t)
+	{
+		if(ec)
+			return self->asyncFail(ec.message());
+
+		auto size = readFrameHeader(self->connectionBuffers->header);
+
+		if(size > MAX_FRAME_SIZE)
+			return self->asyncFail(boost::str(boost::format("received frame of %d bytes") % size));
+
+		auto & body = self->connectionBuffers->body;
+		body.resize(size);
+
+		asio::async_read(*activeSocket, asio::buffer(body), [self, activeSocket](const boost::system::error_code & ec, size_t)
+		{
+			if(ec)
+				return self->asyncFail(ec.message());
+
+			self->asyncFrameReceived();
+		});
+	});
+}
+
+void CConnection::asyncFrameReceived()
+{
+	auto & buffers = *connectionBuffers;
+
+	std::vector<ui8> frame;
+	frame.swap(buffers.body);
+
+	bool paused = false;
+	{
+		boost::unique_lock<boost::mutex> lock(buffers.mx);
+		buffers.unprocessedReadBytes += frame.size();
+		paused = buffers.readPaused = buffers.unprocessedReadBytes > MAX_UNPROCESSED_READ_BYTES;
+	}
+
+	if(paused)
+		logNetwork->debug("%s: reading paused, %d bytes wait for processing", toString(), buffers.unprocessedReadBytes);
+
+	buffers.onFrame(shared_from_this(), std::move(frame));
+
+	//otherwise reading is resumed by retrievePack
+	if(!paused)
+		asyncReadHeader();
+}
+
+void CConnection::asyncWriteNext()
+{
+	auto & buffers = *connectionBuffers;
+	auto self = shared_from_this();
+	auto activeSocket = buffers.socket;
+
+	SharedFrame frame;
+	{
+		boost::unique_lock<boost::mutex> lock(buffers.mx);
+
+		if(buffers.failed || buffers.writeQueue.empty())
+		{
+			buffers.writing = false;
+			return;
+		}
+
+		frame = buffers.writeQueue.front();
+	}
+
+	//frame may be shared with queues of other connections, lambda keeps it alive until it is written
+	asio::async_write(*activeSocket, asio::buffer(*frame), [self, activeSocket, frame](const boost::system::error_code & ec, size_t)
+	{
+		if(ec)
+			return self->asyncFail(ec.message());
+
+		statistics().packsSent++;
+		statistics().bytesSent += frame->size();
+
+		auto & buffers = *self->connectionBuffers;
+		{
+			boost::unique_lock<boost::mutex> lock(buffers.mx);
+			buffers.queuedWriteBytes -= frame->size();
+			buffers.writeQueue.pop_front();
+		}
+
+		self->asyncWriteNext();
+	});
+}
+
+void CConnection::asyncFail(const std::string & reason)
+{
+	auto & buffers = *connectionBuffers;
+	{
+		boost::unique_lock<boost::mutex> lock(buffers.mx);
+
+		if(buffers.failed)
+			return;
+
+		buffers.failed = true;
+	}
+
+	asyncClose(reason);
+}
+
+void CConnection::asyncClose(const std::string & reason)
+{
+	auto & buffers = *connectionBuffers;
+
+	//make sure that pending reads and writes are finished as well
+	boost::system::error_code ignored;
+	buffers.socket->close(ignored);
 
-	flushBuffers();
+	buffers.onError(shared_from_this(), reason);
 }
 
 void CConnection::disableStackSendingByID()
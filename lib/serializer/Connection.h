@@ -59,12 +59,29 @@ struct ConnectionBuffers;
 class DLL_LINKAGE CConnection
 	: public IBinaryReader, public IBinaryWriter, public std::enable_shared_from_this<CConnection>
 {
+	struct AsyncHandshake {};
+
+	CConnection(std::shared_ptr<TSocket> Socket, std::string Name, std::string UUID, AsyncHandshake);
+
 	void init();
+	void initSocket();
+	void handshakeFinished(const std::string & contactName);
 	void reportState(vstd::CLoggerBase * out) override;
 
 	int write(const void * data, unsigned size) override;
 	int read(void * data, unsigned size) override;
-	void flushBuffers();
+	std::shared_ptr<const std::vector<ui8>> serializeFrame(const CPack * pack);
+	void writeFrame(const std::shared_ptr<const std::vector<ui8>> & frame);
+	std::shared_ptr<const std::vector<ui8>> takeWrittenFrame();
+	CPack * deserializePack();
+
+	void asyncReadHandshake(int stringsLeft);
+	void asyncReadHeader();
+	void asyncFrameReceived();
+	void asyncWriteNext();
+	void asyncFail(const std::string & reason);
+	/// closes socket of connection that has already been marked as failed and reports it
+	void asyncClose(const std::string & reason);
 
 	std::shared_ptr<boost::asio::io_service> io_service; //can be empty if connection made from socket
 
@@ -73,6 +90,36 @@ class DLL_LINKAGE CConnection
 	std::unique_ptr<ConnectionBuffers> connectionBuffers;
 
 public:
+	/// Serialized pack together with its frame header, immutable so that it can be queued by several connections at once
+	using SharedFrame = std::shared_ptr<const std::vector<ui8>>;
+
+	/// Totals of all connections, with shared frames less bytes are serialized than sent
+	struct Statistics
+	{
+		std::atomic<ui64> packsSerialized{0};
+		std::atomic<ui64> bytesSerialized{0};
+		std::atomic<ui64> packsSent{0};
+		std::atomic<ui64> bytesSent{0};
+	};
+
+	static Statistics & statistics();
+
+	/// Called from thread that runs io_service of socket with data of every received pack, in order of arrival
+	using FrameHandler = std::function<void(std::shared_ptr<CConnection>, std::vector<ui8> &&)>;
+	/// Called once after last received pack when connection is lost
+	using ErrorHandler = std::function<void(std::shared_ptr<CConnection>, const std::string &)>;
+	/// Called from thread that runs io_service of socket once identification is exchanged, error is empty on success
+	using HandshakeHandler = std::function<void(std::shared_ptr<CConnection>, const std::string &)>;
+
+	/// Connection in asynchronous mode is closed when sent pack does not fit into queue of this size
+	static constexpr size_t MAX_QUEUED_WRITE_BYTES = 16 * 1024 * 1024;
+	/// Reading from socket in asynchronous mode is paused while this amount of received data waits to be processed
+	static constexpr size_t MAX_UNPROCESSED_READ_BYTES = 4 * 1024 * 1024;
+	/// Connection that receives larger frame is closed, largest packs are game states sent to clients when game starts
+	static constexpr size_t MAX_FRAME_SIZE = 256 * 1024 * 1024;
+	/// Same for strings of identification that connections exchange when established
+	static constexpr size_t MAX_HANDSHAKE_STRING_SIZE = 1024;
+
 	BinaryDeserializer iser;
 	BinarySerializer oser;
 
@@ -88,10 +135,13 @@ public:
 	int connectionID;
 	std::shared_ptr<boost::thread> handler;
 
-	CConnection(const std::string & host, ui16 port, std::string Name, std::string UUID);
+	CConnection(const std::string & host, ui16 port, std::string Name, std::string UUID, std::shared_ptr<boost::asio::io_service> Io_service = nullptr);
 	CConnection(const std::shared_ptr<TAcceptor> & acceptor, const std::shared_ptr<boost::asio::io_service> & Io_service, std::string Name, std::string UUID);
 	CConnection(std::shared_ptr<TSocket> Socket, std::string Name, std::string UUID); //use immediately after accepting connection into socket
 
+	/// Same as constructor from accepted socket, but exchanges identification without blocking calling thread that runs io_service of socket
+	static void acceptAsync(std::shared_ptr<TSocket> Socket, std::string Name, std::string UUID, HandshakeHandler onHandshake);
+
 	void close();
 	bool isOpen() const;
 	template<class T>
@@ -101,6 +151,19 @@ public:
 	CPack * retrievePack();
 	void sendPack(const CPack * pack);
 
+	/// Serializes pack without sending it, frame can be sent through any connection for which canShareFrames() is true
+	/// Bytes depend only on serializer settings that are same for all connections in gameplay mode and on state of game
+	SharedFrame serializePack(const CPack * pack);
+	void sendFrame(const SharedFrame & frame);
+	/// false if serialized packs contain data specific for this connection, e.g. references to already sent pointers
+	bool canShareFrames() const;
+
+	/// Switches connection to asynchronous mode, in which socket is only used by thread that runs its io_service
+	/// Sending packs only queues them, received packs are passed to onFrame and must be deserialized with retrievePack(frame)
+	void startAsyncMode(FrameHandler onFrame, ErrorHandler onError);
+	/// deserializes pack received in asynchronous mode, allows reading of more data from socket
+	CPack * retrievePack(const std::vector<ui8> & frame);
+
 	void disableStackSendingByID();
 	void enableStackSendingByID();
 	void disableSmartPointerSerialization();
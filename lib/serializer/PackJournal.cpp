@@ -0,0 +1,110 @@
+/*
+ * PackJournal.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "PackJournal.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+PackJournal::PackJournal(size_t maxBytes):
+	maxBytes(maxBytes)
+{
+}
+
+bool PackJournal::isSentTo(const Entry & entry, int clientId)
+{
+	return entry.clientId == ALL_CLIENTS || entry.clientId == clientId;
+}
+
+void PackJournal::startClient(int clientId)
+{
+	ClientState state;
+	state.startSequence = firstSequence + entries.size();
+	clients[clientId] = state;
+}
+
+void PackJournal::append(int clientId, Frame frame)
+{
+	bytes += frame->size();
+	entries.push_back({clientId, std::move(frame)});
+
+	while(bytes > maxBytes && entries.size() > 1)
+		dropOldest();
+}
+
+void PackJournal::dropOldest()
+{
+	const auto & entry = entries.front();
+
+	for(auto & client : clients)
+	{
+		if(firstSequence >= client.second.startSequence && isSentTo(entry, client.first))
+			client.second.droppedPacks++;
+	}
+
+	bytes -= entry.frame->size();
+	entries.pop_front();
+	firstSequence++;
+}
+
+void PackJournal::clear()
+{
+	firstSequence += entries.size();
+	entries.clear();
+	clients.clear();
+	bytes = 0;
+}
+
+bool PackJournal::missingPacks(int clientId, ui64 receivedPacks, std::vector<Frame> & result) const
+{
+	result.clear();
+
+	auto client = clients.find(clientId);
+	if(client == clients.end())
+		return false;
+
+	const auto & state = client->second;
+
+	if(receivedPacks < state.droppedPacks)
+		return false;
+
+	ui64 counted = state.droppedPacks;
+	for(ui64 sequence = std::max(firstSequence, state.startSequence); sequence < firstSequence + entries.size(); sequence++)
+	{
+		const auto & entry = entries[sequence - firstSequence];
+
+		if(!isSentTo(entry, clientId))
+			continue;
+
+		if(counted >= receivedPacks)
+			result.push_back(entry.frame);
+
+		counted++;
+	}
+
+	if(counted < receivedPacks)
+	{
+		result.clear();
+		return false;
+	}
+
+	return true;
+}
+
+size_t PackJournal::packsCount() const
+{
+	return entries.size();
+}
+
+size_t PackJournal::bytesCount() const
+{
+	return bytes;
+}
+
+VCMI_LIB_NAMESPACE_END
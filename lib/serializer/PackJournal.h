@@ -0,0 +1,69 @@
+/*
+ * PackJournal.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+/// Bounded in-memory journal of serialized packs sent to clients during gameplay
+/// Allows client that lost connection but still has its game state to receive only packs it missed instead of whole state
+/// Position of client in journal is number of packs it has received since it got its state, which client can count on its own
+/// Not thread-safe, journal must be locked together with sending of packs so that order of packs in journal and on connections is same
+class DLL_LINKAGE PackJournal
+{
+public:
+	/// serialized pack, same as CConnection::SharedFrame
+	using Frame = std::shared_ptr<const std::vector<ui8>>;
+
+	/// pack was sent to all clients
+	static constexpr int ALL_CLIENTS = -1;
+
+	/// oldest packs are dropped when total size of frames exceeds this limit, but last pack is always kept
+	explicit PackJournal(size_t maxBytes);
+
+	/// client has received whole game state, packs added from now on are counted for it
+	void startClient(int clientId);
+	void append(int clientId, Frame frame);
+	/// drops all packs and clients, e.g. if pack could not be recorded
+	void clear();
+
+	/// packs that were sent to client after first receivedPacks packs since its state
+	/// returns false if client is unknown, some of these packs were already dropped or client claims to have more packs than were sent
+	bool missingPacks(int clientId, ui64 receivedPacks, std::vector<Frame> & result) const;
+
+	size_t packsCount() const;
+	size_t bytesCount() const;
+
+private:
+	struct Entry
+	{
+		int clientId;
+		Frame frame;
+	};
+
+	struct ClientState
+	{
+		/// sequence number of first pack that is counted for client
+		ui64 startSequence = 0;
+		/// packs for client that were dropped from journal
+		ui64 droppedPacks = 0;
+	};
+
+	static bool isSentTo(const Entry & entry, int clientId);
+	void dropOldest();
+
+	size_t maxBytes;
+	size_t bytes = 0;
+	/// sequence number of first entry
+	ui64 firstSequence = 0;
+	std::deque<Entry> entries;
+	std::map<int, ClientState> clients;
+};
+
+VCMI_LIB_NAMESPACE_END
@@ -0,0 +1,388 @@
+/*
+ * PackRecording.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "PackRecording.h"
+
+#include "BinaryDeserializer.h"
+#include "BinarySerializer.h"
+#include "../CGameState.h"
+#include "../NetPacksBase.h"
+#include "../registerTypes/RegisterTypes.h"
+
+#include <zlib.h>
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+static const std::string PACKS_FILE = "packs.bin";
+static const std::string CHECKPOINT_PREFIX = "checkpoint_";
+static const std::string CHECKPOINT_EXTENSION = ".vjcp";
+
+static constexpr size_t CHUNK_HEADER_SIZE = 12;
+static constexpr size_t FRAME_HEADER_SIZE = 4;
+
+static void writeUInt32(std::vector<ui8> & out, size_t offset, ui32 value)
+{
+	for(size_t i = 0; i < 4; i++)
+		out[offset + i] = static_cast<ui8>(value >> (8 * i));
+}
+
+static ui32 readUInt32(const ui8 * data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<ui32>(data[3]) << 24);
+}
+
+static boost::filesystem::path checkpointPath(const boost::filesystem::path & directory, ui64 pack)
+{
+	return directory / (CHECKPOINT_PREFIX + std::to_string(pack) + CHECKPOINT_EXTENSION);
+}
+
+static ui64 elapsedMicroseconds(const std::chrono::high_resolution_clock::time_point & start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/// Reads single pack from chunk of journal
+class PackReplayerReader : public IBinaryReader
+{
+	const ui8 * data = nullptr;
+	size_t size = 0;
+	size_t position = 0;
+
+public:
+	void setData(const ui8 * newData, size_t newSize)
+	{
+		data = newData;
+		size = newSize;
+		position = 0;
+	}
+
+	int read(void * out, unsigned length) override
+	{
+		if(position + length > size)
+			throw std::runtime_error("Pack in journal is larger than its frame");
+
+		std::copy(data + position, data + position + length, static_cast<ui8 *>(out));
+		position += length;
+		return length;
+	}
+};
+
+PackCheckpoint::PackCheckpoint(const boost::filesystem::path & path):
+	path(path),
+	serializer(this)
+{
+	registerTypes(serializer);
+
+	//same header as written by CSaveFile
+	putMagicBytes("VCMI");
+	serializer & SERIALIZATION_VERSION;
+}
+
+int PackCheckpoint::write(const void * newData, unsigned size)
+{
+	const auto * bytes = static_cast<const ui8 *>(newData);
+	data.insert(data.end(), bytes, bytes + size);
+	return size;
+}
+
+void PackCheckpoint::putMagicBytes(const std::string & text)
+{
+	write(text.c_str(), static_cast<unsigned int>(text.length()));
+}
+
+void PackCheckpoint::save() const
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::ofstream file(path.string(), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char *>(data.data()), data.size());
+	file.close();
+
+	if(!file)
+		throw std::runtime_error("Failed to write pack journal checkpoint " + path.string());
+
+	logGlobal->debug("Pack journal checkpoint %s saved: %d ms", path.filename().string(), elapsedMicroseconds(start) / 1000);
+}
+
+PackRecorder::PackRecorder(const boost::filesystem::path & directory):
+	directory(directory)
+{
+	boost::filesystem::create_directories(directory);
+
+	packsFile = std::make_unique<std::ofstream>((directory / PACKS_FILE).string(), std::ios::binary | std::ios::trunc);
+	if(!packsFile->good())
+		throw std::runtime_error("Failed to create pack journal in " + directory.string());
+
+	logGlobal->info("Recording pack journal to %s", directory.string());
+}
+
+PackRecorder::~PackRecorder()
+{
+	flushChunk();
+}
+
+void PackRecorder::recordPack(const std::vector<ui8> & frame)
+{
+	chunk.insert(chunk.end(), frame.begin(), frame.end());
+	chunkPacks++;
+	recordedPacks++;
+
+	if(chunk.size() >= CHUNK_SIZE)
+		flushChunk();
+}
+
+std::unique_ptr<PackCheckpoint> PackRecorder::takeCheckpoint(const CPrivilegedInfoCallback & state)
+{
+	//checkpoint must be followed by first pack of new chunk, so replayer does not need to decompress skipped packs
+	flushChunk();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	auto checkpoint = std::make_unique<PackCheckpoint>(checkpointPath(directory, recordedPacks));
+	state.saveCommonState(*checkpoint);
+	logGlobal->debug("Pack journal checkpoint before pack %d taken: %d ms", recordedPacks, elapsedMicroseconds(start) / 1000);
+
+	return checkpoint;
+}
+
+void PackRecorder::recordCheckpoint(const CPrivilegedInfoCallback & state)
+{
+	takeCheckpoint(state)->save();
+}
+
+void PackRecorder::flushChunk()
+{
+	if(chunkPacks == 0)
+		return;
+
+	uLongf compressedSize = compressBound(static_cast<uLong>(chunk.size()));
+	std::vector<ui8> compressed(CHUNK_HEADER_SIZE + compressedSize);
+
+	int result = compress2(compressed.data() + CHUNK_HEADER_SIZE, &compressedSize, chunk.data(), static_cast<uLong>(chunk.size()), Z_BEST_SPEED);
+	if(result != Z_OK)
+		throw std::runtime_error("Failed to compress pack journal chunk");
+
+	compressed.resize(CHUNK_HEADER_SIZE + compressedSize);
+	writeUInt32(compressed, 0, static_cast<ui32>(compressedSize));
+	writeUInt32(compressed, 4, static_cast<ui32>(chunk.size()));
+	writeUInt32(compressed, 8, chunkPacks);
+
+	packsFile->write(reinterpret_cast<const char *>(compressed.data()), compressed.size());
+	packsFile->flush();
+
+	chunk.clear();
+	chunkPacks = 0;
+}
+
+ui64 PackRecorder::packsCount() const
+{
+	return recordedPacks;
+}
+
+const boost::filesystem::path & PackRecorder::getDirectory() const
+{
+	return directory;
+}
+
+PackReplayer::PackReplayer(const boost::filesystem::path & directory):
+	directory(directory),
+	reader(std::make_unique<PackReplayerReader>()),
+	serializer(std::make_unique<BinaryDeserializer>(reader.get()))
+{
+	registerTypes(*serializer);
+	serializer->fileVersion = SERIALIZATION_VERSION;
+	//packs are recorded as they are sent to clients in gameplay mode, see CConnection::enterGameplayConnectionMode
+	serializer->smartPointerSerialization = false;
+	reader->sendStackInstanceByIds = true;
+
+	if(boost::filesystem::is_directory(directory))
+	{
+		for(const auto & entry : boost::filesystem::directory_iterator(directory))
+		{
+			const auto name = entry.path().filename().string();
+			if(boost::algorithm::starts_with(name, CHECKPOINT_PREFIX) && boost::algorithm::ends_with(name, CHECKPOINT_EXTENSION))
+				checkpoints.push_back(std::stoull(name.substr(CHECKPOINT_PREFIX.size(), name.size() - CHECKPOINT_PREFIX.size() - CHECKPOINT_EXTENSION.size())));
+		}
+	}
+	boost::range::sort(checkpoints);
+
+	if(checkpoints.empty() || checkpoints.front() != 0)
+		throw std::runtime_error("No initial checkpoint in pack journal " + directory.string());
+
+	packsFile = std::make_unique<std::ifstream>((directory / PACKS_FILE).string(), std::ios::binary);
+	if(!packsFile->good())
+		throw std::runtime_error("Failed to open packs of journal " + directory.string());
+
+	//journal of server that did not shut down properly may end with incomplete chunk
+	ui64 packs = 0;
+	std::array<ui8, CHUNK_HEADER_SIZE> header;
+	packsFile->seekg(0, std::ios::end);
+	const std::streamoff fileSize = packsFile->tellg();
+	std::streamoff offset = 0;
+
+	while(offset + static_cast<std::streamoff>(CHUNK_HEADER_SIZE) <= fileSize)
+	{
+		packsFile->seekg(offset);
+		packsFile->read(reinterpret_cast<char *>(header.data()), header.size());
+
+		Chunk chunk;
+		chunk.offset = offset + CHUNK_HEADER_SIZE;
+		chunk.compressedSize = readUInt32(header.data());
+		chunk.size = readUInt32(header.data() + 4);
+		chunk.packs = readUInt32(header.data() + 8);
+		chunk.firstPack = packs;
+
+		if(chunk.offset + chunk.compressedSize > fileSize)
+		{
+			logGlobal->warn("Pack journal %s ends with incomplete chunk", directory.string());
+			break;
+		}
+
+		chunks.push_back(chunk);
+		packs += chunk.packs;
+		offset = chunk.offset + chunk.compressedSize;
+	}
+	packsFile->clear();
+
+	logGlobal->info("Pack journal %s: %d packs in %d chunks, %d checkpoints", directory.string(), packs, chunks.size(), checkpoints.size());
+}
+
+PackReplayer::~PackReplayer()
+{
+	vstd::clear_pointer(gs);
+}
+
+const std::vector<ui64> & PackReplayer::getCheckpoints() const
+{
+	return checkpoints;
+}
+
+ui64 PackReplayer::packsCount() const
+{
+	if(chunks.empty())
+		return 0;
+
+	return chunks.back().firstPack + chunks.back().packs;
+}
+
+ui64 PackReplayer::currentPack() const
+{
+	return nextPack;
+}
+
+const PackReplayer::Statistics & PackReplayer::statistics() const
+{
+	return stats;
+}
+
+void PackReplayer::seek(ui64 pack)
+{
+	auto checkpoint = std::upper_bound(checkpoints.begin(), checkpoints.end(), pack);
+	loadCheckpoint(*std::prev(checkpoint));
+
+	replay(pack);
+}
+
+void PackReplayer::loadCheckpoint(ui64 pack)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	vstd::clear_pointer(gs);
+	{
+		CLoadFile load(checkpointPath(directory, pack), MINIMAL_SERIALIZATION_VERSION);
+		loadCommonState(load);
+	}
+	gs->preInit(VLC);
+	gs->updateOnLoad(gs->scenarioOps);
+	reader->addStdVecItems(gs);
+
+	nextPack = pack;
+	chunkData.clear();
+	chunkPosition = 0;
+
+	//checkpoints are always made at start of chunk, but skipping is supported as well
+	for(loadedChunk = 0; loadedChunk < chunks.size(); loadedChunk++)
+	{
+		if(chunks[loadedChunk].firstPack + chunks[loadedChunk].packs > pack)
+		{
+			loadChunk(loadedChunk);
+			for(ui64 skipped = chunks[loadedChunk].firstPack; skipped < pack; skipped++)
+				chunkPosition += FRAME_HEADER_SIZE + readUInt32(chunkData.data() + chunkPosition);
+			break;
+		}
+	}
+
+	stats.loadingTime += elapsedMicroseconds(start);
+	logGlobal->info("Loaded pack journal checkpoint before pack %d", pack);
+}
+
+void PackReplayer::loadChunk(size_t index)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	const auto & chunk = chunks[index];
+
+	std::vector<ui8> compressed(chunk.compressedSize);
+	packsFile->seekg(chunk.offset);
+	packsFile->read(reinterpret_cast<char *>(compressed.data()), compressed.size());
+
+	chunkData.resize(chunk.size);
+	uLongf size = chunk.size;
+	if(!packsFile->good() || uncompress(chunkData.data(), &size, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK || size != chunk.size)
+		throw std::runtime_error("Failed to decompress chunk of pack journal");
+
+	chunkPosition = 0;
+	stats.decompressionTime += elapsedMicroseconds(start);
+}
+
+ui64 PackReplayer::replay(ui64 untilPack)
+{
+	if(!gs)
+		throw std::runtime_error("Checkpoint of pack journal must be loaded before replay");
+
+	ui64 applied = 0;
+
+	while(nextPack < untilPack && loadedChunk < chunks.size())
+	{
+		if(chunkPosition >= chunkData.size())
+		{
+			if(++loadedChunk == chunks.size())
+				break;
+
+			loadChunk(loadedChunk);
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		const ui32 size = readUInt32(chunkData.data() + chunkPosition);
+		reader->setData(chunkData.data() + chunkPosition + FRAME_HEADER_SIZE, size);
+		chunkPosition += FRAME_HEADER_SIZE + size;
+
+		CPack * pack = nullptr;
+		*serializer & pack;
+		if(!pack)
+			throw std::runtime_error("Failed to read pack " + std::to_string(nextPack) + " of journal");
+
+		auto deserialized = std::chrono::high_resolution_clock::now();
+		stats.deserializationTime += std::chrono::duration_cast<std::chrono::microseconds>(deserialized - start).count();
+
+		gs->apply(pack);
+		delete pack;
+
+		stats.applyingTime += elapsedMicroseconds(deserialized);
+		stats.bytes += size;
+		stats.packs++;
+
+		nextPack++;
+		applied++;
+	}
+
+	return applied;
+}
+
+VCMI_LIB_NAMESPACE_END
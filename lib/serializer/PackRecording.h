@@ -0,0 +1,136 @@
+/*
+ * PackRecording.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "BinarySerializer.h"
+#include "../IGameCallback.h"
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+class BinaryDeserializer;
+class PackReplayerReader;
+
+/// Whole game state serialized in memory by PackRecorder::takeCheckpoint
+/// Saving it to disk does not need game state, so it can be done after game state is unlocked
+class DLL_LINKAGE PackCheckpoint : public IBinaryWriter, boost::noncopyable
+{
+	boost::filesystem::path path;
+	std::vector<ui8> data;
+
+public:
+	BinarySerializer serializer;
+
+	explicit PackCheckpoint(const boost::filesystem::path & path);
+
+	int write(const void * data, unsigned size) override;
+	void putMagicBytes(const std::string & text);
+
+	/// writes checkpoint file, same as save made by CSaveFile. Throws std::runtime_error on failure
+	void save() const;
+};
+
+/// Journal of packs applied on game state, stored in directory:
+/// packs.bin - sequence of chunks, each of them is header of three ui32 (compressed size, size, number of packs) followed by zlib-compressed packs
+///             every pack is stored in same form as it is sent to clients: ui32 size followed by serialized pack
+/// checkpoint_<N>.vjcp - whole game state before N-th pack, same as lib part of save
+class DLL_LINKAGE PackRecorder : boost::noncopyable
+{
+	boost::filesystem::path directory;
+	std::unique_ptr<std::ofstream> packsFile;
+
+	std::vector<ui8> chunk;
+	ui32 chunkPacks = 0;
+	ui64 recordedPacks = 0;
+
+	void flushChunk();
+
+public:
+	/// chunk is compressed and written once it reaches this size
+	static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+	/// creates directory, throws std::runtime_error if journal can't be created
+	explicit PackRecorder(const boost::filesystem::path & directory);
+	~PackRecorder();
+
+	/// serialized pack with frame header, see CConnection::SharedFrame
+	void recordPack(const std::vector<ui8> & frame);
+	/// serializes current game state in memory, following packs are replayed on top of it
+	/// only this part needs game state to stay unchanged, checkpoint can be saved later
+	std::unique_ptr<PackCheckpoint> takeCheckpoint(const CPrivilegedInfoCallback & state);
+	/// takes checkpoint and saves it immediately
+	void recordCheckpoint(const CPrivilegedInfoCallback & state);
+
+	ui64 packsCount() const;
+	const boost::filesystem::path & getDirectory() const;
+};
+
+/// Loads checkpoints of pack journal and applies recorded packs on game state without server and clients
+/// Packs are applied with CGameState::apply only, same as on client, so replay is deterministic
+class DLL_LINKAGE PackReplayer : public CPrivilegedInfoCallback, boost::noncopyable
+{
+public:
+	struct Statistics
+	{
+		ui64 packs = 0;
+		ui64 bytes = 0;
+		/// wall time in microseconds
+		ui64 loadingTime = 0;
+		ui64 decompressionTime = 0;
+		ui64 deserializationTime = 0;
+		ui64 applyingTime = 0;
+	};
+
+	/// reads list of checkpoints and chunks, throws std::runtime_error if directory is not a journal
+	explicit PackReplayer(const boost::filesystem::path & directory);
+	~PackReplayer();
+
+	/// numbers of packs before which checkpoints were made, in ascending order
+	const std::vector<ui64> & getCheckpoints() const;
+	ui64 packsCount() const;
+	/// number of next pack to apply
+	ui64 currentPack() const;
+
+	/// loads last checkpoint that is not after given pack and fast-forwards to this pack
+	void seek(ui64 pack);
+	/// applies packs until given pack or end of journal, returns number of applied packs
+	ui64 replay(ui64 untilPack = std::numeric_limits<ui64>::max());
+
+	const Statistics & statistics() const;
+
+private:
+	struct Chunk
+	{
+		std::streamoff offset;
+		ui32 compressedSize;
+		ui32 size;
+		ui64 firstPack;
+		ui32 packs;
+	};
+
+	boost::filesystem::path directory;
+	std::unique_ptr<std::ifstream> packsFile;
+	std::vector<ui64> checkpoints;
+	std::vector<Chunk> chunks;
+
+	std::unique_ptr<PackReplayerReader> reader;
+	std::unique_ptr<BinaryDeserializer> serializer;
+
+	size_t loadedChunk = 0;
+	std::vector<ui8> chunkData;
+	size_t chunkPosition = 0;
+	ui64 nextPack = 0;
+
+	Statistics stats;
+
+	void loadCheckpoint(ui64 pack);
+	void loadChunk(size_t index);
+};
+
+VCMI_LIB_NAMESPACE_END
@@ -0,0 +1,176 @@
+/*
+ * PackStatistics.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "PackStatistics.h"
+
+#include "CTypeList.h"
+
+#include <boost/core/demangle.hpp>
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+static std::string typeName(ui16 typeID)
+{
+	auto descriptor = typeList.getTypeDescriptor(typeID);
+	if(!descriptor)
+		return "unknown type " + std::to_string(typeID);
+
+	return boost::core::demangle(descriptor->name);
+}
+
+const PackStatistics::StageStatistics & PackStatistics::TypeStatistics::operator[](EStage stage) const
+{
+	return stages[static_cast<size_t>(stage)];
+}
+
+PackStatistics::Scope::Scope(EStage stage, ui16 typeID):
+	stage(stage),
+	typeID(typeID),
+	timed(PackStatistics::get().isTimingEnabled())
+{
+	if(timed)
+		start = std::chrono::high_resolution_clock::now();
+}
+
+PackStatistics::Scope::~Scope()
+{
+	ui64 time = 0;
+	if(timed)
+		time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	PackStatistics::get().record(stage, typeID, bytes, time);
+}
+
+void PackStatistics::Scope::setType(ui16 newTypeID)
+{
+	typeID = newTypeID;
+}
+
+void PackStatistics::Scope::setBytes(ui64 newBytes)
+{
+	bytes = newBytes;
+}
+
+PackStatistics & PackStatistics::get()
+{
+	static PackStatistics instance;
+	return instance;
+}
+
+void PackStatistics::record(EStage stage, ui16 typeID, ui64 bytes, ui64 time)
+{
+	if(typeID >= MAX_TYPES)
+		typeID = 0;
+
+	auto & entry = types[typeID][static_cast<size_t>(stage)];
+	entry.count.fetch_add(1, std::memory_order_relaxed);
+	if(bytes)
+		entry.bytes.fetch_add(bytes, std::memory_order_relaxed);
+	if(time)
+		entry.time.fetch_add(time, std::memory_order_relaxed);
+}
+
+void PackStatistics::reset()
+{
+	for(auto & type : types)
+	{
+		for(auto & stage : type)
+		{
+			stage.count = 0;
+			stage.bytes = 0;
+			stage.time = 0;
+		}
+	}
+}
+
+bool PackStatistics::isTimingEnabled() const
+{
+	return timingEnabled.load(std::memory_order_relaxed);
+}
+
+void PackStatistics::setTimingEnabled(bool enabled)
+{
+	timingEnabled = enabled;
+}
+
+std::vector<PackStatistics::TypeStatistics> PackStatistics::getStatistics() const
+{
+	std::vector<TypeStatistics> ret;
+
+	for(ui16 typeID = 0; typeID < MAX_TYPES; typeID++)
+	{
+		TypeStatistics type;
+		type.typeID = typeID;
+
+		bool seen = false;
+		for(size_t stage = 0; stage < type.stages.size(); stage++)
+		{
+			const auto & source = types[typeID][stage];
+			type.stages[stage].count = source.count.load(std::memory_order_relaxed);
+			type.stages[stage].bytes = source.bytes.load(std::memory_order_relaxed);
+			type.stages[stage].time = source.time.load(std::memory_order_relaxed);
+			seen |= type.stages[stage].count != 0;
+		}
+
+		if(seen)
+			ret.push_back(type);
+	}
+
+	return ret;
+}
+
+std::string PackStatistics::toString(size_t limit) const
+{
+	auto statistics = getStatistics();
+
+	auto cost = [](const TypeStatistics & type) -> std::pair<ui64, ui64>
+	{
+		ui64 time = type[EStage::SERIALIZE].time + type[EStage::DESERIALIZE].time + type[EStage::HANDLE].time;
+		//applying is part of handling of received packs, but server applies packs it sends without handling them
+		if(type[EStage::HANDLE].count == 0)
+			time += type[EStage::APPLY].time;
+
+		return std::make_pair(time, type[EStage::SERIALIZE].bytes + type[EStage::DESERIALIZE].bytes);
+	};
+
+	std::stable_sort(statistics.begin(), statistics.end(), [&](const TypeStatistics & left, const TypeStatistics & right)
+	{
+		return cost(left) > cost(right);
+	});
+
+	std::ostringstream out;
+	out << boost::format("%-36s %22s %22s %16s %16s\n") % "Pack" % "serialized [n/KB/ms]" % "deserialized [n/KB/ms]" % "applied [n/ms]" % "handled [n/ms]";
+
+	auto stageColumn = [](const StageStatistics & stage, bool withBytes) -> std::string
+	{
+		if(withBytes)
+			return boost::str(boost::format("%d/%d/%d") % stage.count % (stage.bytes / 1024) % (stage.time / 1000));
+		return boost::str(boost::format("%d/%d") % stage.count % (stage.time / 1000));
+	};
+
+	for(size_t i = 0; i < statistics.size() && i < limit; i++)
+	{
+		const auto & type = statistics[i];
+
+		out << boost::format("%-36s %22s %22s %16s %16s\n")
+			% typeName(type.typeID)
+			% stageColumn(type[EStage::SERIALIZE], true)
+			% stageColumn(type[EStage::DESERIALIZE], true)
+			% stageColumn(type[EStage::APPLY], false)
+			% stageColumn(type[EStage::HANDLE], false);
+	}
+
+	if(!isTimingEnabled())
+		out << "Timing of packs is disabled\n";
+
+	return out.str();
+}
+
+VCMI_LIB_NAMESPACE_END
@@ -0,0 +1,95 @@
+/*
+ * PackStatistics.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+VCMI_LIB_NAMESPACE_BEGIN
+
+/// Cost of packs of every type, aggregated over whole process (server and client in single-process mode share it)
+/// Number of packs and their size are always collected, reading clock is done only when timing is enabled
+class DLL_LINKAGE PackStatistics : boost::noncopyable
+{
+public:
+	enum class EStage
+	{
+		SERIALIZE,
+		DESERIALIZE,
+		/// CGameState::apply
+		APPLY,
+		/// whole processing of received pack: client visitors or server handler of request, including APPLY
+		HANDLE,
+		COUNT
+	};
+
+	struct StageStatistics
+	{
+		ui64 count = 0;
+		ui64 bytes = 0;
+		/// in microseconds, only collected while timing is enabled
+		ui64 time = 0;
+	};
+
+	struct TypeStatistics
+	{
+		ui16 typeID = 0;
+		std::array<StageStatistics, static_cast<size_t>(EStage::COUNT)> stages;
+
+		const StageStatistics & operator[](EStage stage) const;
+	};
+
+	/// Measures one stage of single pack from construction until destruction
+	class DLL_LINKAGE Scope : boost::noncopyable
+	{
+		EStage stage;
+		ui16 typeID;
+		ui64 bytes = 0;
+		bool timed;
+		std::chrono::high_resolution_clock::time_point start;
+
+	public:
+		explicit Scope(EStage stage, ui16 typeID = 0);
+		~Scope();
+
+		/// type of received pack is only known after its deserialization
+		void setType(ui16 newTypeID);
+		void setBytes(ui64 newBytes);
+	};
+
+	/// type IDs of CTypeList above this limit are counted together with unknown types
+	static constexpr ui16 MAX_TYPES = 1024;
+
+	static PackStatistics & get();
+
+	void record(EStage stage, ui16 typeID, ui64 bytes, ui64 time);
+	void reset();
+
+	bool isTimingEnabled() const;
+	void setTimingEnabled(bool enabled);
+
+	/// only types that were seen at least once, sorted by type ID
+	std::vector<TypeStatistics> getStatistics() const;
+
+	/// table of pack types sorted by time (or bytes if there is no timing), at most given number of rows
+	std::string toString(size_t limit = std::numeric_limits<size_t>::max()) const;
+
+private:
+	struct AtomicStageStatistics
+	{
+		std::atomic<ui64> count{0};
+		std::atomic<ui64> bytes{0};
+		std::atomic<ui64> time{0};
+	};
+
+	using TypeEntry = std::array<AtomicStageStatistics, static_cast<size_t>(EStage::COUNT)>;
+
+	std::array<TypeEntry, MAX_TYPES> types;
+	std::atomic<bool> timingEnabled{false};
+};
+
+VCMI_LIB_NAMESPACE_END
@@ -14,6 +14,10 @@
 #include "../lib/int3.h"
 #include "../lib/mapping/CCampaignHandler.h"
 #include "../lib/StartInfo.h"
+#include "../lib/NetPacksLobby.h"
+#include "../lib/serializer/PackRecording.h"
+#include "../lib/serializer/PackStatistics.h"
+#include "../lib/Profiler.h"
 #include "../lib/CModHandler.h"
 #include "../lib/CArtHandler.h"
 #include "../lib/CBuildingHandler.h"
@@ -30,6 +34,7 @@
 #include "../lib/CGameState.h"
 #include "../lib/CStack.h"
 #include "../lib/GameSettings.h"
+#include "../lib/battle/BattleActionProcessor.h"
 #include "../lib/battle/BattleInfo.h"
 #include "../lib/CondSh.h"
 #include "ServerNetPackVisitors.h"
@@ -38,6 +43,7 @@
 #include "../lib/mapping/CMapService.h"
 #include "../lib/rmg/CMapGenOptions.h"
 #include "../lib/VCMIDirs.h"
+#include "../lib/CConfigHandler.h"
 #include "../lib/ScopeGuard.h"
 #include "../lib/CSoundBase.h"
 #include "../lib/TerrainHandler.h"
@@ -59,6 +65,11 @@
 #include <vcmi/events/GenericEvents.h>
 #include <vcmi/events/AdventureEvents.h>
 
+#ifdef VCMI_WITH_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
 #ifndef _MSC_VER
 #include <boost/thread/xtime.hpp>
 #endif
@@ -121,6 +132,46 @@ public:
 	}
 };
 
+/// Battle rules from lib, with spells cast by creatures before and after attack
+class ServerBattleActionProcessor : public BattleActionProcessor
+{
+	CGameHandler * gh;
+
+public:
+	ServerBattleActionProcessor(CGameHandler * gh)
+		: BattleActionProcessor(gh->gameState()->curB, gh->spellEnv, gh->getRandomGenerator()),
+		gh(gh)
+	{
+	}
+
+protected:
+	void beforeAttack(bool ranged, const CStack * attacker, const CStack * defender) override
+	{
+		gh->handleAttackBeforeCasting(ranged, attacker, defender);
+	}
+
+	void afterAttack(bool ranged, const CStack * attacker, const CStack * defender) override
+	{
+		gh->handleAfterAttackCasting(ranged, attacker, defender);
+	}
+};
+
+/// calls body for every index of range, in parallel if server is built with TBB
+template<typename Body>
+static void parallelForEach(size_t count, const Body & body)
+{
+#ifdef VCMI_WITH_TBB
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, count), [&](const tbb::blocked_range<size_t> & r)
+	{
+		for(size_t i = r.begin(); i != r.end(); i++)
+			body(i);
+	});
+#else
+	for(size_t i = 0; i < count; i++)
+		body(i);
+#endif
+}
+
 static inline double distance(int3 a, int3 b)
 {
 	return std::sqrt((double)(a.x-b.x)*(a.x-b.x) + (a.y-b.y)*(a.y-b.y));
@@ -908,318 +959,16 @@ void CGameHandler::battleAfterLevelUp(const BattleResult &result)
 	finishingBattle.reset();
 }
 
-void CGameHandler::makeAttack(const CStack * attacker, const CStack * defender, int distance, BattleHex targetHex, bool first, bool ranged, bool counter)
-{
-	if(first && !counter)
-		handleAttackBeforeCasting(ranged, attacker, defender);
-
-	FireShieldInfo fireShield;
-	BattleAttack bat;
-	BattleLogMessage blm;
-	bat.stackAttacking = attacker->unitId();
-	bat.tile = targetHex;
-
-	std::shared_ptr<battle::CUnitState> attackerState = attacker->acquireState();
-
-	if(ranged)
-		bat.flags |= BattleAttack::SHOT;
-	if(counter)
-		bat.flags |= BattleAttack::COUNTER;
-
-	const int attackerLuck = attacker->LuckVal();
-
-	if(attackerLuck > 0)
-	{
-		auto diceSize = VLC->settings()->getVector(EGameSettings::COMBAT_GOOD_LUCK_DICE);
-		size_t diceIndex = std::min<size_t>(diceSize.size() - 1, attackerLuck);
-
-		if(diceSize.size() > 0 && getRandomGenerator().nextInt(1, diceSize[diceIndex]) == 1)
-			bat.flags |= BattleAttack::LUCKY;
-	}
-
-	if(attackerLuck < 0)
-	{
-		auto diceSize = VLC->settings()->getVector(EGameSettings::COMBAT_BAD_LUCK_DICE);
-		size_t diceIndex = std::min<size_t>(diceSize.size() - 1, -attackerLuck);
-
-		if(diceSize.size() > 0 && getRandomGenerator().nextInt(1, diceSize[diceIndex]) == 1)
-			bat.flags |= BattleAttack::UNLUCKY;
-	}
-
-	if (getRandomGenerator().nextInt(99) < attacker->valOfBonuses(Bonus::DOUBLE_DAMAGE_CHANCE))
-	{
-		bat.flags |= BattleAttack::DEATH_BLOW;
-	}
-
-	const auto * owner = gs->curB->getHero(attacker->owner);
-	if(owner)
-	{
-		int chance = owner->valOfBonuses(Bonus::BONUS_DAMAGE_CHANCE, attacker->creatureIndex());
-		if (chance > getRandomGenerator().nextInt(99))
-			bat.flags |= BattleAttack::BALLISTA_DOUBLE_DMG;
-	}
-
-	int64_t drainedLife = 0;
-
-	// only primary target
-	if(defender->alive())
-		drainedLife += applyBattleEffects(bat, attackerState, fireShield, defender, distance, false);
-
-	//multiple-hex normal attack
-	std::set<const CStack*> attackedCreatures = gs->curB->getAttackedCreatures(attacker, targetHex, bat.shot()); //creatures other than primary target
-	for(const CStack * stack : attackedCreatures)
-	{
-		if(stack != defender && stack->alive()) //do not hit same stack twice
-			drainedLife += applyBattleEffects(bat, attackerState, fireShield, stack, distance, true);
-	}
-
-	std::shared_ptr<const Bonus> bonus = attacker->getBonusLocalFirst(Selector::type()(Bonus::SPELL_LIKE_ATTACK));
-	if(bonus && ranged) //TODO: make it work in melee?
-	{
-		//this is need for displaying hit animation
-		bat.flags |= BattleAttack::SPELL_LIKE;
-		bat.spellID = SpellID(bonus->subtype);
-
-		//TODO: should spell override creature`s projectile?
-
-		auto spell = bat.spellID.toSpell();
-
-		battle::Target target;
-		target.emplace_back(defender, targetHex);
-
-		spells::BattleCast event(gs->curB, attacker, spells::Mode::SPELL_LIKE_ATTACK, spell);
-		event.setSpellLevel(bonus->val);
-
-		auto attackedCreatures = spell->battleMechanics(&event)->getAffectedStacks(target);
-
-		//TODO: get exact attacked hex for defender
-
-		for(const CStack * stack : attackedCreatures)
-		{
-			if(stack != defender && stack->alive()) //do not hit same stack twice
-			{
-				drainedLife += applyBattleEffects(bat, attackerState, fireShield, stack, distance, true);
-			}
-		}
-
-		//now add effect info for all attacked stacks
-		for (BattleStackAttacked & bsa : bat.bsa)
-		{
-			if (bsa.attackerID == attacker->ID) //this is our attack and not f.e. fire shield
-			{
-				//this is need for displaying affect animation
-				bsa.flags |= BattleStackAttacked::SPELL_EFFECT;
-				bsa.spellID = SpellID(bonus->subtype);
-			}
-		}
-	}
-
-	attackerState->afterAttack(ranged, counter);
-
-	{
-		UnitChanges info(attackerState->unitId(), UnitChanges::EOperation::RESET_STATE);
-		attackerState->save(info.data);
-		bat.attackerChanges.changedStacks.push_back(info);
-	}
-
-	if (drainedLife > 0)
-		bat.flags |= BattleAttack::LIFE_DRAIN;
-
-	sendAndApply(&bat);
-
-	{
-		const bool multipleTargets = bat.bsa.size() > 1;
-
-		int64_t totalDamage = 0;
-		int32_t totalKills = 0;
-
-		for(const BattleStackAttacked & bsa : bat.bsa)
-		{
-			totalDamage += bsa.damageAmount;
-			totalKills += bsa.killedAmount;
-		}
-
-		{
-			MetaString text;
-			attacker->addText(text, MetaString::GENERAL_TXT, 376);
-			attacker->addNameReplacement(text);
-			text.addReplacement(totalDamage);
-			blm.lines.push_back(text);
-		}
-
-		addGenericKilledLog(blm, defender, totalKills, multipleTargets);
-	}
-
-	// drain life effect (as well as log entry) must be applied after the attack
-	if(drainedLife > 0)
-	{
-		MetaString text;
-		attackerState->addText(text, MetaString::GENERAL_TXT, 361);
-		attackerState->addNameReplacement(text, false);
-		text.addReplacement(drainedLife);
-		defender->addNameReplacement(text, true);
-		blm.lines.push_back(std::move(text));
-	}
-
-	if(!fireShield.empty())
-	{
-		//todo: this should be "virtual" spell instead, we only need fire spell school bonus here
-		const CSpell * fireShieldSpell = SpellID(SpellID::FIRE_SHIELD).toSpell();
-		int64_t totalDamage = 0;
-
-		for(const auto & item : fireShield)
-		{
-			const CStack * actor = item.first;
-			int64_t rawDamage = item.second;
-
-			const CGHeroInstance * actorOwner = gs->curB->getHero(actor->owner);
-
-			if(actorOwner)
-			{
-				rawDamage = fireShieldSpell->adjustRawDamage(actorOwner, attacker, rawDamage);
-			}
-			else
-			{
-				rawDamage = fireShieldSpell->adjustRawDamage(actor, attacker, rawDamage);
-			}
-
-			totalDamage+=rawDamage;
-			//FIXME: add custom effect on actor
-		}
-
-		if (totalDamage > 0)
-		{
-			BattleStackAttacked bsa;
-
-			bsa.flags |= BattleStackAttacked::FIRE_SHIELD;
-			bsa.stackAttacked = attacker->ID; //invert
-			bsa.attackerID = defender->ID;
-			bsa.damageAmount = totalDamage;
-			attacker->prepareAttacked(bsa, getRandomGenerator());
-
-			StacksInjured pack;
-			pack.stacks.push_back(bsa);
-			sendAndApply(&pack);
-
-			// TODO: this is already implemented in Damage::describeEffect()
-			{
-				MetaString text;
-				text.addTxt(MetaString::GENERAL_TXT, 376);
-				text.addReplacement(MetaString::SPELL_NAME, SpellID::FIRE_SHIELD);
-				text.addReplacement(totalDamage);
-				blm.lines.push_back(std::move(text));
-			}
-			addGenericKilledLog(blm, attacker, bsa.killedAmount, false);
-		}
-	}
-
-	sendAndApply(&blm);
-
-	handleAfterAttackCasting(ranged, attacker, defender);
-}
-
-int64_t CGameHandler::applyBattleEffects(BattleAttack & bat, std::shared_ptr<battle::CUnitState> attackerState, FireShieldInfo & fireShield, const CStack * def, int distance, bool secondary)
-{
-	BattleStackAttacked bsa;
-	if(secondary)
-		bsa.flags |= BattleStackAttacked::SECONDARY; //all other targets do not suffer from spells & spell-like abilities
-
-	bsa.attackerID = attackerState->unitId();
-	bsa.stackAttacked = def->unitId();
-	{
-		BattleAttackInfo bai(attackerState.get(), def, distance, bat.shot());
-
-		bai.deathBlow = bat.deathBlow();
-		bai.doubleDamage = bat.ballistaDoubleDmg();
-		bai.luckyStrike  = bat.lucky();
-		bai.unluckyStrike  = bat.unlucky();
-
-		auto range = gs->curB->calculateDmgRange(bai);
-		bsa.damageAmount = gs->curB->getActualDamage(range.damage, attackerState->getCount(), getRandomGenerator());
-		CStack::prepareAttacked(bsa, getRandomGenerator(), bai.defender->acquireState()); //calculate casualties
-	}
-
-	int64_t drainedLife = 0;
-
-	//life drain handling
-	if(attackerState->hasBonusOfType(Bonus::LIFE_DRAIN) && def->isLiving())
-	{
-		int64_t toHeal = bsa.damageAmount * attackerState->valOfBonuses(Bonus::LIFE_DRAIN) / 100;
-		attackerState->heal(toHeal, EHealLevel::RESURRECT, EHealPower::PERMANENT);
-		drainedLife += toHeal;
-	}
-
-	//soul steal handling
-	if(attackerState->hasBonusOfType(Bonus::SOUL_STEAL) && def->isLiving())
-	{
-		//we can have two bonuses - one with subtype 0 and another with subtype 1
-		//try to use permanent first, use only one of two
-		for(si32 subtype = 1; subtype >= 0; subtype--)
-		{
-			if(attackerState->hasBonusOfType(Bonus::SOUL_STEAL, subtype))
-			{
-				int64_t toHeal = bsa.killedAmount * attackerState->valOfBonuses(Bonus::SOUL_STEAL, subtype) * attackerState->MaxHealth();
-				attackerState->heal(toHeal, EHealLevel::OVERHEAL, ((subtype == 0) ? EHealPower::ONE_BATTLE : EHealPower::PERMANENT));
-				drainedLife += toHeal;
-				break;
-			}
-		}
-	}
-	bat.bsa.push_back(bsa); //add this stack to the list of victims after drain life has been calculated
-
-	//fire shield handling
-	if(!bat.shot() &&
-		!def->isClone() &&
-		def->hasBonusOfType(Bonus::FIRE_SHIELD) &&
-		!attackerState->hasBonusOfType(Bonus::FIRE_IMMUNITY) &&
-		CStack::isMeleeAttackPossible(attackerState.get(), def) // attacked needs to be adjacent to defender for fire shield to trigger (e.g. Dragon Breath attack)
-			)
-	{
-		//TODO: use damage with bonus but without penalties
-		auto fireShieldDamage = (std::min<int64_t>(def->getAvailableHealth(), bsa.damageAmount) * def->valOfBonuses(Bonus::FIRE_SHIELD)) / 100;
-		fireShield.push_back(std::make_pair(def, fireShieldDamage));
-	}
-
-	return drainedLife;
-}
-
 void CGameHandler::sendGenericKilledLog(const CStack * defender, int32_t killed, bool multiple)
 {
 	if(killed > 0)
 	{
 		BattleLogMessage blm;
-		addGenericKilledLog(blm, defender, killed, multiple);
+		BattleActionProcessor::addGenericKilledLog(blm, defender, killed, multiple);
 		sendAndApply(&blm);
 	}
 }
 
-void CGameHandler::addGenericKilledLog(BattleLogMessage & blm, const CStack * defender, int32_t killed, bool multiple)
-{
-	if(killed > 0)
-	{
-		const int32_t txtIndex = (killed > 1) ? 379 : 378;
-		std::string formatString = VLC->generaltexth->allTexts[txtIndex];
-
-		// these default h3 texts have unnecessary new lines, so get rid of them before displaying (and trim just in case, trimming newlines does not works for some reason)
-		formatString.erase(std::remove(formatString.begin(), formatString.end(), '\n'), formatString.end());
-		formatString.erase(std::remove(formatString.begin(), formatString.end(), '\r'), formatString.end());
-		boost::algorithm::trim(formatString);
-
-		boost::format txt(formatString);
-		if(killed > 1)
-		{
-			txt % killed % (multiple ? VLC->generaltexth->allTexts[43] : defender->unitType()->getNamePluralTranslated()); // creatures perish
-		}
-		else //killed == 1
-		{
-			txt % (multiple ? VLC->generaltexth->allTexts[42] : defender->unitType()->getNameSingularTranslated()); // creature perishes
-		}
-		MetaString line;
-		line << txt.str();
-		blm.lines.push_back(std::move(line));
-	}
-}
-
 void CGameHandler::handleClientDisconnection(std::shared_ptr<CConnection> c)
 {
 	if(lobby->state == EServerState::SHUTDOWN || !gs || !gs->scenarioOps)
@@ -1251,16 +1000,19 @@ void CGameHandler::handleReceivedPack(CPackForServer * pack)
 		applied.result = succesfullyApplied;
 		applied.packType = typeList.getTypeID(pack);
 		applied.requestID = pack->requestID;
-		pack->c->sendPack(&applied);
+		sendToClient(pack->c, &applied);
 	};
 
-	CBaseForGHApply * apply = applier->getApplier(typeList.getTypeID(pack)); //and appropriate applier object
+	const ui16 typeID = typeList.getTypeID(pack);
+	CBaseForGHApply * apply = applier->getApplier(typeID); //and appropriate applier object
 	if(isBlockedByQueries(pack, pack->player))
 	{
 		sendPackageResponse(false);
 	}
 	else if(apply)
 	{
+		PackStatistics::Scope scope(PackStatistics::EStage::HANDLE, typeID);
+		PROFILE_ZONE_DETAIL("CGameHandler::handleReceivedPack", typeid(*pack).name());
 		const bool result = apply->applyOnGH(this, this->gs, pack);
 		if(result)
 			logGlobal->trace("Message %s successfully applied!", typeid(*pack).name());
@@ -1279,299 +1031,9 @@ void CGameHandler::handleReceivedPack(CPackForServer * pack)
 	vstd::clear_pointer(pack);
 }
 
-int CGameHandler::moveStack(int stack, BattleHex dest)
-{
-	int ret = 0;
-
-	const CStack *curStack = gs->curB->battleGetStackByID(stack),
-		*stackAtEnd = gs->curB->battleGetStackByPos(dest);
-
-	assert(curStack);
-	assert(dest < GameConstants::BFIELD_SIZE);
-
-	if (gs->curB->tacticDistance)
-	{
-		assert(gs->curB->isInTacticRange(dest));
-	}
-
-	auto start = curStack->getPosition();
-	if (start == dest)
-		return 0;
-
-	//initing necessary tables
-	auto accessibility = getAccesibility(curStack);
-	std::set<BattleHex> passed;
-	//Ignore obstacles on starting position
-	passed.insert(curStack->getPosition());
-	if(curStack->doubleWide())
-		passed.insert(curStack->occupiedHex());
-
-	//shifting destination (if we have double wide stack and we can occupy dest but not be exactly there)
-	if(!stackAtEnd && curStack->doubleWide() && !accessibility.accessible(dest, curStack))
-	{
-		BattleHex shifted = dest.cloneInDirection(curStack->destShiftDir(), false);
-
-		if(accessibility.accessible(shifted, curStack))
-			dest = shifted;
-	}
-
-	if((stackAtEnd && stackAtEnd!=curStack && stackAtEnd->alive()) || !accessibility.accessible(dest, curStack))
-	{
-		complain("Given destination is not accessible!");
-		return 0;
-	}
-
-	bool canUseGate = false;
-	auto dbState = gs->curB->si.gateState;
-	if(battleGetSiegeLevel() > 0 && curStack->side == BattleSide::DEFENDER &&
-		dbState != EGateState::DESTROYED &&
-		dbState != EGateState::BLOCKED)
-	{
-		canUseGate = true;
-	}
-
-	std::pair< std::vector<BattleHex>, int > path = gs->curB->getPath(start, dest, curStack);
-
-	ret = path.second;
-
-	int creSpeed = curStack->Speed(0, true);
-
-	if (gs->curB->tacticDistance > 0 && creSpeed > 0)
-		creSpeed = GameConstants::BFIELD_SIZE;
-
-	bool hasWideMoat = vstd::contains_if(battleGetAllObstaclesOnPos(BattleHex(ESiegeHex::GATE_BRIDGE), false), [](const std::shared_ptr<const CObstacleInstance> & obst)
-	{
-		return obst->obstacleType == CObstacleInstance::MOAT;
-	});
-
-	auto isGateDrawbridgeHex = [&](BattleHex hex) -> bool
-	{
-		if (hasWideMoat && hex == ESiegeHex::GATE_BRIDGE)
-			return true;
-		if (hex == ESiegeHex::GATE_OUTER)
-			return true;
-		if (hex == ESiegeHex::GATE_INNER)
-			return true;
-
-		return false;
-	};
-
-	auto occupyGateDrawbridgeHex = [&](BattleHex hex) -> bool
-	{
-		if (isGateDrawbridgeHex(hex))
-			return true;
-
-		if (curStack->doubleWide())
-		{
-			BattleHex otherHex = curStack->occupiedHex(hex);
-			if (otherHex.isValid() && isGateDrawbridgeHex(otherHex))
-				return true;
-		}
-
-		return false;
-	};
-
-	if (curStack->hasBonusOfType(Bonus::FLYING))
-	{
-		if (path.second <= creSpeed && path.first.size() > 0)
-		{
-			if (canUseGate && dbState != EGateState::OPENED &&
-				occupyGateDrawbridgeHex(dest))
-			{
-				BattleUpdateGateState db;
-				db.state = EGateState::OPENED;
-				sendAndApply(&db);
-			}
-
-			//inform clients about move
-			BattleStackMoved sm;
-			sm.stack = curStack->ID;
-			std::vector<BattleHex> tiles;
-			tiles.push_back(path.first[0]);
-			sm.tilesToMove = tiles;
-			sm.distance = path.second;
-			sm.teleporting = false;
-			sendAndApply(&sm);
-		}
-	}
-	else //for non-flying creatures
-	{
-		std::vector<BattleHex> tiles;
-		const int tilesToMove = std::max((int)(path.first.size() - creSpeed), 0);
-		int v = (int)path.first.size()-1;
-		path.first.push_back(start);
-
-		// check if gate need to be open or closed at some point
-		BattleHex openGateAtHex, gateMayCloseAtHex;
-		if (canUseGate)
-		{
-			for (int i = (int)path.first.size()-1; i >= 0; i--)
-			{
-				auto needOpenGates = [&](BattleHex hex) -> bool
-				{
-					if (hasWideMoat && hex == ESiegeHex::GATE_BRIDGE)
-						return true;
-					if (hex == ESiegeHex::GATE_BRIDGE && i-1 >= 0 && path.first[i-1] == ESiegeHex::GATE_OUTER)
-						return true;
-					else if (hex == ESiegeHex::GATE_OUTER || hex == ESiegeHex::GATE_INNER)
-						return true;
-
-					return false;
-				};
-
-				auto hex = path.first[i];
-				if (!openGateAtHex.isValid() && dbState != EGateState::OPENED)
-				{
-					if (needOpenGates(hex))
-						openGateAtHex = path.first[i+1];
-
-					//TODO we need find batter way to handle double-wide stacks
-					//currently if only second occupied stack part is standing on gate / bridge hex then stack will start to wait for bridge to lower before it's needed. Though this is just a visual bug.
-					if (curStack->doubleWide())
-					{
-						BattleHex otherHex = curStack->occupiedHex(hex);
-						if (otherHex.isValid() && needOpenGates(otherHex))
-							openGateAtHex = path.first[i+2];
-					}
-
-					//gate may be opened and then closed during stack movement, but not other way around
-					if (openGateAtHex.isValid())
-						dbState = EGateState::OPENED;
-				}
-
-				if (!gateMayCloseAtHex.isValid() && dbState != EGateState::CLOSED)
-				{
-					if (hex == ESiegeHex::GATE_INNER && i-1 >= 0 && path.first[i-1] != ESiegeHex::GATE_OUTER)
-					{
-						gateMayCloseAtHex = path.first[i-1];
-					}
-					if (hasWideMoat)
-					{
-						if (hex == ESiegeHex::GATE_BRIDGE && i-1 >= 0 && path.first[i-1] != ESiegeHex::GATE_OUTER)
-						{
-							gateMayCloseAtHex = path.first[i-1];
-						}
-						else if (hex == ESiegeHex::GATE_OUTER && i-1 >= 0 &&
-							path.first[i-1] != ESiegeHex::GATE_INNER &&
-							path.first[i-1] != ESiegeHex::GATE_BRIDGE)
-						{
-							gateMayCloseAtHex = path.first[i-1];
-						}
-					}
-					else if (hex == ESiegeHex::GATE_OUTER && i-1 >= 0 && path.first[i-1] != ESiegeHex::GATE_INNER)
-					{
-						gateMayCloseAtHex = path.first[i-1];
-					}
-				}
-			}
-		}
-
-		bool stackIsMoving = true;
-
-		while(stackIsMoving)
-		{
-			if (v<tilesToMove)
-			{
-				logGlobal->error("Movement terminated abnormally");
-				break;
-			}
-
-			bool gateStateChanging = false;
-			//special handling for opening gate on from starting hex
-			if (openGateAtHex.isValid() && openGateAtHex == start)
-				gateStateChanging = true;
-			else
-			{
-				for (bool obstacleHit = false; (!obstacleHit) && (!gateStateChanging) && (v >= tilesToMove); --v)
-				{
-					BattleHex hex = path.first[v];
-					tiles.push_back(hex);
-
-					if ((openGateAtHex.isValid() && openGateAtHex == hex) ||
-						(gateMayCloseAtHex.isValid() && gateMayCloseAtHex == hex))
-					{
-						gateStateChanging = true;
-					}
-
-					//if we walked onto something, finalize this portion of stack movement check into obstacle
-					if(!battleGetAllObstaclesOnPos(hex, false).empty())
-						obstacleHit = true;
-
-					if (curStack->doubleWide())
-					{
-						BattleHex otherHex = curStack->occupiedHex(hex);
-						//two hex creature hit obstacle by backside
-						auto obstacle2 = battleGetAllObstaclesOnPos(otherHex, false);
-						if(otherHex.isValid() && !obstacle2.empty())
-							obstacleHit = true;
-					}
-					if(!obstacleHit)
-						passed.insert(hex);
-				}
-			}
-
-			if (!tiles.empty())
-			{
-				//commit movement
-				BattleStackMoved sm;
-				sm.stack = curStack->ID;
-				sm.distance = path.second;
-				sm.teleporting = false;
-				sm.tilesToMove = tiles;
-				sendAndApply(&sm);
-				tiles.clear();
-			}
-
-			//we don't handle obstacle at the destination tile -> it's handled separately in the if at the end
-			if (curStack->getPosition() != dest)
-			{
-				if(stackIsMoving && start != curStack->getPosition())
-				{
-					stackIsMoving = handleObstacleTriggersForUnit(*spellEnv, *curStack, passed);
-					passed.insert(curStack->getPosition());
-					if(curStack->doubleWide())
-						passed.insert(curStack->occupiedHex());
-				}
-				if (gateStateChanging)
-				{
-					if (curStack->getPosition() == openGateAtHex)
-					{
-						openGateAtHex = BattleHex();
-						//only open gate if stack is still alive
-						if (curStack->alive())
-						{
-							BattleUpdateGateState db;
-							db.state = EGateState::OPENED;
-							sendAndApply(&db);
-						}
-					}
-					else if (curStack->getPosition() == gateMayCloseAtHex)
-					{
-						gateMayCloseAtHex = BattleHex();
-						updateGateState();
-					}
-				}
-			}
-			else
-				//movement finished normally: we reached destination
-				stackIsMoving = false;
-		}
-	}
-	//handle last hex separately for deviation
-	if (VLC->settings()->getBoolean(EGameSettings::COMBAT_ONE_HEX_TRIGGERS_OBSTACLES))
-	{
-		if (dest == battle::Unit::occupiedHex(start, curStack->doubleWide(), curStack->side)
-			|| start == battle::Unit::occupiedHex(dest, curStack->doubleWide(), curStack->side))
-			passed.clear(); //Just empty passed, obstacles will handled automatically
-	}
-	//handling obstacle on the final field (separate, because it affects both flying and walking stacks)
-	handleObstacleTriggersForUnit(*spellEnv, *curStack, passed);
-
-	return ret;
-}
-
 CGameHandler::CGameHandler(CVCMIServer * lobby)
 	: lobby(lobby)
+	, packJournal(PACK_JOURNAL_SIZE)
 	, complainNoCreatures("No creatures to split")
 	, complainNotEnoughCreatures("Cannot split that stack, not enough creatures!")
 	, complainInvalidSlot("Invalid slot accessed!")
@@ -1688,6 +1150,17 @@ void CGameHandler::newTurn()
 	bool newMonth = getDate(Date::DAY_OF_MONTH) == 28;
 
 	std::map<PlayerColor, si32> hadGold;//starting gold - for buildings like dwarven treasury
+	std::vector<CGHeroInstance *> heroes; //heroes of all players, in order of players
+
+	//wall time, so that time of parallel parts is not summed over threads
+	auto lastTime = std::chrono::high_resolution_clock::now();
+	auto elapsedMs = [&lastTime]()
+	{
+		auto now = std::chrono::high_resolution_clock::now();
+		auto ret = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTime).count();
+		lastTime = now;
+		return ret;
+	};
 
 	if (firstTurn)
 	{
@@ -1855,43 +1328,63 @@ void CGameHandler::newTurn()
 			if (h->visitedTown)
 				giveSpells(h->visitedTown, h);
 
-			NewTurn::Hero hth;
-			hth.id = h->id;
-			auto ti = std::make_unique<TurnInfo>(h, 1);
-			// TODO: this code executed when bonuses of previous day not yet updated (this happen in NewTurn::applyGs). See issue 2356
-			hth.move = h->maxMovePointsCached(gs->map->getTile(h->visitablePos()).terType->isLand(), ti.get());
-			hth.mana = h->getManaNewTurn();
-
-			n.heroes.insert(hth);
-
-			if (!firstTurn) //not first day
-			{
-				for (int k = 0; k < GameConstants::RESOURCE_QUANTITY; k++)
-				{
-					n.res[elem.first][k] += h->valOfBonuses(Bonus::GENERATE_RESOURCE, k);
-				}
-			}
+			heroes.push_back(h);
 		}
 	}
+
+	//town events may build structures, so they must be handled before growth and income are computed
 	for (CGTownInstance *t : gs->map->towns)
 	{
-		PlayerColor player = t->tempOwner;
 		handleTownEvents(t, n);
-		if (newWeek) //first day of week
+
+		if (newWeek && t->hasBuilt(BuildingSubID::PORTAL_OF_SUMMONING))
+			setPortalDwelling(t, true, (n.specialWeek == NewTurn::PLAGUE ? true : false)); //set creatures for Portal of Summoning
+	}
+	logGlobal->debug("New turn: players and town events: %d ms", elapsedMs());
+
+	//heroes and towns are only read from here until results are merged, so they can be processed in parallel
+	std::vector<NewTurn::Hero> heroUpdates(heroes.size());
+	std::vector<TResources> heroIncome(heroes.size());
+
+	parallelForEach(heroes.size(), [&](size_t i)
+	{
+		const CGHeroInstance * h = heroes[i];
+
+		heroUpdates[i].id = h->id;
+		auto ti = std::make_unique<TurnInfo>(h, 1);
+		// TODO: this code executed when bonuses of previous day not yet updated (this happen in NewTurn::applyGs). See issue 2356
+		heroUpdates[i].move = h->maxMovePointsCached(gs->map->getTile(h->visitablePos()).terType->isLand(), ti.get());
+		heroUpdates[i].mana = h->getManaNewTurn();
+
+		if (!firstTurn) //not first day
 		{
-			if (t->hasBuilt(BuildingSubID::PORTAL_OF_SUMMONING))
-				setPortalDwelling(t, true, (n.specialWeek == NewTurn::PLAGUE ? true : false)); //set creatures for Portal of Summoning
+			for (int k = 0; k < GameConstants::RESOURCE_QUANTITY; k++)
+				heroIncome[i][k] = h->valOfBonuses(Bonus::GENERATE_RESOURCE, k);
+		}
+	});
+	logGlobal->debug("New turn: %d heroes: %d ms", heroes.size(), elapsedMs());
 
-			if (!firstTurn)
-				if (t->hasBuilt(BuildingSubID::TREASURY) && player < PlayerColor::PLAYER_LIMIT)
-						n.res[player][EGameResID::GOLD] += hadGold.at(player)/10; //give 10% of starting gold
+	auto & towns = gs->map->towns;
+	std::vector<SetAvailableCreatures> townCreatures(towns.size());
+	std::vector<TResources> townIncome(towns.size());
 
-			if (!vstd::contains(n.cres, t->id))
-			{
-				n.cres[t->id].tid = t->id;
-				n.cres[t->id].creatures = t->creatures;
-			}
-			auto & sac = n.cres.at(t->id);
+	if (newWeek) //first day of week
+	{
+		for (size_t i = 0; i < towns.size(); i++)
+		{
+			auto events = n.cres.find(towns[i]->id);
+			townCreatures[i].tid = towns[i]->id;
+			townCreatures[i].creatures = events != n.cres.end() ? events->second.creatures : towns[i]->creatures;
+		}
+	}
+
+	parallelForEach(towns.size(), [&](size_t i)
+	{
+		const CGTownInstance * t = towns[i];
+
+		if (newWeek) //first day of week
+		{
+			auto & sac = townCreatures[i];
 
 			for (int k=0; k < GameConstants::CREATURES_PER_TOWN; k++) //creature growths
 			{
@@ -1924,9 +1417,37 @@ void CGameHandler::newTurn()
 				}
 			}
 		}
+
+		if (!firstTurn && t->tempOwner < PlayerColor::PLAYER_LIMIT) //not the first day and town not neutral
+			townIncome[i] = t->dailyIncome();
+	});
+	logGlobal->debug("New turn: %d towns: %d ms", towns.size(), elapsedMs());
+
+	//results are merged in the same order as they were computed before, so pack does not depend on number of threads
+	for (size_t i = 0; i < heroes.size(); i++)
+	{
+		n.heroes.insert(heroUpdates[i]);
+
+		if (!firstTurn)
+			n.res[heroes[i]->tempOwner] += heroIncome[i];
+	}
+
+	for (size_t i = 0; i < towns.size(); i++)
+	{
+		CGTownInstance * t = towns[i];
+		PlayerColor player = t->tempOwner;
+
+		if (newWeek) //first day of week
+		{
+			if (!firstTurn)
+				if (t->hasBuilt(BuildingSubID::TREASURY) && player < PlayerColor::PLAYER_LIMIT)
+						n.res[player][EGameResID::GOLD] += hadGold.at(player)/10; //give 10% of starting gold
+
+			n.cres[t->id] = townCreatures[i];
+		}
 		if (!firstTurn  &&  player < PlayerColor::PLAYER_LIMIT)//not the first day and town not neutral
 		{
-			n.res[player] = n.res[player] + t->dailyIncome();
+			n.res[player] = n.res[player] + townIncome[i];
 		}
 		if(t->hasBuilt(BuildingID::GRAIL)
 			&& t->town->buildings.at(BuildingID::GRAIL)->height == CBuilding::HEIGHT_SKYSHIP)
@@ -1969,7 +1490,9 @@ void CGameHandler::newTurn()
 		pickAllowedArtsSet(saa.arts, getRandomGenerator());
 		sendAndApply(&saa);
 	}
+	logGlobal->debug("New turn: town effects: %d ms", elapsedMs());
 	sendAndApply(&n);
+	logGlobal->debug("New turn: applying pack: %d ms", elapsedMs());
 
 	if (newWeek)
 	{
@@ -2034,8 +1557,35 @@ void CGameHandler::newTurn()
 		if (elem)
 			elem->newTurn(getRandomGenerator());
 	}
+	logGlobal->debug("New turn: objects: %d ms", elapsedMs());
+
+	const auto & network = CConnection::statistics();
+	logNetwork->debug("Network: %d packs (%d bytes) serialized, %d packs (%d bytes) sent", network.packsSerialized.load(), network.bytesSerialized.load(), network.packsSent.load(), network.bytesSent.load());
 
 	synchronizeArtifactHandlerLists(); //new day events may have changed them. TODO better of managing that
+
+	const int checkpointDays = std::max<int>(1, settings["server"]["packJournal"]["checkpointDays"].Integer());
+	if(packRecorder && gs->day > 1 && (gs->day - 1) % checkpointDays == 0)
+	{
+		//only snapshot of game state is taken under lock, clients are not stalled while it is written to disk
+		std::unique_ptr<PackCheckpoint> checkpoint;
+		{
+			boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
+			if(packRecorder)
+				checkpoint = packRecorder->takeCheckpoint(*this);
+		}
+
+		try
+		{
+			if(checkpoint)
+				checkpoint->save();
+		}
+		catch(const std::exception & e)
+		{
+			//replay can still start from earlier checkpoints
+			logGlobal->error("Failed to save checkpoint of pack journal: %s", e.what());
+		}
+	}
 }
 void CGameHandler::run(bool resume)
 {
@@ -2058,6 +1608,9 @@ void CGameHandler::run(bool resume)
 		logGlobal->info(sbuffer.str());
 	}
 
+	if(settings["server"]["packJournal"]["enabled"].Bool())
+		startPackRecording();
+
 #if SCRIPTING_ENABLED
 	services()->scripts()->run(serverScripts);
 #endif
@@ -2695,8 +2248,7 @@ void CGameHandler::sendMessageTo(std::shared_ptr<CConnection> c, const std::stri
 {
 	SystemMessage sm;
 	sm.text = message;
-	boost::unique_lock<boost::mutex> lock(*c->mutexWrite);
-	*(c.get()) << &sm;
+	sendToClient(c, &sm);
 }
 
 void CGameHandler::giveHeroBonus(GiveBonus * bonus)
@@ -2828,48 +2380,186 @@ void CGameHandler::useScholarSkill(ObjectInstanceID fromHero, ObjectInstanceID t
 	}
 }
 
-void CGameHandler::heroExchange(ObjectInstanceID hero1, ObjectInstanceID hero2)
+void CGameHandler::heroExchange(ObjectInstanceID hero1, ObjectInstanceID hero2)
+{
+	auto h1 = getHero(hero1), h2 = getHero(hero2);
+
+	if (getPlayerRelations(h1->getOwner(), h2->getOwner()))
+	{
+		auto exchange = std::make_shared<CGarrisonDialogQuery>(this, h1, h2);
+		ExchangeDialog hex;
+		hex.queryID = exchange->queryID;
+		hex.player = h1->getOwner();
+		hex.hero1 = hero1;
+		hex.hero2 = hero2;
+		sendAndApply(&hex);
+
+		useScholarSkill(hero1,hero2);
+		queries.addQuery(exchange);
+	}
+}
+
+PackJournal::Frame CGameHandler::sendToAllClients(CPackForClient * pack)
+{
+	logNetwork->trace("\tSending to all clients: %s", typeid(*pack).name());
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
+
+	//pack is serialized once, same bytes are queued by all connections, e.g. of spectators, and kept in journal
+	//lost connections can still serialize packs, so journal is kept while player reconnects
+	CConnection::SharedFrame frame;
+	for(auto c : journaledConnections)
+	{
+		if(c->canShareFrames())
+		{
+			frame = c->serializePack(pack);
+			break;
+		}
+	}
+
+	if(frame)
+		packJournal.append(PackJournal::ALL_CLIENTS, frame);
+	else
+		packJournal.clear();
+
+	for (auto c : lobby->connections)
+	{
+		//connection of reconnecting client receives packs once it has game state
+		if(!c->isOpen() || !vstd::contains(journaledConnections, c))
+			continue;
+
+		if(frame && c->canShareFrames())
+			c->sendFrame(frame);
+		else
+			c->sendPack(pack);
+	}
+
+	return frame;
+}
+
+void CGameHandler::sendToClient(std::shared_ptr<CConnection> c, CPackForClient * pack)
 {
-	auto h1 = getHero(hero1), h2 = getHero(hero2);
+	logNetwork->trace("\tSending to %s: %s", c->toString(), typeid(*pack).name());
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
 
-	if (getPlayerRelations(h1->getOwner(), h2->getOwner()))
+	if(!c->canShareFrames())
 	{
-		auto exchange = std::make_shared<CGarrisonDialogQuery>(this, h1, h2);
-		ExchangeDialog hex;
-		hex.queryID = exchange->queryID;
-		hex.player = h1->getOwner();
-		hex.hero1 = hero1;
-		hex.hero2 = hero2;
-		sendAndApply(&hex);
+		packJournal.clear();
 
-		useScholarSkill(hero1,hero2);
-		queries.addQuery(exchange);
+		if(c->isOpen())
+			c->sendPack(pack);
+		return;
 	}
+
+	auto frame = c->serializePack(pack);
+	packJournal.append(c->connectionID, frame);
+
+	if(c->isOpen())
+		c->sendFrame(frame);
 }
 
-void CGameHandler::sendToAllClients(CPackForClient * pack)
+void CGameHandler::addJournaledConnection(std::shared_ptr<CConnection> c)
 {
-	logNetwork->trace("\tSending to all clients: %s", typeid(*pack).name());
-	for (auto c : lobby->connections)
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
+
+	//lost connection of same client is no longer needed
+	vstd::erase_if(journaledConnections, [&](const std::shared_ptr<CConnection> & other)
 	{
-		if(!c->isOpen())
-			continue;
+		return other->connectionID == c->connectionID;
+	});
+
+	journaledConnections.insert(c);
+	packJournal.startClient(c->connectionID);
+}
+
+bool CGameHandler::synchronizeClient(std::shared_ptr<CConnection> c, std::optional<ui64> receivedPacks)
+{
+	//state and missing packs must not be interleaved with packs sent in meantime
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
+
+	LobbyStartGame startGame;
+	startGame.initializedStartInfo = lobby->si;
+	startGame.clientId = c->connectionID;
+
+	std::vector<PackJournal::Frame> missingPacks;
+	startGame.resync = receivedPacks && packJournal.missingPacks(c->connectionID, *receivedPacks, missingPacks);
+
+	if(startGame.resync)
+		logNetwork->info("Resynchronizing %s: %d packs, %d packs in journal", c->toString(), missingPacks.size(), packJournal.packsCount());
+	else
+		startGame.initializedGameState = gs;
+
+	c->sendPack(&startGame);
+	c->enterGameplayConnectionMode(gs);
+
+	if(startGame.resync)
+	{
+		//packs are only sent to this client, journal keeps counting packs from its original state
+		vstd::erase_if(journaledConnections, [&](const std::shared_ptr<CConnection> & other)
+		{
+			return other->connectionID == c->connectionID;
+		});
+		journaledConnections.insert(c);
 
-		c->sendPack(pack);
+		for(const auto & frame : missingPacks)
+			c->sendFrame(frame);
+	}
+	else
+	{
+		addJournaledConnection(c);
 	}
+
+	return startGame.resync;
 }
 
 void CGameHandler::sendAndApply(CPackForClient * pack)
 {
-	sendToAllClients(pack);
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
+	auto frame = sendToAllClients(pack);
 	gs->apply(pack);
 	logNetwork->trace("\tApplied on gs: %s", typeid(*pack).name());
+	recordAppliedPack(pack, frame);
 }
 
 void CGameHandler::applyAndSend(CPackForClient * pack)
 {
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
 	gs->apply(pack);
-	sendToAllClients(pack);
+	recordAppliedPack(pack, sendToAllClients(pack));
+}
+
+void CGameHandler::startPackRecording()
+{
+	boost::unique_lock<boost::recursive_mutex> lock(packJournalMutex);
+
+	const auto time = boost::posix_time::second_clock::local_time();
+	const auto directory = VCMIDirs::get().userDataPath() / "Journals" / boost::posix_time::to_iso_string(time);
+
+	try
+	{
+		packRecorder = std::make_unique<PackRecorder>(directory);
+		packRecorder->recordCheckpoint(*this);
+	}
+	catch(const std::exception & e)
+	{
+		logGlobal->error("Failed to start recording of packs: %s", e.what());
+		packRecorder.reset();
+	}
+}
+
+void CGameHandler::recordAppliedPack(CPackForClient * pack, const PackJournal::Frame & frame)
+{
+	if(!packRecorder)
+		return;
+
+	//frame is serialized by connections, without it pack can't be recorded in same form as clients receive it
+	if(!frame)
+	{
+		logGlobal->error("Pack %s can not be recorded, recording of %s stopped", typeid(*pack).name(), packRecorder->getDirectory().string());
+		packRecorder.reset();
+		return;
+	}
+
+	packRecorder->recordPack(*frame);
 }
 
 void CGameHandler::sendAndApply(CGarrisonOperationPack * pack)
@@ -2900,7 +2590,7 @@ void CGameHandler::throwNotAllowedAction(CPackForServer * pack)
 	if(pack->c)
 	{
 		SystemMessage temp_message("You are not allowed to perform this action!");
-		pack->c->sendPack(&temp_message);
+		sendToClient(pack->c, &temp_message);
 	}
 	logNetwork->error("Player is not allowed to perform this action!");
 	throw ExceptionNotAllowedAction();
@@ -2914,7 +2604,7 @@ void CGameHandler::wrongPlayerMessage(CPackForServer * pack, PlayerColor expecte
 	if(pack->c)
 	{
 		SystemMessage temp_message(oss.str());
-		pack->c->sendPack(&temp_message);
+		sendToClient(pack->c, &temp_message);
 	}
 }
 
@@ -2944,6 +2634,7 @@ void CGameHandler::throwAndComplain(CPackForServer * pack, std::string txt)
 
 void CGameHandler::save(const std::string & filename)
 {
+	PROFILE_ZONE("CGameHandler::save");
 	logGlobal->info("Saving to %s", filename);
 	const auto stem	= FileInfo::GetPathStem(filename);
 	const auto savefname = stem.to_string() + ".vsgm1";
@@ -2973,6 +2664,7 @@ void CGameHandler::save(const std::string & filename)
 
 bool CGameHandler::load(const std::string & filename)
 {
+	PROFILE_ZONE("CGameHandler::load");
 	logGlobal->info("Loading from %s", filename);
 	const auto stem	= FileInfo::GetPathStem(filename);
 
@@ -4463,57 +4155,7 @@ static EndAction end_action;
 
 void CGameHandler::updateGateState()
 {
-	// GATE_BRIDGE - leftmost tile, located over moat
-	// GATE_OUTER - central tile, mostly covered by gate image
-	// GATE_INNER - rightmost tile, inside the walls
-
-	// GATE_OUTER or GATE_INNER:
-	// - if defender moves unit on these tiles, bridge will open
-	// - if there is a creature (dead or alive) on these tiles, bridge will always remain open
-	// - blocked to attacker if bridge is closed
-
-	// GATE_BRIDGE
-	// - if there is a unit or corpse here, bridge can't open (and can't close in fortress)
-	// - if Force Field is cast here, bridge can't open (but can close, in any town)
-	// - deals moat damage to attacker if bridge is closed (fortress only)
-
-	bool hasForceFieldOnBridge = !battleGetAllObstaclesOnPos(BattleHex(ESiegeHex::GATE_BRIDGE), true).empty();
-	bool hasStackAtGateInner   = gs->curB->battleGetUnitByPos(BattleHex(ESiegeHex::GATE_INNER), false) != nullptr;
-	bool hasStackAtGateOuter   = gs->curB->battleGetUnitByPos(BattleHex(ESiegeHex::GATE_OUTER), false) != nullptr;
-	bool hasStackAtGateBridge  = gs->curB->battleGetUnitByPos(BattleHex(ESiegeHex::GATE_BRIDGE), false) != nullptr;
-	bool hasWideMoat           = vstd::contains_if(battleGetAllObstaclesOnPos(BattleHex(ESiegeHex::GATE_BRIDGE), false), [](const std::shared_ptr<const CObstacleInstance> & obst)
-	{
-		return obst->obstacleType == CObstacleInstance::MOAT;
-	});
-
-	BattleUpdateGateState db;
-	db.state = gs->curB->si.gateState;
-	if (gs->curB->si.wallState[EWallPart::GATE] == EWallState::DESTROYED)
-	{
-		db.state = EGateState::DESTROYED;
-	}
-	else if (db.state == EGateState::OPENED)
-	{
-		bool hasStackOnLongBridge = hasStackAtGateBridge && hasWideMoat;
-		bool gateCanClose = !hasStackAtGateInner && !hasStackAtGateOuter && !hasStackOnLongBridge;
-
-		if (gateCanClose)
-			db.state = EGateState::CLOSED;
-		else
-			db.state = EGateState::OPENED;
-	}
-	else // CLOSED or BLOCKED
-	{
-		bool gateBlocked = hasForceFieldOnBridge || hasStackAtGateBridge;
-
-		if (gateBlocked)
-			db.state = EGateState::BLOCKED;
-		else
-			db.state = EGateState::CLOSED;
-	}
-
-	if (db.state != gs->curB->si.gateState)
-		sendAndApply(&db);
+	ServerBattleActionProcessor(this).updateGateState();
 }
 
 bool CGameHandler::makeBattleAction(BattleAction &ba)
@@ -4579,74 +4221,20 @@ bool CGameHandler::makeBattleAction(BattleAction &ba)
 	switch(ba.actionType)
 	{
 	case EActionType::END_TACTIC_PHASE: //wait
-	case EActionType::BAD_MORALE:
-	case EActionType::NO_ACTION:
 		{
 			auto wrapper = wrapAction(ba);
 			break;
 		}
+	case EActionType::BAD_MORALE:
+	case EActionType::NO_ACTION:
 	case EActionType::WALK:
-		{
-			auto wrapper = wrapAction(ba);
-			if(target.size() < 1)
-			{
-				complain("Destination required for move action.");
-				ok = false;
-				break;
-			}
-			int walkedTiles = moveStack(ba.stackNumber, target.at(0).hexValue); //move
-			if (!walkedTiles)
-				complain("Stack failed movement!");
-			break;
-		}
 	case EActionType::DEFEND:
-		{
-			//defensive stance, TODO: filter out spell boosts from bonus (stone skin etc.)
-			SetStackEffect sse;
-			Bonus defenseBonusToAdd(Bonus::STACK_GETS_TURN, Bonus::PRIMARY_SKILL, Bonus::OTHER, 20, -1, PrimarySkill::DEFENSE, Bonus::PERCENT_TO_ALL);
-			Bonus bonus2(Bonus::STACK_GETS_TURN, Bonus::PRIMARY_SKILL, Bonus::OTHER, stack->valOfBonuses(Bonus::DEFENSIVE_STANCE),
-				 -1, PrimarySkill::DEFENSE, Bonus::ADDITIVE_VALUE);
-			Bonus alternativeWeakCreatureBonus(Bonus::STACK_GETS_TURN, Bonus::PRIMARY_SKILL, Bonus::OTHER, 1, -1, PrimarySkill::DEFENSE, Bonus::ADDITIVE_VALUE);
-
-			BonusList defence = *stack->getBonuses(Selector::typeSubtype(Bonus::PRIMARY_SKILL, PrimarySkill::DEFENSE));
-			int oldDefenceValue = defence.totalValue();
-
-			defence.push_back(std::make_shared<Bonus>(defenseBonusToAdd));
-			defence.push_back(std::make_shared<Bonus>(bonus2));
-
-			int difference = defence.totalValue() - oldDefenceValue;
-			std::vector<Bonus> buffer;
-			if(difference == 0) //give replacement bonus for creatures not reaching 5 defense points (20% of def becomes 0)
-			{
-				difference = 1;
-				buffer.push_back(alternativeWeakCreatureBonus);
-			}
-			else
-			{
-				buffer.push_back(defenseBonusToAdd);
-			}
-
-			buffer.push_back(bonus2);
-
-			sse.toUpdate.push_back(std::make_pair(ba.stackNumber, buffer));
-			sendAndApply(&sse);
-
-			BattleLogMessage message;
-
-			MetaString text;
-			stack->addText(text, MetaString::GENERAL_TXT, 120);
-			stack->addNameReplacement(text);
-			text.addReplacement(difference);
-
-			message.lines.push_back(text);
-
-			sendAndApply(&message);
-			//don't break - we share code with next case
-		}
-		[[fallthrough]];
 	case EActionType::WAIT:
+	case EActionType::WALK_AND_ATTACK:
+	case EActionType::SHOOT:
+	case EActionType::MONSTER_SPELL:
 		{
-			auto wrapper = wrapAction(ba);
+			ok = ServerBattleActionProcessor(this).makeAction(ba);
 			break;
 		}
 	case EActionType::RETREAT: //retreat/flee
@@ -4672,180 +4260,6 @@ bool CGameHandler::makeBattleAction(BattleAction &ba)
 			}
 			break;
 		}
-	case EActionType::WALK_AND_ATTACK: //walk or attack
-		{
-			auto wrapper = wrapAction(ba);
-
-			if(!stack)
-			{
-				complain("No attacker");
-				ok = false;
-				break;
-			}
-
-			if(target.size() < 2)
-			{
-				complain("Two destinations required for attack action.");
-				ok = false;
-				break;
-			}
-
-			BattleHex attackPos = target.at(0).hexValue;
-			BattleHex destinationTile = target.at(1).hexValue;
-			const CStack * destinationStack = gs->curB->battleGetStackByPos(destinationTile, true);
-
-			if(!destinationStack)
-			{
-				complain("Invalid target to attack");
-				ok = false;
-				break;
-			}
-
-			BattleHex startingPos = stack->getPosition();
-			int distance = moveStack(ba.stackNumber, attackPos);
-
-			logGlobal->trace("%s will attack %s", stack->nodeName(), destinationStack->nodeName());
-
-			if(stack->getPosition() != attackPos
-				&& !(stack->doubleWide() && (stack->getPosition() == attackPos.cloneInDirection(stack->destShiftDir(), false)))
-				)
-			{
-				// we were not able to reach destination tile, nor occupy specified hex
-				// abort attack attempt, but treat this case as legal - we may have stepped onto a quicksands/mine
-				break;
-			}
-
-			if(destinationStack && stack->ID == destinationStack->ID) //we should just move, it will be handled by following check
-			{
-				destinationStack = nullptr;
-			}
-
-			if(!destinationStack)
-			{
-				complain("Unit can not attack itself");
-				ok = false;
-				break;
-			}
-
-			if(!CStack::isMeleeAttackPossible(stack, destinationStack))
-			{
-				complain("Attack cannot be performed!");
-				ok = false;
-				break;
-			}
-
-			//attack
-			int totalAttacks = stack->totalAttacks.getMeleeValue();
-
-			//TODO: move to CUnitState
-			const auto * attackingHero = gs->curB->battleGetFightingHero(ba.side);
-			if(attackingHero)
-			{
-				totalAttacks += attackingHero->valOfBonuses(Bonus::HERO_GRANTS_ATTACKS, stack->creatureIndex());
-			}
-
-
-			const bool firstStrike = destinationStack->hasBonusOfType(Bonus::FIRST_STRIKE);
-			const bool retaliation = destinationStack->ableToRetaliate();
-			for (int i = 0; i < totalAttacks; ++i)
-			{
-				//first strike
-				if(i == 0 && firstStrike && retaliation)
-				{
-					makeAttack(destinationStack, stack, 0, stack->getPosition(), true, false, true);
-				}
-
-				//move can cause death, eg. by walking into the moat, first strike can cause death or paralysis/petrification
-				if(stack->alive() && !stack->hasBonusOfType(Bonus::NOT_ACTIVE) && destinationStack->alive())
-				{
-					makeAttack(stack, destinationStack, (i ? 0 : distance), destinationTile, i==0, false, false);//no distance travelled on second attack
-				}
-
-				//counterattack
-				//we check retaliation twice, so if it unblocked during attack it will work only on next attack
-				if(stack->alive()
-					&& !stack->hasBonusOfType(Bonus::BLOCKS_RETALIATION)
-					&& (i == 0 && !firstStrike)
-					&& retaliation && destinationStack->ableToRetaliate())
-				{
-					makeAttack(destinationStack, stack, 0, stack->getPosition(), true, false, true);
-				}
-			}
-
-			//return
-			if(stack->hasBonusOfType(Bonus::RETURN_AFTER_STRIKE)
-				&& target.size() == 3
-				&& startingPos != stack->getPosition()
-				&& startingPos == target.at(2).hexValue
-				&& stack->alive())
-			{
-				moveStack(ba.stackNumber, startingPos);
-				//NOTE: curStack->ID == ba.stackNumber (rev 1431)
-			}
-			break;
-		}
-	case EActionType::SHOOT:
-		{
-			if(target.size() < 1)
-			{
-				complain("Destination required for shot action.");
-				ok = false;
-				break;
-			}
-
-			auto destination = target.at(0).hexValue;
-
-			const CStack * destinationStack = gs->curB->battleGetStackByPos(destination);
-
-			if (!gs->curB->battleCanShoot(stack, destination))
-			{
-				complain("Cannot shoot!");
-				break;
-			}
-			if (!destinationStack)
-			{
-				complain("No target to shoot!");
-				break;
-			}
-
-			auto wrapper = wrapAction(ba);
-
-			makeAttack(stack, destinationStack, 0, destination, true, true, false);
-
-			//ranged counterattack
-			if (destinationStack->hasBonusOfType(Bonus::RANGED_RETALIATION)
-				&& !stack->hasBonusOfType(Bonus::BLOCKS_RANGED_RETALIATION)
-				&& destinationStack->ableToRetaliate()
-				&& gs->curB->battleCanShoot(destinationStack, stack->getPosition())
-				&& stack->alive()) //attacker may have died (fire shield)
-			{
-				makeAttack(destinationStack, stack, 0, stack->getPosition(), true, true, true);
-			}
-			//allow more than one additional attack
-
-			int totalRangedAttacks = stack->totalAttacks.getRangedValue();
-
-			//TODO: move to CUnitState
-			const auto * attackingHero = gs->curB->battleGetFightingHero(ba.side);
-			if(attackingHero)
-			{
-				totalRangedAttacks += attackingHero->valOfBonuses(Bonus::HERO_GRANTS_ATTACKS, stack->creatureIndex());
-			}
-
-
-			for(int i = 1; i < totalRangedAttacks; ++i)
-			{
-				if(
-					stack->alive()
-					&& destinationStack->alive()
-					&& stack->shots.canUse()
-					)
-				{
-					makeAttack(stack, destinationStack, 0, destination, false, true, false);
-				}
-			}
-			break;
-		}
 	case EActionType::CATAPULT:
 		{
 			auto wrapper = wrapAction(ba);
@@ -4900,40 +4314,7 @@ bool CGameHandler::makeBattleAction(BattleAction &ba)
 			}
 			break;
 		}
-		case EActionType::MONSTER_SPELL:
-		{
-			auto wrapper = wrapAction(ba);
-
-			const CStack * stack = gs->curB->battleGetStackByID(ba.stackNumber);
-			SpellID spellID = SpellID(ba.actionSubtype);
-
-			std::shared_ptr<const Bonus> randSpellcaster = stack->getBonus(Selector::type()(Bonus::RANDOM_SPELLCASTER));
-			std::shared_ptr<const Bonus> spellcaster = stack->getBonus(Selector::typeSubtype(Bonus::SPELLCASTER, spellID));
-
-			//TODO special bonus for genies ability
-			if (randSpellcaster && battleGetRandomStackSpell(getRandomGenerator(), stack, CBattleInfoCallback::RANDOM_AIMED) < 0)
-				spellID = battleGetRandomStackSpell(getRandomGenerator(), stack, CBattleInfoCallback::RANDOM_GENIE);
-
-			if (spellID < 0)
-				complain("That stack can't cast spells!");
-			else
-			{
-				const CSpell * spell = SpellID(spellID).toSpell();
-				spells::BattleCast parameters(gs->curB, stack, spells::Mode::CREATURE_ACTIVE, spell);
-				int32_t spellLvl = 0;
-				if(spellcaster)
-					vstd::amax(spellLvl, spellcaster->val);
-				if(randSpellcaster)
-					vstd::amax(spellLvl, randSpellcaster->val);
-				parameters.setSpellLevel(spellLvl);
-				parameters.cast(spellEnv, target);
-			}
-			break;
-		}
 	}
-	if(ba.actionType == EActionType::WAIT || ba.actionType == EActionType::DEFEND
-			|| ba.actionType == EActionType::SHOOT || ba.actionType == EActionType::MONSTER_SPELL)
-		handleObstacleTriggersForUnit(*spellEnv, *stack);
 	if(ba.stackNumber == gs->curB->activeStack || battleResult.get()) //active stack has moved or battle has finished
 		battleMadeAction.setn(true);
 	return ok;
@@ -4973,6 +4354,64 @@ void CGameHandler::playerMessage(PlayerColor player, const std::string &message,
 			sendAndApply(&temp_message);
 			return;
 		}
+		if(words[1] == "packstats")
+		{
+			auto & statistics = PackStatistics::get();
+			std::string reply;
+
+			if(words.size() == 3 && words[2] == "reset")
+			{
+				statistics.reset();
+				reply = "pack statistics reset";
+			}
+			else if(words.size() == 4 && words[2] == "timing" && words[3] != "on" && words[3] != "off")
+			{
+				reply = "usage: game packstats [reset/timing <on/off>]";
+			}
+			else
+			{
+				if(words.size() == 4 && words[2] == "timing")
+					statistics.setTimingEnabled(words[3] == "on");
+
+				//full table goes to server log, chat only gets the most expensive packs
+				logGlobal->info("Pack statistics:\n%s", statistics.toString());
+				reply = statistics.toString(5);
+			}
+
+			for(auto & c : connections[player])
+				sendMessageTo(c, reply);
+			return;
+		}
+		if(words.size() == 3 && words[1] == "profiler")
+		{
+			std::string reply = "usage: game profiler <start/stop/save>";
+
+			if(words[2] == "start")
+			{
+				Profiler::get().start();
+				reply = "profiler started";
+			}
+			else if(words[2] == "stop")
+			{
+				Profiler::get().stop();
+				reply = "profiler stopped";
+			}
+			else if(words[2] == "save")
+			{
+				try
+				{
+					reply = "profiler trace saved to " + Profiler::get().saveTrace("server").string();
+				}
+				catch(const std::exception & e)
+				{
+					reply = e.what();
+				}
+			}
+
+			for(auto & c : connections[player])
+				sendMessageTo(c, reply);
+			return;
+		}
 		if(words.size() == 3 && words[1] == "kick")
 		{
 			auto playername = words[2];
@@ -6465,20 +5904,8 @@ void CGameHandler::runBattle()
 					const auto stack = dynamic_cast<const CStack *>(next);
 
 					// regeneration takes place before everything else but only during first turn attempt in each round
-					// also works under blind and similar effects
-					if(stack && stack->alive() && !stack->waiting)
-					{
-						BattleTriggerEffect bte;
-						bte.stackID = stack->ID;
-						bte.effect = Bonus::HP_REGENERATION;
-
-						const int32_t lostHealth = stack->MaxHealth() - stack->getFirstHPleft();
-						if(stack->hasBonusOfType(Bonus::HP_REGENERATION))
-							bte.val = std::min(lostHealth, stack->valOfBonuses(Bonus::HP_REGENERATION));
-
-						if(bte.val) // anything to heal
-							sendAndApply(&bte);
-					}
+					if(stack)
+						ServerBattleActionProcessor(this).regenerate(stack);
 
 					if(next->willMove())
 						return stack;
@@ -6502,23 +5929,16 @@ void CGameHandler::runBattle()
 				sendAndApply(&removeGhosts);
 
 			//check for bad morale => freeze
-			int nextStackMorale = next->MoraleVal();
-			if (nextStackMorale < 0)
+			if(ServerBattleActionProcessor(this).rollBadMorale(next))
 			{
-				auto diceSize = VLC->settings()->getVector(EGameSettings::COMBAT_BAD_MORALE_DICE);
-				size_t diceIndex = std::min<size_t>(diceSize.size()-1, -nextStackMorale);
+				//unit loses its turn - empty freeze action
+				BattleAction ba;
+				ba.actionType = EActionType::BAD_MORALE;
+				ba.side = next->side;
+				ba.stackNumber = next->ID;
 
-				if(diceSize.size() > 0 && getRandomGenerator().nextInt(1, diceSize[diceIndex]) == 1)
-				{
-					//unit loses its turn - empty freeze action
-					BattleAction ba;
-					ba.actionType = EActionType::BAD_MORALE;
-					ba.side = next->side;
-					ba.stackNumber = next->ID;
-
-					makeAutomaticAction(next, ba);
-					continue;
-				}
+				makeAutomaticAction(next, ba);
+				continue;
 			}
 
 			if (next->hasBonusOfType(Bonus::ATTACKS_NEAREST_CREATURE)) //while in berserk
@@ -6688,28 +6108,16 @@ void CGameHandler::runBattle()
 				if(next != nullptr)
 				{
 					//check for good morale
-					nextStackMorale = next->MoraleVal();
-					if(!next->hadMorale  //only one extra move per turn possible
-						&& !next->defending
-						&& !next->waited()
-						&& !next->fear
-						&&  next->alive()
-						&&  nextStackMorale > 0)
+					if(ServerBattleActionProcessor(this).rollGoodMorale(next))
 					{
-						auto diceSize = VLC->settings()->getVector(EGameSettings::COMBAT_GOOD_MORALE_DICE);
-						size_t diceIndex = std::min<size_t>(diceSize.size()-1, nextStackMorale);
+						BattleTriggerEffect bte;
+						bte.stackID = next->ID;
+						bte.effect = Bonus::MORALE;
+						bte.val = 1;
+						bte.additionalInfo = 0;
+						sendAndApply(&bte); //play animation
 
-						if(diceSize.size() > 0 && getRandomGenerator().nextInt(1, diceSize[diceIndex]) == 1)
-						{
-							BattleTriggerEffect bte;
-							bte.stackID = next->ID;
-							bte.effect = Bonus::MORALE;
-							bte.val = 1;
-							bte.additionalInfo = 0;
-							sendAndApply(&bte); //play animation
-
-							++numberOfAsks; //move this stack once more
-						}
+						++numberOfAsks; //move this stack once more
 					}
 				}
 				--numberOfAsks;
@@ -16,6 +16,7 @@
 #include "../lib/battle/CBattleInfoCallback.h"
 #include "../lib/battle/BattleAction.h"
 #include "../lib/ScriptHandler.h"
+#include "../lib/serializer/PackJournal.h"
 #include "CQuery.h"
 
 VCMI_LIB_NAMESPACE_BEGIN
@@ -31,6 +32,7 @@ struct SetResources;
 struct NewStructures;
 class CGHeroInstance;
 class IMarket;
+class PackRecorder;
 
 class SpellCastEnvironment;
 
@@ -97,8 +99,23 @@ class CGameHandler : public IGameCallback, public CBattleInfoCallback, public En
 	CVCMIServer * lobby;
 	std::shared_ptr<CApplier<CBaseForGHApply>> applier;
 	std::unique_ptr<boost::thread> battleThread;
+
+	/// packs sent to clients, used to resynchronize clients that reconnect with their game state
+	PackJournal packJournal;
+	/// guards journal, sending of packs to clients and applying them on game state, so that all of them happen in same order
+	boost::recursive_mutex packJournalMutex;
+	/// connections that received game state and receive packs, includes connections that were lost
+	std::set<std::shared_ptr<CConnection>> journaledConnections;
+	/// optional recording of applied packs for offline replay, see settings/server/packJournal
+	std::unique_ptr<PackRecorder> packRecorder;
+
+	void startPackRecording();
+	void recordAppliedPack(CPackForClient * pack, const PackJournal::Frame & frame);
+
 public:
-	using FireShieldInfo = std::vector<std::pair<const CStack *, int64_t>>;
+	/// memory used for packs that can be resent to reconnecting clients
+	static constexpr size_t PACK_JOURNAL_SIZE = 64 * 1024 * 1024;
+
 	//use enums as parameters, because doMove(sth, true, false, true) is not readable
 	enum EGuardLook {CHECK_FOR_GUARDS, IGNORE_GUARDS};
 	enum EVisitDest {VISIT_DEST, DONT_VISIT_DEST};
@@ -124,7 +141,6 @@ public:
 	bool isBlockedByQueries(const CPack *pack, PlayerColor player);
 	bool isAllowedExchange(ObjectInstanceID id1, ObjectInstanceID id2);
 	void giveSpells(const CGTownInstance *t, const CGHeroInstance *h);
-	int moveStack(int stack, BattleHex dest); //returned value - travelled distance
 	void runBattle();
 
 	////used only in endBattle - don't touch elsewhere
@@ -133,13 +149,7 @@ public:
 	void endBattle(int3 tile, const CGHeroInstance * hero1, const CGHeroInstance * hero2); //ends battle
 	void endBattleConfirm(const BattleInfo * battleInfo);
 
-	void makeAttack(const CStack * attacker, const CStack * defender, int distance, BattleHex targetHex, bool first, bool ranged, bool counter);
-
-	// damage, drain life & fire shield; returns amount of drained life
-	int64_t applyBattleEffects(BattleAttack & bat, std::shared_ptr<battle::CUnitState> attackerState, FireShieldInfo & fireShield, const CStack * def, int distance, bool secondary);
-
 	void sendGenericKilledLog(const CStack * defender, int32_t killed, bool multiple);
-	void addGenericKilledLog(BattleLogMessage & blm, const CStack * defender, int32_t killed, bool multiple);
 
 	void checkBattleStateChanges();
 	void setupBattle(int3 tile, const CArmedInstance *armies[2], const CGHeroInstance *heroes[2], bool creatureBank, const CGTownInstance *town);
@@ -297,7 +307,15 @@ public:
 
 	void sendMessageToAll(const std::string &message);
 	void sendMessageTo(std::shared_ptr<CConnection> c, const std::string &message);
-	void sendToAllClients(CPackForClient * pack);
+	/// returns pack serialized for clients, empty if connections could not share it
+	PackJournal::Frame sendToAllClients(CPackForClient * pack);
+	void sendToClient(std::shared_ptr<CConnection> c, CPackForClient * pack);
+	/// connection will receive packs sent to all clients, called once client has game state
+	void addJournaledConnection(std::shared_ptr<CConnection> c);
+	/// sends game state to client that has (re)connected during game
+	/// if client has state and has received given number of packs, only packs it missed are sent
+	/// returns false if whole game state had to be sent
+	bool synchronizeClient(std::shared_ptr<CConnection> c, std::optional<ui64> receivedPacks);
 	void sendAndApply(CPackForClient * pack) override;
 	void applyAndSend(CPackForClient * pack);
 	void sendAndApply(CGarrisonOperationPack * pack);
@@ -46,6 +46,7 @@
 #include "../lib/ScopeGuard.h"
 #include "../lib/serializer/CMemorySerializer.h"
 #include "../lib/serializer/Cast.h"
+#include "../lib/serializer/PackRecording.h"
 
 #include "../lib/UnlockGuard.h"
 
@@ -154,10 +155,18 @@ CVCMIServer::CVCMIServer(boost::program_options::variables_map & opts)
 
 CVCMIServer::~CVCMIServer()
 {
+	state = EServerState::SHUTDOWN;
 	announceQueue.clear();
 
 	if(announceLobbyThread)
 		announceLobbyThread->join();
+
+	if(packHandlingThread)
+		packHandlingThread->join();
+
+	io->stop();
+	if(ioThread)
+		ioThread->join();
 }
 
 void CVCMIServer::run()
@@ -165,6 +174,11 @@ void CVCMIServer::run()
 	if(!restartGameplay)
 	{
 		this->announceLobbyThread = std::make_unique<boost::thread>(&CVCMIServer::threadAnnounceLobby, this);
+		if(!ioThread)
+		{
+			this->packHandlingThread = std::make_unique<boost::thread>(&CVCMIServer::threadHandlePacks, this);
+			this->ioThread = std::make_unique<boost::thread>(&CVCMIServer::threadHandleIO, this);
+		}
 #if !defined(VCMI_MOBILE)
 		if(cmdLineOptions.count("enable-shm"))
 		{
@@ -231,7 +245,7 @@ void CVCMIServer::connectToRemote(const std::string & addr, int port)
 	try
 	{
 		logNetwork->info("Establishing connection...");
-		c = std::make_shared<CConnection>(addr, port, SERVER_NAME, uuid);
+		c = std::make_shared<CConnection>(addr, port, SERVER_NAME, uuid, io);
 	}
 	catch(...)
 	{
@@ -241,7 +255,7 @@ void CVCMIServer::connectToRemote(const std::string & addr, int port)
 	if(c)
 	{
 		connections.insert(c);
-		c->handler = std::make_shared<boost::thread>(&CVCMIServer::threadHandleClient, this, c);
+		startHandlingClient(c);
 	}
 }
 
@@ -256,12 +270,6 @@ void CVCMIServer::threadAnnounceLobby()
 				announcePack(std::move(announceQueue.front()));
 				announceQueue.pop_front();
 			}
-
-			if(acceptor)
-			{
-				io->reset();
-				io->poll();
-			}
 		}
 
 		boost::this_thread::sleep(boost::posix_time::milliseconds(50));
@@ -324,7 +332,10 @@ bool CVCMIServer::prepareToStartGame()
 void CVCMIServer::startGameImmidiately()
 {
 	for(auto c : connections)
+	{
 		c->enterGameplayConnectionMode(gh->gs);
+		gh->addJournaledConnection(c);
+	}
 
 	state = EServerState::GAMEPLAY;
 }
@@ -351,23 +362,32 @@ void CVCMIServer::connectionAccepted(const boost::system::error_code & ec)
 		return;
 	}
 
-	try
+	auto onHandshake = [this](std::shared_ptr<CConnection> c, const std::string & error)
 	{
-		if(state == EServerState::LOBBY || !hangingConnections.empty())
+		if(!error.empty())
 		{
-			logNetwork->info("We got a new connection! :)");
-			auto c = std::make_shared<CConnection>(upcomingConnection, SERVER_NAME, uuid);
-			upcomingConnection.reset();
-			connections.insert(c);
-			c->handler = std::make_shared<boost::thread>(&CVCMIServer::threadHandleClient, this, c);
+			logNetwork->error("Failure processing new connection! %s", error);
+			return;
 		}
+
+		//whether connection is allowed depends on state that is only modified by thread handling packs
+		ReceivedFrame frame;
+		frame.type = ReceivedFrame::EType::CONNECTION_ACCEPTED;
+		frame.connection = c;
+		addReceivedFrame(std::move(frame));
+	};
+
+	try
+	{
+		//handshake must not block this thread, it serves all other connections
+		CConnection::acceptAsync(upcomingConnection, SERVER_NAME, uuid, onHandshake);
 	}
 	catch(std::exception & e)
 	{
 		logNetwork->error("Failure processing new connection! %s", e.what());
-		upcomingConnection.reset();
 	}
 
+	upcomingConnection.reset();
 	startAsyncAccept();
 }
 
@@ -400,48 +420,132 @@ public:
 	}
 };
 
-void CVCMIServer::threadHandleClient(std::shared_ptr<CConnection> c)
+void CVCMIServer::startHandlingClient(std::shared_ptr<CConnection> c)
 {
-	setThreadName("CVCMIServer::handleConnection");
 	c->enterLobbyConnectionMode();
 
+	auto onFrame = [this](std::shared_ptr<CConnection> c, std::vector<ui8> && data)
+	{
+		ReceivedFrame frame;
+		frame.connection = c;
+		frame.data = std::move(data);
+		addReceivedFrame(std::move(frame));
+	};
+
+	auto onError = [this](std::shared_ptr<CConnection> c, const std::string & error)
+	{
+		ReceivedFrame frame;
+		frame.type = ReceivedFrame::EType::CONNECTION_LOST;
+		frame.connection = c;
+		frame.error = error;
+		addReceivedFrame(std::move(frame));
+	};
+
+	c->startAsyncMode(onFrame, onError);
+}
+
+void CVCMIServer::addReceivedFrame(ReceivedFrame && frame)
+{
+	boost::unique_lock<boost::mutex> lock(receivedFramesMutex);
+	receivedFrames.push_back(std::move(frame));
+	receivedFramesCond.notify_one();
+}
+
+void CVCMIServer::threadHandleIO()
+{
+	setThreadName("CVCMIServer::handleIO");
+
+	//keeps io_service running while there are no connections
+	boost::asio::io_service::work work(*io);
+
+	while(state != EServerState::SHUTDOWN)
+	{
+		try
+		{
+			io->run();
+			break;
+		}
+		catch(const std::exception & e)
+		{
+			logNetwork->error("Error in network thread: %s", e.what());
+		}
+	}
+
+	logNetwork->info("Network thread ended");
+}
+
+void CVCMIServer::threadHandlePacks()
+{
+	setThreadName("CVCMIServer::handlePacks");
+
+	while(true)
+	{
+		ReceivedFrame frame;
+
+		{
+			boost::unique_lock<boost::mutex> lock(receivedFramesMutex);
+
+			while(receivedFrames.empty() && state != EServerState::SHUTDOWN)
+				receivedFramesCond.timed_wait(lock, boost::posix_time::milliseconds(50));
+
+			if(receivedFrames.empty())
+				break;
+
+			frame = std::move(receivedFrames.front());
+			receivedFrames.pop_front();
+		}
+
+		handleReceivedFrame(frame);
+	}
+
+	logNetwork->info("Thread handling packs ended");
+}
+
+void CVCMIServer::handleReceivedFrame(ReceivedFrame & frame)
+{
+	auto c = frame.connection;
+
+	if(frame.type == ReceivedFrame::EType::CONNECTION_ACCEPTED)
+	{
+		handleAcceptedConnection(c);
+		return;
+	}
+
+	// connection was closed by server, remaining packs from it are ignored
+	if(!c->connected)
+		return;
+
+	if(frame.type == ReceivedFrame::EType::CONNECTION_LOST)
+	{
+		handleConnectionLost(c, frame.error);
+		return;
+	}
+
 #ifndef _MSC_VER
 	try
 	{
 #endif
-		while(c->connected)
-		{
-			CPack * pack;
-			
-			try
-			{
-				pack = c->retrievePack();
-			}
-			catch(boost::system::system_error & e)
-			{
-				logNetwork->error("Network error receiving a pack. Connection %s dies. What happened: %s", c->toString(), e.what());
-				hangingConnections.insert(c);
-				connections.erase(c);
-				if(connections.empty() || hostClient == c)
-					state = EServerState::SHUTDOWN;
-				
-				if(gh && state == EServerState::GAMEPLAY)
-				{
-					gh->handleClientDisconnection(c);
-				}
-				break;
-			}
+		CPack * pack = c->retrievePack(frame.data);
 
+		if(pack)
+		{
 			CVCMIServerPackVisitor visitor(*this, *this->gh);
 			pack->visit(visitor);
 		}
 #ifndef _MSC_VER
-	 }
+	}
 	catch(const std::exception & e)
 	{
-        (void)e;
 		boost::unique_lock<boost::recursive_mutex> queueLock(mx);
 		logNetwork->error("%s dies... \nWhat happened: %s", c->toString(), e.what());
+
+		if(c->connected)
+		{
+			auto lcd = std::make_unique<LobbyClientDisconnected>();
+			lcd->c = c;
+			lcd->clientId = c->connectionID;
+			handleReceivedPack(std::move(lcd));
+		}
 	}
 	catch(...)
 	{
@@ -450,19 +554,40 @@ void CVCMIServer::threadHandleClient(std::shared_ptr<CConnection> c)
 		throw;
 	}
 #endif
+}
 
-	boost::unique_lock<boost::recursive_mutex> queueLock(mx);
-//	if(state != ENDING_AND_STARTING_GAME)
-	if(c->connected)
+void CVCMIServer::handleAcceptedConnection(std::shared_ptr<CConnection> c)
+{
+	boost::unique_lock<boost::recursive_mutex> myLock(mx);
+
+	if(state == EServerState::LOBBY || !hangingConnections.empty())
 	{
-		auto lcd = std::make_unique<LobbyClientDisconnected>();
-		lcd->c = c;
-		lcd->clientId = c->connectionID;
-		handleReceivedPack(std::move(lcd));
+		logNetwork->info("We got a new connection! :)");
+		connections.insert(c);
+		startHandlingClient(c);
 	}
+	else
+	{
+		logNetwork->info("Connection %s rejected, game is already running", c->toString());
+		c->close();
+		c->connected = false;
+	}
+}
 
-	logNetwork->info("Thread listening for %s ended", c->toString());
-	c->handler.reset();
+void CVCMIServer::handleConnectionLost(std::shared_ptr<CConnection> c, const std::string & error)
+{
+	logNetwork->error("Network error receiving a pack. Connection %s dies. What happened: %s", c->toString(), error);
+	c->connected = false;
+
+	hangingConnections.insert(c);
+	connections.erase(c);
+	if(connections.empty() || hostClient == c)
+		state = EServerState::SHUTDOWN;
+
+	if(gh && state == EServerState::GAMEPLAY)
+	{
+		gh->handleClientDisconnection(c);
+	}
 }
 
 void CVCMIServer::handleReceivedPack(std::unique_ptr<CPackForLobby> pack)
@@ -1010,7 +1135,10 @@ static void handleCommandOptions(int argc, const char * argv[], boost::program_o
 	("lobby", po::value<std::string>(), "address to remote lobby")
 	("lobby-port", po::value<ui16>(), "port at which server connect to remote lobby")
 	("lobby-uuid", po::value<std::string>(), "")
-	("connections", po::value<ui16>(), "amount of connections to remote lobby");
+	("connections", po::value<ui16>(), "amount of connections to remote lobby")
+	("replay-journal", po::value<std::string>(), "apply packs from journal recorded by server on game state without clients and exit")
+	("replay-seek", po::value<ui64>(), "start replay of journal at given pack, nearest earlier checkpoint is loaded and fast-forwarded")
+	("replay-until", po::value<ui64>(), "stop replay of journal before given pack");
 
 	if(argc > 1)
 	{
@@ -1052,6 +1180,40 @@ static void handleCommandOptions(int argc, const char * argv[], boost::program_o
 #endif
 }
 
+static bool replayPackJournal(const boost::program_options::variables_map & options)
+{
+	try
+	{
+		PackReplayer replayer(options["replay-journal"].as<std::string>());
+
+		const ui64 seek = options.count("replay-seek") ? options["replay-seek"].as<ui64>() : 0;
+		const ui64 until = options.count("replay-until") ? options["replay-until"].as<ui64>() : std::numeric_limits<ui64>::max();
+
+		replayer.seek(seek);
+		auto seekStatistics = replayer.statistics();
+		logGlobal->info("Seek to pack %d: %d ms, %d packs fast-forwarded", replayer.currentPack(), seekStatistics.loadingTime / 1000, seekStatistics.packs);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		replayer.replay(until);
+		auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+		const auto & stats = replayer.statistics();
+		const ui64 packs = stats.packs - seekStatistics.packs;
+		logGlobal->info("Replayed %d packs (%d KB) in %d ms, %d packs per second", packs, (stats.bytes - seekStatistics.bytes) / 1024, time / 1000, time ? packs * 1000000 / time : 0);
+		logGlobal->info("Decompression: %d ms, deserialization: %d ms, applying: %d ms",
+			(stats.decompressionTime - seekStatistics.decompressionTime) / 1000,
+			(stats.deserializationTime - seekStatistics.deserializationTime) / 1000,
+			(stats.applyingTime - seekStatistics.applyingTime) / 1000);
+		logGlobal->info("Stopped before pack %d of %d", replayer.currentPack(), replayer.packsCount());
+		return true;
+	}
+	catch(const std::exception & e)
+	{
+		logGlobal->error("Failed to replay pack journal: %s", e.what());
+		return false;
+	}
+}
+
 #ifdef SINGLE_PROCESS_APP
 #define main server_main
 #endif
@@ -1086,6 +1248,9 @@ int main(int argc, const char * argv[])
 	loadDLLClasses();
 	srand((ui32)time(nullptr));
 
+	if(opts.count("replay-journal"))
+		exit(replayPackJournal(opts) ? EXIT_SUCCESS : EXIT_FAILURE);
+
 #ifdef SINGLE_PROCESS_APP
 	boost::condition_variable * cond = reinterpret_cast<boost::condition_variable *>(const_cast<char *>(argv[0]));
 	cond->notify_one();
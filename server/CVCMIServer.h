@@ -47,6 +47,22 @@ enum class EServerState : ui8
 	SHUTDOWN
 };
 
+/// Event of network thread that is handled by CVCMIServer::threadHandlePacks
+struct ReceivedFrame
+{
+	enum class EType : ui8
+	{
+		PACK,
+		CONNECTION_ACCEPTED,
+		CONNECTION_LOST
+	};
+
+	EType type = EType::PACK;
+	std::shared_ptr<CConnection> connection;
+	std::vector<ui8> data;
+	std::string error;
+};
+
 class CVCMIServer : public LobbyInfo
 {
 	std::atomic<bool> restartGameplay; // FIXME: this is just a hack
@@ -58,6 +74,12 @@ class CVCMIServer : public LobbyInfo
 	std::shared_ptr<CApplier<CBaseForServerApply>> applier;
 	std::unique_ptr<boost::thread> announceLobbyThread, remoteConnectionsThread;
 
+	/// all sockets are served by single thread, packs are handled by another thread in order of arrival
+	std::unique_ptr<boost::thread> ioThread, packHandlingThread;
+	std::deque<ReceivedFrame> receivedFrames;
+	boost::mutex receivedFramesMutex;
+	boost::condition_variable receivedFramesCond;
+
 public:
 	std::shared_ptr<CGameHandler> gh;
 	std::atomic<EServerState> state;
@@ -82,7 +104,13 @@ public:
 	void connectToRemote(const std::string & addr, int port);
 	void startAsyncAccept();
 	void connectionAccepted(const boost::system::error_code & ec);
-	void threadHandleClient(std::shared_ptr<CConnection> c);
+	void startHandlingClient(std::shared_ptr<CConnection> c);
+	void threadHandleIO();
+	void threadHandlePacks();
+	void addReceivedFrame(ReceivedFrame && frame);
+	void handleReceivedFrame(ReceivedFrame & frame);
+	void handleAcceptedConnection(std::shared_ptr<CConnection> c);
+	void handleConnectionLost(std::shared_ptr<CConnection> c, const std::string & error);
 	void threadAnnounceLobby();
 	void handleReceivedPack(std::unique_ptr<CPackForLobby> pack);
 
@@ -119,12 +119,9 @@ void ApplyOnServerAfterAnnounceNetPackVisitor::visitLobbyClientConnected(LobbyCl
 	srv.updateAndPropagateLobbyState();
 	if(srv.state == EServerState::GAMEPLAY)
 	{
-		//immediately start game
-		std::unique_ptr<LobbyStartGame> startGameForReconnectedPlayer(new LobbyStartGame);
-		startGameForReconnectedPlayer->initializedStartInfo = srv.si;
-		startGameForReconnectedPlayer->initializedGameState = srv.gh->gameState();
-		startGameForReconnectedPlayer->clientId = pack.c->connectionID;
-		srv.addToAnnounceQueue(std::move(startGameForReconnectedPlayer));
+		//immediately start game, client that still has game state only receives packs it has missed
+		if(!srv.gh->synchronizeClient(pack.c, pack.receivedPacks))
+			srv.reconnectPlayer(pack.c->connectionID);
 	}
 }
 
@@ -304,19 +301,9 @@ void ApplyOnServerNetPackVisitor::visitLobbyStartGame(LobbyStartGame & pack)
 
 void ApplyOnServerAfterAnnounceNetPackVisitor::visitLobbyStartGame(LobbyStartGame & pack)
 {
-	if(pack.clientId == -1) //do not restart game for single client only
+	//game state for reconnected players is sent by CGameHandler::synchronizeClient
+	if(pack.clientId == -1)
 		srv.startGameImmidiately();
-	else
-	{
-		for(auto & c : srv.connections)
-		{
-			if(c->connectionID == pack.clientId)
-			{
-				c->enterGameplayConnectionMode(srv.gh->gameState());
-				srv.reconnectPlayer(pack.clientId);
-			}
-		}
-	}
 }
 
 void ClientPermissionsCheckerNetPackVisitor::visitLobbyChangeHost(LobbyChangeHost & pack)
@@ -0,0 +1,62 @@
+/*
+ * ProfilerTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../lib/Profiler.h"
+
+TEST(ProfilerTest, recordsZonesOnlyWhileRunning)
+{
+	auto & profiler = Profiler::get();
+	profiler.stop();
+
+	{
+		PROFILE_ZONE("ignored zone");
+	}
+
+	profiler.start();
+	EXPECT_EQ(profiler.zonesCount(), 0);
+
+	{
+		PROFILE_ZONE("outer zone");
+		{
+			PROFILE_ZONE_DETAIL("inner zone", "with \"detail\"");
+		}
+	}
+
+	boost::thread worker([]()
+	{
+		Profiler::get().setThreadName("profiled worker");
+		PROFILE_ZONE("worker zone");
+	});
+	worker.join();
+
+	profiler.stop();
+
+	{
+		PROFILE_ZONE("ignored zone");
+	}
+
+	EXPECT_EQ(profiler.zonesCount(), 3);
+
+	std::ostringstream out;
+	profiler.writeTrace(out);
+	const std::string trace = out.str();
+
+	EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+	EXPECT_NE(trace.find("\"outer zone\""), std::string::npos);
+	EXPECT_NE(trace.find("\"detail\":\"with \\\"detail\\\"\""), std::string::npos);
+	EXPECT_NE(trace.find("\"profiled worker\""), std::string::npos);
+	EXPECT_EQ(trace.find("ignored zone"), std::string::npos);
+
+	//restarting discards zones of previous recording
+	profiler.start();
+	profiler.stop();
+	EXPECT_EQ(profiler.zonesCount(), 0);
+}
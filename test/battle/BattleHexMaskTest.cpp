@@ -0,0 +1,231 @@
+/*
+ * BattleHexMaskTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/battle/BattleHexMask.h"
+#include "../../lib/battle/CBattleInfoCallback.h"
+#include "../../lib/battle/Unit.h"
+
+namespace
+{
+
+/// Plain queue-based BFS that was used before bitboards, kept as reference
+ReachabilityInfo referenceBFS(const AccessibilityInfo & accessibility, const ReachabilityInfo::Parameters & params, const std::set<BattleHex> & obstacles)
+{
+	ReachabilityInfo ret;
+	ret.accessibility = accessibility;
+	ret.params = params;
+
+	ret.predecessors.fill(BattleHex::INVALID);
+	ret.distances.fill(ReachabilityInfo::INFINITE_DIST);
+
+	auto isInObstacle = [&](BattleHex hex) -> bool
+	{
+		for(auto occupiedHex : battle::Unit::getHexes(hex, params.doubleWide, params.side))
+		{
+			if(vstd::contains(params.knownAccessible, occupiedHex))
+				continue;
+
+			if(vstd::contains(obstacles, occupiedHex))
+				return true;
+		}
+		return false;
+	};
+
+	std::queue<BattleHex> hexq;
+
+	hexq.push(params.startPosition);
+	ret.distances[params.startPosition] = 0;
+
+	while(!hexq.empty())
+	{
+		const BattleHex curHex = hexq.front();
+		hexq.pop();
+
+		if(isInObstacle(curHex))
+			continue;
+
+		const int costToNeighbour = ret.distances[curHex.hex] + 1;
+		for(BattleHex neighbour : curHex.neighbouringTiles())
+		{
+			const int costFoundSoFar = ret.distances[neighbour.hex];
+
+			if(accessibility.accessible(neighbour, params.doubleWide, params.side) && costToNeighbour < costFoundSoFar)
+			{
+				hexq.push(neighbour);
+				ret.distances[neighbour.hex] = costToNeighbour;
+				ret.predecessors[neighbour.hex] = curHex;
+			}
+		}
+	}
+
+	return ret;
+}
+
+AccessibilityInfo randomAccessibility(std::mt19937 & rng)
+{
+	static const std::vector<EAccessibility> blocked =
+	{
+		EAccessibility::ALIVE_STACK,
+		EAccessibility::OBSTACLE,
+		EAccessibility::DESTRUCTIBLE_WALL,
+		EAccessibility::GATE,
+		EAccessibility::UNAVAILABLE
+	};
+
+	AccessibilityInfo ret;
+	ret.fill(EAccessibility::ACCESSIBLE);
+
+	for(int y = 0; y < GameConstants::BFIELD_HEIGHT; y++)
+	{
+		ret[BattleHex(0, y)] = EAccessibility::SIDE_COLUMN;
+		ret[BattleHex(GameConstants::BFIELD_WIDTH - 1, y)] = EAccessibility::SIDE_COLUMN;
+	}
+
+	std::uniform_int_distribution<int> hexDistribution(0, GameConstants::BFIELD_SIZE - 1);
+	std::uniform_int_distribution<size_t> typeDistribution(0, blocked.size() - 1);
+	std::uniform_int_distribution<int> countDistribution(0, 60);
+
+	for(int count = countDistribution(rng); count > 0; count--)
+		ret[hexDistribution(rng)] = blocked[typeDistribution(rng)];
+
+	return ret;
+}
+
+}
+
+TEST(BattleHexMaskTest, setAndTest)
+{
+	BattleHexMask mask;
+	EXPECT_TRUE(mask.none());
+
+	mask.set(0);
+	mask.set(63);
+	mask.set(64);
+	mask.set(186);
+	mask.set(BattleHex::INVALID);
+	mask.set(GameConstants::BFIELD_SIZE);
+
+	EXPECT_EQ(mask.count(), 4);
+	EXPECT_TRUE(mask.test(63));
+	EXPECT_TRUE(mask.test(64));
+	EXPECT_TRUE(mask.test(186));
+	EXPECT_FALSE(mask.test(1));
+	EXPECT_FALSE(mask.test(BattleHex::INVALID));
+
+	mask.reset(63);
+	EXPECT_FALSE(mask.test(63));
+	EXPECT_EQ(mask.count(), 3);
+
+	EXPECT_EQ(BattleHexMask::allHexes().count(), GameConstants::BFIELD_SIZE);
+	EXPECT_EQ((~BattleHexMask()), BattleHexMask::allHexes());
+	EXPECT_EQ(BattleHexMask::sideColumns().count(), 2 * GameConstants::BFIELD_HEIGHT);
+	EXPECT_EQ(BattleHexMask::availableHexes(), BattleHexMask::allHexes() - BattleHexMask::sideColumns());
+}
+
+TEST(BattleHexMaskTest, shifted)
+{
+	for(int offset : {-130, -64, -18, -1, 1, 17, 63, 64, 100})
+	{
+		for(si16 hex = 0; hex < GameConstants::BFIELD_SIZE; hex++)
+		{
+			BattleHexMask mask;
+			mask.set(hex);
+
+			BattleHexMask expected;
+			expected.set(hex + offset);
+
+			EXPECT_EQ(mask.shifted(offset), expected) << "hex " << hex << " offset " << offset;
+		}
+	}
+}
+
+TEST(BattleHexMaskTest, neighboursMatchNeighbouringTiles)
+{
+	for(si16 hex = 0; hex < GameConstants::BFIELD_SIZE; hex++)
+	{
+		BattleHexMask mask;
+		mask.set(hex);
+
+		BattleHexMask expected;
+		for(auto neighbour : BattleHex(hex).neighbouringTiles())
+			expected.set(neighbour);
+
+		EXPECT_EQ(mask.neighbours(), expected) << "hex " << hex;
+	}
+}
+
+TEST(BattleHexMaskTest, accessibleHexesMatchAccessible)
+{
+	std::mt19937 rng(42);
+
+	for(int iteration = 0; iteration < 50; iteration++)
+	{
+		auto accessibility = randomAccessibility(rng);
+
+		for(bool doubleWide : {false, true})
+		{
+			for(ui8 side : {BattleSide::ATTACKER, BattleSide::DEFENDER})
+			{
+				auto mask = accessibility.accessibleHexes(doubleWide, side);
+
+				for(si16 hex = 0; hex < GameConstants::BFIELD_SIZE; hex++)
+					EXPECT_EQ(mask.test(hex), accessibility.accessible(hex, doubleWide, side)) << "hex " << hex;
+			}
+		}
+	}
+}
+
+TEST(BattleHexMaskTest, bfsMatchesReference)
+{
+	std::mt19937 rng(1337);
+	std::uniform_int_distribution<int> hexDistribution(0, GameConstants::BFIELD_SIZE - 1);
+	std::uniform_int_distribution<int> stoppersDistribution(0, 10);
+
+	for(int iteration = 0; iteration < 500; iteration++)
+	{
+		auto accessibility = randomAccessibility(rng);
+
+		ReachabilityInfo::Parameters params;
+		params.side = iteration % 2 ? BattleSide::ATTACKER : BattleSide::DEFENDER;
+		params.doubleWide = (iteration / 2) % 2;
+		params.startPosition = hexDistribution(rng);
+		params.knownAccessible = battle::Unit::getHexes(params.startPosition, params.doubleWide, params.side);
+
+		for(auto hex : params.knownAccessible)
+		{
+			if(hex.isValid())
+				accessibility[hex] = EAccessibility::ACCESSIBLE;
+		}
+
+		std::set<BattleHex> obstacles;
+		BattleHexMask stoppingHexes;
+
+		for(int count = stoppersDistribution(rng); count > 0; count--)
+		{
+			BattleHex hex = hexDistribution(rng);
+			obstacles.insert(hex);
+			stoppingHexes.set(hex);
+		}
+
+		//stopping hex under starting position must be ignored
+		if(iteration % 5 == 0)
+		{
+			obstacles.insert(params.startPosition);
+			stoppingHexes.set(params.startPosition);
+		}
+
+		auto expected = referenceBFS(accessibility, params, obstacles);
+		auto actual = CBattleInfoCallback::makeBFS(accessibility, params, stoppingHexes);
+
+		EXPECT_EQ(actual.distances, expected.distances) << "iteration " << iteration;
+		EXPECT_EQ(actual.predecessors, expected.predecessors) << "iteration " << iteration;
+	}
+}
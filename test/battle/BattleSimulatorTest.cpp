@@ -0,0 +1,196 @@
+/*
+ * BattleSimulatorTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/battle/BattleSimulator.h"
+#include "../../lib/battle/BattleInfo.h"
+#include "../../lib/CStack.h"
+#include "../../lib/JsonNode.h"
+
+namespace
+{
+
+BattleSimulationOutcome makeOutcome(int winner, int rounds, int64_t attackerLost, int64_t defenderLost, uint64_t time)
+{
+	BattleSimulationOutcome ret;
+	ret.winner = winner;
+	ret.rounds = rounds;
+	ret.unitsLost = {attackerLost, defenderLost};
+	ret.valueLost = {attackerLost * 100, defenderLost * 100};
+	ret.time = time;
+	return ret;
+}
+
+/// Shoots first living enemy if possible, otherwise attacks it in melee or walks towards it
+class SimplePlayer : public IBattleSimulationPlayer
+{
+	const BattleInfo * battle = nullptr;
+	ui8 side = 0;
+
+public:
+	void battleStart(const BattleInfo * battleInfo, ui8 battleSide) override
+	{
+		battle = battleInfo;
+		side = battleSide;
+	}
+
+	BattleAction activeStack(const CStack * stack) override
+	{
+		auto enemies = battle->battleAliveUnits(1 - side);
+
+		if(enemies.empty())
+			return BattleAction::makeDefend(stack);
+
+		const battle::Unit * target = enemies.front();
+
+		if(battle->battleCanShoot(stack, target->getPosition()))
+			return BattleAction::makeShotAttack(stack, target);
+
+		auto available = battle->battleGetAvailableHexes(stack, true);
+		available.push_back(stack->getPosition());
+
+		for(BattleHex from : available)
+		{
+			for(BattleHex destination : target->getHexes())
+			{
+				if(BattleHex::mutualPosition(from, destination) != BattleHex::NONE)
+					return BattleAction::makeMeleeAttack(stack, destination, from, false);
+			}
+		}
+
+		auto closest = boost::range::min_element(available, [target](BattleHex left, BattleHex right)
+		{
+			return BattleHex::getDistance(left, target->getPosition()) < BattleHex::getDistance(right, target->getPosition());
+		});
+
+		if(*closest == stack->getPosition())
+			return BattleAction::makeDefend(stack);
+
+		return BattleAction::makeMove(stack, *closest);
+	}
+};
+
+BattleSimulationSetup makeSetup(const std::string & attacker, int attackerAmount, const std::string & defender, int defenderAmount)
+{
+	JsonNode config;
+	config["attacker"]["army"].Vector().resize(1);
+	config["attacker"]["army"].Vector()[0]["type"].String() = attacker;
+	config["attacker"]["army"].Vector()[0]["amount"].Integer() = attackerAmount;
+	config["defender"]["army"].Vector().resize(1);
+	config["defender"]["army"].Vector()[0]["type"].String() = defender;
+	config["defender"]["army"].Vector()[0]["amount"].Integer() = defenderAmount;
+	config["obstacles"].Bool() = false;
+	config["battles"].Integer() = 8;
+	config["threads"].Integer() = 2;
+	config["seed"].Integer() = 42;
+
+	return BattleSimulationSetup::fromJson(config);
+}
+
+BattleSimulationPlayerFactory simplePlayers()
+{
+	return [](const BattleSimulationSide & side)
+	{
+		return std::make_unique<SimplePlayer>();
+	};
+}
+
+}
+
+TEST(BattleSimulatorTest, playsBattleUntilOneSideIsDefeated)
+{
+	BattleSimulator simulator(makeSetup("marksman", 30, "pikeman", 10), simplePlayers());
+	BattleSimulationReport report = simulator.run();
+
+	ASSERT_EQ(report.battles.size(), 8);
+	EXPECT_EQ(report.wins(BattleSide::ATTACKER), 8);
+
+	for(const auto & battle : report.battles)
+	{
+		EXPECT_EQ(battle.winner, BattleSide::ATTACKER);
+		EXPECT_GT(battle.rounds, 0);
+		EXPECT_EQ(battle.unitsLost[BattleSide::DEFENDER], 10);
+		EXPECT_LT(battle.unitsLost[BattleSide::ATTACKER], 30);
+	}
+}
+
+TEST(BattleSimulatorTest, sameSeedGivesSameOutcome)
+{
+	BattleSimulator simulator(makeSetup("archer", 20, "halberdier", 15), simplePlayers());
+	BattleSimulationReport report = simulator.run();
+
+	for(const auto & battle : report.battles)
+	{
+		BattleSimulationOutcome replayed = simulator.runBattle(battle.seed);
+
+		EXPECT_EQ(replayed.winner, battle.winner);
+		EXPECT_EQ(replayed.rounds, battle.rounds);
+		EXPECT_EQ(replayed.unitsLost, battle.unitsLost);
+		EXPECT_NE(battle.winner, -1);
+	}
+}
+
+TEST(BattleSimulatorTest, refusesUnsupportedAbilities)
+{
+	auto setup = makeSetup("pikeman", 10, "medusa", 10);
+
+	auto unsupported = setup.unsupportedAbilities();
+	ASSERT_EQ(unsupported.size(), 1);
+	EXPECT_NE(unsupported.front().find("SPELL_AFTER_ATTACK"), std::string::npos);
+
+	EXPECT_THROW(BattleSimulator(setup, simplePlayers()), std::runtime_error);
+	EXPECT_TRUE(makeSetup("pikeman", 10, "archer", 10).unsupportedAbilities().empty());
+	//fire shield is handled by battle rules shared with server
+	EXPECT_TRUE(makeSetup("pikeman", 10, "efreetSultan", 10).unsupportedAbilities().empty());
+}
+
+TEST(BattleSimulatorTest, reportAggregatesOutcomes)
+{
+	BattleSimulationReport report;
+	report.threads = 2;
+	report.totalTime = 4000;
+	report.battles.push_back(makeOutcome(0, 3, 10, 50, 1000));
+	report.battles.push_back(makeOutcome(0, 5, 20, 50, 3000));
+	report.battles.push_back(makeOutcome(1, 7, 60, 30, 2000));
+	report.battles.push_back(makeOutcome(-1, 100, 10, 10, 2000));
+
+	EXPECT_EQ(report.wins(0), 2);
+	EXPECT_EQ(report.wins(1), 1);
+	EXPECT_EQ(report.draws(), 1);
+
+	JsonNode json = report.toJson(false);
+
+	EXPECT_EQ(json["battles"].Integer(), 4);
+	EXPECT_EQ(json["draws"].Integer(), 1);
+	EXPECT_DOUBLE_EQ(json["battlesPerSecond"].Float(), 1000.0);
+	EXPECT_DOUBLE_EQ(json["averageRounds"].Float(), 28.75);
+	EXPECT_DOUBLE_EQ(json["battleTime"]["average"].Float(), 2.0);
+	EXPECT_DOUBLE_EQ(json["battleTime"]["min"].Float(), 1.0);
+	EXPECT_DOUBLE_EQ(json["battleTime"]["max"].Float(), 3.0);
+
+	EXPECT_EQ(json["attacker"]["wins"].Integer(), 2);
+	EXPECT_DOUBLE_EQ(json["attacker"]["winRate"].Float(), 0.5);
+	EXPECT_DOUBLE_EQ(json["attacker"]["averageUnitsLost"].Float(), 25.0);
+	EXPECT_DOUBLE_EQ(json["defender"]["winRate"].Float(), 0.25);
+	EXPECT_DOUBLE_EQ(json["defender"]["averageValueLost"].Float(), 3500.0);
+
+	EXPECT_TRUE(json["results"].isNull());
+	EXPECT_EQ(report.toJson(true)["results"].Vector().size(), 4);
+}
+
+TEST(BattleSimulatorTest, emptyReport)
+{
+	BattleSimulationReport report;
+	JsonNode json = report.toJson(true);
+
+	EXPECT_EQ(json["battles"].Integer(), 0);
+	EXPECT_DOUBLE_EQ(json["battleTime"]["min"].Float(), 0.0);
+	EXPECT_DOUBLE_EQ(json["attacker"]["winRate"].Float(), 0.0);
+}
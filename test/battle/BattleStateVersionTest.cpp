@@ -0,0 +1,60 @@
+/*
+ * BattleStateVersionTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/battle/IBattleState.h"
+
+TEST(DerivedStateVersionTest, notVersionedWithoutBaseVersion)
+{
+	DerivedStateVersion version;
+
+	EXPECT_EQ(version.update(-1, {{1, 20}}), -1);
+}
+
+TEST(DerivedStateVersionTest, keepsVersionOfSamePlacement)
+{
+	DerivedStateVersion version;
+
+	auto first = version.update(5, {{1, 20}, {2, 30}});
+	EXPECT_GE(first, 0);
+	EXPECT_EQ(version.update(5, {{1, 20}, {2, 30}}), first);
+}
+
+TEST(DerivedStateVersionTest, detectsMovedAndPlacedUnits)
+{
+	DerivedStateVersion version;
+
+	auto initial = version.update(5, {{1, 20}, {2, 30}});
+
+	auto moved = version.update(5, {{1, 21}, {2, 30}});
+	EXPECT_NE(moved, initial);
+
+	auto killed = version.update(5, {{1, 21}, {2, BattleHex::INVALID}});
+	EXPECT_NE(killed, moved);
+
+	auto summoned = version.update(5, {{1, 21}, {2, BattleHex::INVALID}, {3, 40}});
+	EXPECT_NE(summoned, killed);
+
+	//moving unit back is still new state, versions are never reused
+	auto movedBack = version.update(5, {{1, 20}, {2, 30}});
+	EXPECT_NE(movedBack, initial);
+	EXPECT_NE(movedBack, summoned);
+}
+
+TEST(DerivedStateVersionTest, followsBaseVersion)
+{
+	DerivedStateVersion version;
+
+	auto first = version.update(5, {{1, 20}});
+	auto second = version.update(6, {{1, 20}});
+
+	EXPECT_NE(second, first);
+	EXPECT_EQ(version.update(6, {{1, 20}}), second);
+}
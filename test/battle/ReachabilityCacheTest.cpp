@@ -0,0 +1,85 @@
+/*
+ * ReachabilityCacheTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/battle/ReachabilityCache.h"
+
+namespace
+{
+
+std::shared_ptr<ReachabilityInfo> makeReachability(BattleHex start)
+{
+	auto ret = std::make_shared<ReachabilityInfo>();
+	ret->params.startPosition = start;
+	ret->params.knownAccessible.push_back(start);
+	ret->distances[start] = 0;
+	return ret;
+}
+
+}
+
+TEST(ReachabilityCacheTest, returnsStoredResultsForSameVersion)
+{
+	ReachabilityCache cache;
+
+	auto info = makeReachability(40);
+	cache.storeReachability(5, BattlePerspective::LEFT_SIDE, info);
+
+	auto cached = cache.getReachability(5, BattlePerspective::LEFT_SIDE, info->params);
+	ASSERT_TRUE(cached);
+	EXPECT_EQ(cached->distances[40], 0);
+
+	EXPECT_FALSE(cache.getReachability(5, BattlePerspective::LEFT_SIDE, makeReachability(41)->params));
+
+	AccessibilityInfo accessibility;
+	accessibility.fill(EAccessibility::OBSTACLE);
+	cache.storeAccessibility(5, BattlePerspective::LEFT_SIDE, accessibility);
+
+	auto cachedAccessibility = cache.getAccessibility(5, BattlePerspective::LEFT_SIDE);
+	ASSERT_TRUE(cachedAccessibility.has_value());
+	EXPECT_EQ(cachedAccessibility->at(40), EAccessibility::OBSTACLE);
+
+	//storing accessibility for same version keeps reachability
+	EXPECT_TRUE(cache.getReachability(5, BattlePerspective::LEFT_SIDE, info->params));
+}
+
+TEST(ReachabilityCacheTest, dropsResultsOfOtherVersionOrPerspective)
+{
+	ReachabilityCache cache;
+
+	auto info = makeReachability(40);
+	cache.storeReachability(5, BattlePerspective::LEFT_SIDE, info);
+
+	EXPECT_FALSE(cache.getReachability(6, BattlePerspective::LEFT_SIDE, info->params));
+	EXPECT_FALSE(cache.getReachability(5, BattlePerspective::RIGHT_SIDE, info->params));
+	EXPECT_FALSE(cache.getAccessibility(5, BattlePerspective::LEFT_SIDE).has_value());
+
+	cache.storeReachability(6, BattlePerspective::LEFT_SIDE, makeReachability(41));
+	EXPECT_FALSE(cache.getReachability(5, BattlePerspective::LEFT_SIDE, info->params));
+}
+
+TEST(ReachabilityCacheTest, evictsLeastRecentlyUsed)
+{
+	ReachabilityCache cache;
+
+	auto first = makeReachability(20);
+	cache.storeReachability(1, BattlePerspective::ALL_KNOWING, first);
+
+	for(si16 hex = 21; hex < 60; hex++)
+	{
+		cache.storeReachability(1, BattlePerspective::ALL_KNOWING, makeReachability(hex));
+
+		//keep first entry in use
+		EXPECT_TRUE(cache.getReachability(1, BattlePerspective::ALL_KNOWING, first->params));
+	}
+
+	EXPECT_FALSE(cache.getReachability(1, BattlePerspective::ALL_KNOWING, makeReachability(21)->params));
+	EXPECT_TRUE(cache.getReachability(1, BattlePerspective::ALL_KNOWING, makeReachability(59)->params));
+}
@@ -26,6 +26,10 @@
 
 #include "../../lib/mapping/CMap.h"
 
+#include "../../lib/registerTypes/RegisterTypes.h"
+#include "../../lib/serializer/BinarySerializer.h"
+#include "../../lib/serializer/PackRecording.h"
+
 #include "../../lib/spells/CSpellHandler.h"
 #include "../../lib/spells/ISpellMechanics.h"
 #include "../../lib/spells/AbilityCaster.h"
@@ -410,6 +414,58 @@ TEST_F(CGameStateTest, battleResurrection)
 	EXPECT_EQ(unit->health.getResurrected(), 0);
 }
 
+TEST_F(CGameStateTest, battleStateVersion)
+{
+	startTestGame();
+	startTestBattle(map->heroesOnMap[0], map->heroesOnMap[1]);
+
+	BattleInfo * battle = gameState->curB;
+	const CStack * unit = battle->stacks.front();
+
+	auto version = battle->getStateVersion();
+	EXPECT_GE(version, 0);
+
+	auto expectChanged = [&](CPackForClient & pack)
+	{
+		gameCallback->sendAndApply(&pack);
+		EXPECT_NE(battle->getStateVersion(), version);
+		version = battle->getStateVersion();
+	};
+
+	{
+		BattleSetActiveStack pack;
+		pack.stack = unit->unitId();
+		gameCallback->sendAndApply(&pack);
+		EXPECT_EQ(battle->getStateVersion(), version);
+	}
+
+	{
+		BattleStackMoved pack;
+		pack.stack = unit->unitId();
+		pack.tilesToMove.push_back(battle->getAvaliableHex(unit->creatureId(), unit->unitSide()));
+		expectChanged(pack);
+		EXPECT_EQ(unit->getPosition(), pack.tilesToMove.back());
+	}
+
+	{
+		BattleNextRound pack;
+		pack.round = 1;
+		expectChanged(pack);
+	}
+
+	{
+		BattleUpdateGateState pack;
+		pack.state = EGateState::OPENED;
+		expectChanged(pack);
+	}
+
+	{
+		BattleUnitsChanged pack;
+		pack.changedStacks.emplace_back(unit->unitId(), UnitChanges::EOperation::REMOVE);
+		expectChanged(pack);
+	}
+}
+
 TEST_F(CGameStateTest, updateEntity)
 {
 	using ::testing::SaveArg;
@@ -421,3 +477,115 @@ TEST_F(CGameStateTest, updateEntity)
 	gameState->updateEntity(Metatype::CREATURE, 424242, JsonUtils::stringNode("TEST"));
 	EXPECT_EQ(actual.String(), "TEST");
 }
+
+namespace
+{
+
+/// Serializes packs into frames the same way as CConnection does in gameplay mode
+class PackFrameWriter : public IBinaryWriter
+{
+	BinarySerializer serializer;
+	std::vector<ui8> frame;
+
+public:
+	PackFrameWriter(CGameState * gs)
+		: serializer(this)
+	{
+		registerTypes(serializer);
+		serializer.smartPointerSerialization = false;
+		sendStackInstanceByIds = true;
+		addStdVecItems(gs);
+	}
+
+	int write(const void * data, unsigned size) override
+	{
+		frame.insert(frame.end(), static_cast<const ui8 *>(data), static_cast<const ui8 *>(data) + size);
+		return size;
+	}
+
+	std::vector<ui8> serialize(const CPack * pack)
+	{
+		frame.assign(4, 0);
+		serializer & pack;
+
+		const auto size = static_cast<ui32>(frame.size() - 4);
+		for(size_t i = 0; i < 4; i++)
+			frame[i] = static_cast<ui8>(size >> (8 * i));
+		return frame;
+	}
+};
+
+}
+
+TEST_F(CGameStateTest, packJournalRoundTrip)
+{
+	startTestGame();
+
+	const CGHeroInstance * hero = map->heroesOnMap[0];
+	const auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vcmi-journal-%%%%-%%%%");
+
+	{
+		PackRecorder recorder(directory);
+		PackFrameWriter writer(gameState.get());
+
+		auto recordAndApply = [&](CPackForClient & pack)
+		{
+			recorder.recordPack(writer.serialize(&pack));
+			gameCallback->sendAndApply(&pack);
+		};
+
+		recorder.recordCheckpoint(*gameCallback);
+
+		SetMana mana;
+		mana.hid = hero->id;
+		mana.val = 10;
+		recordAndApply(mana);
+
+		SetMovePoints movement;
+		movement.hid = hero->id;
+		movement.val = 500;
+		recordAndApply(movement);
+
+		recorder.recordCheckpoint(*gameCallback);
+
+		mana.val = 20;
+		recordAndApply(mana);
+
+		SetResources resources;
+		resources.player = hero->tempOwner;
+		resources.res[EGameResID::GOLD] = 12345;
+		resources.abs = false;
+		recordAndApply(resources);
+
+		EXPECT_EQ(recorder.packsCount(), 4);
+	}
+
+	{
+		PackReplayer replayer(directory);
+
+		EXPECT_EQ(replayer.getCheckpoints(), std::vector<ui64>({0, 2}));
+		EXPECT_EQ(replayer.packsCount(), 4);
+
+		replayer.seek(0);
+		EXPECT_EQ(replayer.replay(), 4);
+		EXPECT_EQ(replayer.currentPack(), 4);
+
+		const auto * replayedHero = replayer.gameState()->getHero(hero->id);
+		ASSERT_NE(replayedHero, nullptr);
+		EXPECT_EQ(replayedHero->mana, hero->mana);
+		EXPECT_EQ(replayedHero->movement, hero->movement);
+		EXPECT_EQ(replayer.gameState()->getPlayerState(hero->tempOwner)->resources, gameState->getPlayerState(hero->tempOwner)->resources);
+
+		replayer.seek(1);
+		EXPECT_EQ(replayer.currentPack(), 1);
+		EXPECT_EQ(replayer.gameState()->getHero(hero->id)->mana, 10);
+
+		//pack after second checkpoint is replayed from it
+		replayer.seek(3);
+		EXPECT_EQ(replayer.currentPack(), 3);
+		EXPECT_EQ(replayer.gameState()->getHero(hero->id)->mana, 20);
+		EXPECT_EQ(replayer.gameState()->getHero(hero->id)->movement, 500);
+	}
+
+	boost::filesystem::remove_all(directory);
+}
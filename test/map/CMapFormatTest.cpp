@@ -11,22 +11,96 @@
 
 #include "../../lib/JsonDetail.h"
 
+#include "../../lib/filesystem/CCompressedStream.h"
 #include "../../lib/filesystem/CMemoryBuffer.h"
+#include "../../lib/filesystem/CMemoryStream.h"
 #include "../../lib/filesystem/Filesystem.h"
+#include "../../lib/Languages.h"
 
 #include "../../lib/mapping/CMap.h"
-#include "../../lib/rmg/CMapGenOptions.h"
-#include "../../lib/rmg/CMapGenerator.h"
+#include "../../lib/mapping/CMapService.h"
+#include "../../lib/mapping/MapFormatH3M.h"
 #include "../../lib/mapping/MapFormatJson.h"
 
 #include "../lib/VCMIDirs.h"
 
 #include "MapComparer.h"
+#include "TestMapGenerator.h"
 #include "../JsonComparer.h"
-#include "mock/ZoneOptionsFake.h"
+
+#include <zlib.h>
 
 static const int TEST_RANDOM_SEED = 1337;
 
+namespace
+{
+
+/// Passes reads to underlying stream and counts bytes taken from it
+class CountingInputStream : public CInputStream
+{
+	std::unique_ptr<CInputStream> stream;
+	si64 & bytesRead;
+
+public:
+	CountingInputStream(std::unique_ptr<CInputStream> stream, si64 & bytesRead)
+		: stream(std::move(stream)), bytesRead(bytesRead)
+	{
+	}
+
+	si64 read(ui8 * data, si64 size) override
+	{
+		si64 result = stream->read(data, size);
+		bytesRead += result;
+		return result;
+	}
+
+	si64 seek(si64 position) override
+	{
+		return stream->seek(position);
+	}
+
+	si64 tell() override
+	{
+		return stream->tell();
+	}
+
+	si64 skip(si64 delta) override
+	{
+		return stream->skip(delta);
+	}
+
+	si64 getSize() override
+	{
+		return stream->getSize();
+	}
+};
+
+std::vector<ui8> gzipData(const std::vector<ui8> & data)
+{
+	z_stream deflateState = {};
+	// 16 is added to window bits to write gzip header, same as used by H3M maps
+	if(deflateInit2(&deflateState, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw std::runtime_error("Failed to initialize compression");
+
+	std::vector<ui8> result(deflateBound(&deflateState, static_cast<uLong>(data.size())));
+
+	deflateState.next_in = const_cast<Bytef *>(data.data());
+	deflateState.avail_in = static_cast<uInt>(data.size());
+	deflateState.next_out = result.data();
+	deflateState.avail_out = static_cast<uInt>(result.size());
+
+	int ret = deflate(&deflateState, Z_FINISH);
+	result.resize(deflateState.total_out);
+	deflateEnd(&deflateState);
+
+	if(ret != Z_STREAM_END)
+		throw std::runtime_error("Failed to compress data");
+
+	return result;
+}
+
+}
+
 static void saveTestMap(CMemoryBuffer & serializeBuffer, const std::string & filename)
 {
 	auto path = VCMIDirs::get().userDataPath() / filename;
@@ -42,29 +116,7 @@ TEST(MapFormat, Random)
 {
 	SCOPED_TRACE("MapFormat_Random start");
 
-	CMapGenOptions opt;
-	CRmgTemplate tmpl;
-	std::shared_ptr<ZoneOptionsFake> zoneOptions = std::make_shared<ZoneOptionsFake>();
-
-	const_cast<CRmgTemplate::CPlayerCountRange &>(tmpl.getCpuPlayers()).addRange(1, 4);
-	const_cast<CRmgTemplate::Zones &>(tmpl.getZones())[0] = zoneOptions;
-
-	zoneOptions->setOwner(1);
-	opt.setMapTemplate(&tmpl);
-
-	opt.setHeight(CMapHeader::MAP_SIZE_MIDDLE);
-	opt.setWidth(CMapHeader::MAP_SIZE_MIDDLE);
-	opt.setHasTwoLevels(true);
-	opt.setPlayerCount(4);
-
-	opt.setPlayerTypeForStandardPlayer(PlayerColor(0), EPlayerType::HUMAN);
-	opt.setPlayerTypeForStandardPlayer(PlayerColor(1), EPlayerType::AI);
-	opt.setPlayerTypeForStandardPlayer(PlayerColor(2), EPlayerType::AI);
-	opt.setPlayerTypeForStandardPlayer(PlayerColor(3), EPlayerType::AI);
-
-	CMapGenerator gen(opt, TEST_RANDOM_SEED);
-
-	std::unique_ptr<CMap> initialMap = gen.generate();
+	std::unique_ptr<CMap> initialMap = generateTestMap(CMapHeader::MAP_SIZE_MIDDLE, true, TEST_RANDOM_SEED);
 	initialMap->name = "Test";
 	SCOPED_TRACE("MapFormat_Random generated");
 
@@ -223,3 +275,46 @@ TEST(MapFormat, Terrain)
 		c.compare("underground", actualUnderground, expectedUnderground);
 	}
 }
+
+TEST(MapFormat, H3MHeaderOnly)
+{
+	const ResourceID testMap("test/TerrainViewTest", EResType::MAP);
+
+	// map is smaller than single block read by decompressor, so it is followed by data that does not compress well
+	std::vector<ui8> data;
+	{
+		CCompressedStream stream(CResourceHandler::get()->load(testMap), true);
+		auto mapData = stream.readAll();
+		data.assign(mapData.first.get(), mapData.first.get() + mapData.second);
+	}
+
+	std::mt19937 padding(TEST_RANDOM_SEED);
+	for(size_t i = 0; i < 1024 * 1024; i++)
+		data.push_back(static_cast<ui8>(padding()));
+
+	const std::vector<ui8> compressed = gzipData(data);
+
+	si64 compressedBytesRead = 0;
+	auto compressedStream = std::make_unique<CMemoryStream>(compressed.data(), compressed.size());
+	CCompressedStream stream(std::make_unique<CountingInputStream>(std::move(compressedStream), compressedBytesRead), true);
+	CMapLoaderH3M loader(testMap.getName(), "core", Languages::getLanguageOptions(Languages::ELanguages::ENGLISH).encoding, &stream);
+	std::unique_ptr<CMapHeader> header = loader.loadMapHeader();
+
+	// header is small part of the map, everything after it must stay compressed
+	EXPECT_GT(compressedBytesRead, 0);
+	EXPECT_LT(compressedBytesRead, static_cast<si64>(compressed.size()) / 10);
+
+	CMapService mapService;
+	std::unique_ptr<CMap> map = mapService.loadMap(testMap);
+
+	EXPECT_EQ(header->version, map->version);
+	EXPECT_EQ(header->width, map->width);
+	EXPECT_EQ(header->height, map->height);
+	EXPECT_EQ(header->twoLevel, map->twoLevel);
+	EXPECT_EQ(header->name, map->name);
+	EXPECT_EQ(header->description, map->description);
+	EXPECT_EQ(header->victoryMessage, map->victoryMessage);
+	EXPECT_EQ(header->defeatMessage, map->defeatMessage);
+	EXPECT_EQ(header->howManyTeams, map->howManyTeams);
+	EXPECT_EQ(header->triggeredEvents.size(), map->triggeredEvents.size());
+}
@@ -0,0 +1,44 @@
+/*
+ * TestMapGenerator.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "TestMapGenerator.h"
+
+#include "../../lib/mapping/CMap.h"
+#include "../../lib/rmg/CMapGenOptions.h"
+#include "../../lib/rmg/CMapGenerator.h"
+
+#include "mock/ZoneOptionsFake.h"
+
+std::unique_ptr<CMap> generateTestMap(int size, bool twoLevels, int seed)
+{
+	CMapGenOptions opt;
+	CRmgTemplate tmpl;
+	std::shared_ptr<ZoneOptionsFake> zoneOptions = std::make_shared<ZoneOptionsFake>();
+
+	const_cast<CRmgTemplate::CPlayerCountRange &>(tmpl.getCpuPlayers()).addRange(1, 4);
+	const_cast<CRmgTemplate::Zones &>(tmpl.getZones())[0] = zoneOptions;
+
+	zoneOptions->setOwner(1);
+	opt.setMapTemplate(&tmpl);
+
+	opt.setHeight(size);
+	opt.setWidth(size);
+	opt.setHasTwoLevels(twoLevels);
+	opt.setPlayerCount(4);
+
+	opt.setPlayerTypeForStandardPlayer(PlayerColor(0), EPlayerType::HUMAN);
+	opt.setPlayerTypeForStandardPlayer(PlayerColor(1), EPlayerType::AI);
+	opt.setPlayerTypeForStandardPlayer(PlayerColor(2), EPlayerType::AI);
+	opt.setPlayerTypeForStandardPlayer(PlayerColor(3), EPlayerType::AI);
+
+	CMapGenerator gen(opt, seed);
+	return gen.generate();
+}
@@ -0,0 +1,16 @@
+/*
+ * TestMapGenerator.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#pragma once
+
+class CMap;
+
+/// Generates random map of 4 players with single fake zone
+std::unique_ptr<CMap> generateTestMap(int size, bool twoLevels, int seed);
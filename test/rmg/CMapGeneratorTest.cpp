@@ -0,0 +1,40 @@
+/*
+ * CMapGeneratorTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/mapping/CMap.h"
+
+#include "../map/MapComparer.h"
+#include "../map/TestMapGenerator.h"
+
+static const int TEST_RANDOM_SEED = 1337;
+
+TEST(MapGenerator, SameSeedSameMap)
+{
+	auto first = generateTestMap(CMapHeader::MAP_SIZE_SMALL, true, TEST_RANDOM_SEED);
+	auto second = generateTestMap(CMapHeader::MAP_SIZE_SMALL, true, TEST_RANDOM_SEED);
+
+	MapComparer c;
+	c(second, first);
+}
+
+/// Generates fixed-seed map of each size and reports time spent, run with --gtest_also_run_disabled_tests
+TEST(MapGenerator, DISABLED_Benchmark)
+{
+	for(int size : {CMapHeader::MAP_SIZE_SMALL, CMapHeader::MAP_SIZE_MIDDLE, CMapHeader::MAP_SIZE_LARGE, CMapHeader::MAP_SIZE_XLARGE, CMapHeader::MAP_SIZE_HUGE, CMapHeader::MAP_SIZE_XHUGE, CMapHeader::MAP_SIZE_GIANT})
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto map = generateTestMap(size, true, TEST_RANDOM_SEED);
+		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+		ASSERT_TRUE(map);
+		std::cout << boost::format("Map %dx%dx2 generated in %d ms") % size % size % duration.count() << std::endl;
+	}
+}
@@ -0,0 +1,123 @@
+/*
+ * RmgAreaTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/rmg/RmgArea.h"
+
+namespace test
+{
+using namespace ::rmg;
+using namespace ::testing;
+
+static Tileset rectangle(const int3 & from, int width, int height)
+{
+	Tileset result;
+	for(int y = 0; y < height; ++y)
+		for(int x = 0; x < width; ++x)
+			result.insert(from + int3(x, y, 0));
+	return result;
+}
+
+TEST(RmgAreaTest, SetOperations)
+{
+	//rectangles are wider than one storage word and are not aligned to each other
+	Area left(rectangle(int3(-10, 0, 0), 100, 5));
+	Area right(rectangle(int3(50, 2, 0), 100, 5));
+
+	Tileset expectedUnion = left.getTiles();
+	expectedUnion.insert(right.getTiles().begin(), right.getTiles().end());
+
+	Tileset expectedIntersection;
+	Tileset expectedDifference;
+	for(const auto & tile : left.getTiles())
+	{
+		if(right.contains(tile))
+			expectedIntersection.insert(tile);
+		else
+			expectedDifference.insert(tile);
+	}
+
+	EXPECT_EQ((left + right).getTiles(), expectedUnion);
+	EXPECT_EQ((left * right).getTiles(), expectedIntersection);
+	EXPECT_EQ((left - right).getTiles(), expectedDifference);
+	EXPECT_TRUE(left.overlap(right));
+	EXPECT_FALSE(left.contains(right));
+	EXPECT_TRUE((left + right).contains(right));
+	EXPECT_FALSE((left - right).overlap(right));
+}
+
+TEST(RmgAreaTest, Translation)
+{
+	Area area(rectangle(int3(0, 0, 0), 3, 2));
+	area.add(int3(5, 5, 1));
+
+	Area moved = area + int3(-70, 3, 0);
+
+	Tileset expected;
+	for(const auto & tile : area.getTiles())
+		expected.insert(tile + int3(-70, 3, 0));
+
+	EXPECT_EQ(moved.getTiles(), expected);
+	EXPECT_TRUE(moved.contains(int3(-65, 8, 1)));
+	EXPECT_FALSE(moved.contains(int3(5, 5, 1)));
+	EXPECT_EQ(moved - int3(-70, 3, 0), area);
+}
+
+TEST(RmgAreaTest, Border)
+{
+	Area area(rectangle(int3(0, 0, 0), 4, 4));
+
+	Tileset expectedBorder = area.getTiles();
+	expectedBorder.erase(int3(1, 1, 0));
+	expectedBorder.erase(int3(2, 1, 0));
+	expectedBorder.erase(int3(1, 2, 0));
+	expectedBorder.erase(int3(2, 2, 0));
+
+	Tileset expectedOutside = rectangle(int3(-1, -1, 0), 6, 6);
+	for(const auto & tile : area.getTiles())
+		expectedOutside.erase(tile);
+
+	EXPECT_EQ(area.getBorder(), expectedBorder);
+	EXPECT_EQ(area.getBorderOutside(), expectedOutside);
+}
+
+TEST(RmgAreaTest, DistanceMap)
+{
+	Area area(rectangle(int3(0, 0, 0), 5, 5));
+
+	std::map<int, Tileset> reverseDistanceMap;
+	auto distanceMap = area.computeDistanceMap(reverseDistanceMap);
+
+	ASSERT_EQ(reverseDistanceMap.size(), 3);
+	EXPECT_EQ(reverseDistanceMap[0].size(), 16);
+	EXPECT_EQ(reverseDistanceMap[1].size(), 8);
+	EXPECT_EQ(reverseDistanceMap[2], Tileset({int3(2, 2, 0)}));
+	EXPECT_EQ(distanceMap.size(), 25);
+	EXPECT_EQ(distanceMap[int3(1, 3, 0)], 1);
+}
+
+TEST(RmgAreaTest, ConnectedAreas)
+{
+	Area area(rectangle(int3(0, 0, 0), 3, 3));
+	area.unite(Area(rectangle(int3(4, 0, 0), 3, 3)));
+
+	EXPECT_FALSE(area.connected());
+	EXPECT_EQ(connectedAreas(area, false).size(), 2);
+
+	area.add(int3(3, 1, 0));
+	EXPECT_TRUE(area.connected());
+
+	area.erase(int3(3, 1, 0));
+	area.add(int3(3, 3, 0));
+	EXPECT_TRUE(area.connected());
+	EXPECT_EQ(connectedAreas(area, true).size(), 3);
+}
+
+}
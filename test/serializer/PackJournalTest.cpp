@@ -0,0 +1,99 @@
+/*
+ * PackJournalTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/serializer/PackJournal.h"
+
+namespace
+{
+
+PackJournal::Frame makeFrame(ui8 id, size_t size = 10)
+{
+	return std::make_shared<const std::vector<ui8>>(size, id);
+}
+
+std::vector<ui8> frameIds(const std::vector<PackJournal::Frame> & frames)
+{
+	std::vector<ui8> ret;
+	for(const auto & frame : frames)
+		ret.push_back(frame->front());
+	return ret;
+}
+
+}
+
+TEST(PackJournalTest, missingPacksOfClient)
+{
+	PackJournal journal(1000);
+
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(0));
+	journal.startClient(1);
+	journal.startClient(2);
+
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(1));
+	journal.append(2, makeFrame(2));
+	journal.append(1, makeFrame(3));
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(4));
+
+	std::vector<PackJournal::Frame> missing;
+
+	EXPECT_TRUE(journal.missingPacks(1, 0, missing));
+	EXPECT_EQ(frameIds(missing), std::vector<ui8>({1, 3, 4}));
+
+	EXPECT_TRUE(journal.missingPacks(1, 2, missing));
+	EXPECT_EQ(frameIds(missing), std::vector<ui8>({4}));
+
+	EXPECT_TRUE(journal.missingPacks(2, 1, missing));
+	EXPECT_EQ(frameIds(missing), std::vector<ui8>({2, 4}));
+
+	EXPECT_TRUE(journal.missingPacks(2, 3, missing));
+	EXPECT_TRUE(missing.empty());
+
+	EXPECT_FALSE(journal.missingPacks(2, 4, missing));
+	EXPECT_FALSE(journal.missingPacks(3, 0, missing));
+}
+
+TEST(PackJournalTest, droppedPacks)
+{
+	PackJournal journal(30);
+
+	journal.startClient(1);
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(0));
+	journal.append(2, makeFrame(1));
+	journal.append(1, makeFrame(2));
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(3));
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(4));
+
+	EXPECT_EQ(journal.packsCount(), 3);
+	EXPECT_EQ(journal.bytesCount(), 30);
+
+	std::vector<PackJournal::Frame> missing;
+
+	//first pack was dropped
+	EXPECT_FALSE(journal.missingPacks(1, 0, missing));
+
+	EXPECT_TRUE(journal.missingPacks(1, 1, missing));
+	EXPECT_EQ(frameIds(missing), std::vector<ui8>({2, 3, 4}));
+
+	EXPECT_TRUE(journal.missingPacks(1, 3, missing));
+	EXPECT_EQ(frameIds(missing), std::vector<ui8>({4}));
+
+	//client that got state later has not missed dropped packs
+	journal.startClient(2);
+	journal.append(PackJournal::ALL_CLIENTS, makeFrame(5, 25));
+
+	EXPECT_EQ(journal.packsCount(), 1);
+	EXPECT_TRUE(journal.missingPacks(2, 0, missing));
+	EXPECT_EQ(frameIds(missing), std::vector<ui8>({5}));
+
+	journal.clear();
+	EXPECT_EQ(journal.packsCount(), 0);
+	EXPECT_FALSE(journal.missingPacks(2, 1, missing));
+}
@@ -0,0 +1,65 @@
+/*
+ * PackRecordingTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/serializer/PackRecording.h"
+
+namespace
+{
+
+std::vector<ui8> makeFrame(ui32 size)
+{
+	std::vector<ui8> ret(4 + size, static_cast<ui8>(size));
+	for(size_t i = 0; i < 4; i++)
+		ret[i] = static_cast<ui8>(size >> (8 * i));
+	return ret;
+}
+
+}
+
+TEST(PackRecordingTest, chunksOfJournal)
+{
+	const auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vcmi-journal-%%%%-%%%%");
+
+	{
+		PackRecorder recorder(directory);
+
+		for(ui32 i = 0; i < 100; i++)
+			recorder.recordPack(makeFrame(10 * 1024 + i));
+
+		EXPECT_EQ(recorder.packsCount(), 100);
+	}
+
+	//replayer needs initial checkpoint, which requires whole game state to write
+	boost::filesystem::ofstream((directory / "checkpoint_0.vjcp").string());
+	boost::filesystem::ofstream((directory / "checkpoint_50.vjcp").string());
+
+	{
+		PackReplayer replayer(directory);
+		EXPECT_EQ(replayer.packsCount(), 100);
+		EXPECT_EQ(replayer.getCheckpoints(), std::vector<ui64>({0, 50}));
+		EXPECT_EQ(replayer.currentPack(), 0);
+		EXPECT_THROW(replayer.replay(), std::runtime_error);
+	}
+
+	//incomplete chunk of server that was killed is ignored
+	{
+		std::ofstream packs((directory / "packs.bin").string(), std::ios::binary | std::ios::app);
+		packs.write("\xff\xff\x00\x00\x10\x00\x00\x00\x01\x00\x00\x00\x01\x02", 14);
+	}
+
+	{
+		PackReplayer replayer(directory);
+		EXPECT_EQ(replayer.packsCount(), 100);
+	}
+
+	boost::filesystem::remove_all(directory);
+	EXPECT_THROW(PackReplayer replayer(directory), std::runtime_error);
+}
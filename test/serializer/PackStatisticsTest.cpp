@@ -0,0 +1,53 @@
+/*
+ * PackStatisticsTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/serializer/PackStatistics.h"
+
+TEST(PackStatisticsTest, aggregatesStagesPerType)
+{
+	auto & statistics = PackStatistics::get();
+	statistics.reset();
+	statistics.setTimingEnabled(false);
+
+	{
+		PackStatistics::Scope scope(PackStatistics::EStage::SERIALIZE, 3);
+		scope.setBytes(100);
+	}
+	{
+		PackStatistics::Scope scope(PackStatistics::EStage::DESERIALIZE);
+		scope.setBytes(50);
+		scope.setType(3);
+	}
+	statistics.record(PackStatistics::EStage::APPLY, 3, 0, 20);
+	statistics.record(PackStatistics::EStage::APPLY, 3, 0, 30);
+	statistics.record(PackStatistics::EStage::HANDLE, PackStatistics::MAX_TYPES + 1, 0, 0);
+
+	auto types = statistics.getStatistics();
+	ASSERT_EQ(types.size(), 2);
+
+	//types above limit are counted as unknown type
+	EXPECT_EQ(types[0].typeID, 0);
+	EXPECT_EQ(types[0][PackStatistics::EStage::HANDLE].count, 1);
+
+	const auto & type = types[1];
+	EXPECT_EQ(type.typeID, 3);
+	EXPECT_EQ(type[PackStatistics::EStage::SERIALIZE].count, 1);
+	EXPECT_EQ(type[PackStatistics::EStage::SERIALIZE].bytes, 100);
+	EXPECT_EQ(type[PackStatistics::EStage::SERIALIZE].time, 0);
+	EXPECT_EQ(type[PackStatistics::EStage::DESERIALIZE].count, 1);
+	EXPECT_EQ(type[PackStatistics::EStage::DESERIALIZE].bytes, 50);
+	EXPECT_EQ(type[PackStatistics::EStage::APPLY].count, 2);
+	EXPECT_EQ(type[PackStatistics::EStage::APPLY].time, 50);
+	EXPECT_EQ(type[PackStatistics::EStage::HANDLE].count, 0);
+
+	statistics.reset();
+	EXPECT_TRUE(statistics.getStatistics().empty());
+}